@@ -10,71 +10,810 @@
 //  the University of Toronto. It is prohibited to distribute
 //  this code, either publicly or to third parties.
 
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <map>
+#include <set>
+#include <sstream>
+#include <thread>
 
 #include "antlr4-runtime.h"
 #include "smallCLexer.h"
 #include "smallCParser.h"
 #include "ASTVisitorBase.h"
 #include "ASTPrinter.h"
+#include "ASTJSONPrinter.h"
+#include "ParserProfile.h"
+#include "PerfCounters.h"
+#include "MemStats.h"
 #include "SemanticAnalyzer.h"
+#include "TracingSemanticAnalyzer.h"
+#include "IRGen.h"
+#include "CallGraph.h"
+#include "PassManager.h"
+#include "Profile.h"
+#include "TailRecursion.h"
+#include "Inliner.h"
+#include "SCCP.h"
+#include "BoundsCheckElim.h"
+#include "GVN.h"
+#include "LICM.h"
+#include "StrengthReduce.h"
+#include "Vectorizer.h"
+#include "DeadCodeElim.h"
+#include "BlockLayout.h"
+#include "CodeGen.h"
+#include "RegAlloc.h"
+#include "AsmPrinter.h"
+#include "TimeReport.h"
+#include "Trace.h"
+#include "LazyParser.h"
+#include "ASTFile.h"
+#include "ASTWriter.h"
+#include "ASTHasher.h"
+#include "LineTable.h"
+#include "CompileCache.h"
 
 using namespace antlrcpp;
 using namespace antlr4;
 using namespace std;
 using namespace smallc;
 
+static void usage(const char *prog) {
+    cerr << "Usage: " << prog << " [-S] [-o output] filename" << std::endl;
+    cerr << "       " << prog << " --read-ast file" << std::endl;
+    cerr << "  -S         compile to x86-64 assembly (link with scio.o)" << std::endl;
+    cerr << "  -o <file>  assembly output file (default: input with .s suffix)" << std::endl;
+    cerr << "  -O         optimize the IR before code generation" << std::endl;
+    cerr << "  --bounds-check   trap at run time on out-of-bounds array accesses" << std::endl;
+    cerr << "  --inline-report  print every inlining decision to stderr" << std::endl;
+    cerr << "  --inline-threshold <n>  inline calls costing up to n instructions (default 25)" << std::endl;
+    cerr << "  --profile-generate <file>  count blocks, branches and calls at run time and" << std::endl;
+    cerr << "                   append the counts to file when the program exits" << std::endl;
+    cerr << "  --profile-use <file>  optimize with the counts in file" << std::endl;
+    cerr << "  --no-vectorize   do not vectorize loops under -O" << std::endl;
+    cerr << "  --stats          print what each optimization pass changed to stderr" << std::endl;
+    cerr << "  --dump-ir        print the SSA IR after optimization to stdout" << std::endl;
+    cerr << "  --verify-ir      check the IR before and after every pass" << std::endl;
+    cerr << "  --time-passes    print the time spent in each IR pass to stderr" << std::endl;
+    cerr << "  --print-ast      print the AST to stdout after parsing" << std::endl;
+    cerr << "  --print-ast-json print the AST to stdout as JSON after parsing" << std::endl;
+    cerr << "  --parse-threads <n>  parse function bodies on n threads (0: one per core)" << std::endl;
+    cerr << "  --emit-ast <file>  write the checked AST to file in the binary AST format" << std::endl;
+    cerr << "  --read-ast <file>  map an AST file written by --emit-ast and print it" << std::endl;
+    cerr << "  --cache-dir <dir>  keep the results of checking runs (without -S or" << std::endl;
+    cerr << "                   --dump-ir) in dir, keyed by a hash of the source and the" << std::endl;
+    cerr << "                   compiler, and replay them instead of checking again" << std::endl;
+    cerr << "  --cache-size <MB>  evict the least recently used results beyond this size" << std::endl;
+    cerr << "                   (default 256)" << std::endl;
+    cerr << "  --signatures     print the global declarations and function prototypes to" << std::endl;
+    cerr << "                   stdout and stop, without parsing function bodies" << std::endl;
+    cerr << "  --decl-hashes    print the structural hash of every global declaration to" << std::endl;
+    cerr << "                   stdout and stop" << std::endl;
+    cerr << "  --profile-parser print per decision and per rule prediction statistics of" << std::endl;
+    cerr << "                   the parser to stderr (slows parsing down)" << std::endl;
+    cerr << "  --keep-parse-tree  build ANTLR's parse tree and keep it, with the tokens," << std::endl;
+    cerr << "                   until exit instead of freeing them once the AST is built" << std::endl;
+    cerr << "  --mem-stats      print live and peak objects and bytes of every AST class," << std::endl;
+    cerr << "                   symbol table, error, token and parse tree type at exit;" << std::endl;
+    cerr << "                   the parse tree is built to be measured, then freed" << std::endl;
+    cerr << "  --time-report    print wall time, CPU time and peak memory of every" << std::endl;
+    cerr << "                   compilation phase, and front end throughput, to stderr" << std::endl;
+    cerr << "  --time-report-json <file>  write the phase timings to file as JSON" << std::endl;
+    cerr << "  --perf-counters  count cycles, instructions, cache misses and branch misses" << std::endl;
+    cerr << "                   in every phase and print them to stderr" << std::endl;
+    cerr << "  --trace <file>   write a Chrome trace of the phases and of every top-level" << std::endl;
+    cerr << "                   declaration checked to file" << std::endl;
+}
+
+// A count given on the command line: a plain decimal number that fits in
+// an int, so that junk or a negative number is an error rather than 0
+static bool parseCount(const char *text, int &value) {
+    if (!isdigit((unsigned char)text[0]))
+        return false;
+    char *end = nullptr;
+    unsigned long long count = strtoull(text, &end, 10);
+    if (*end != '\0' || count > INT_MAX)
+        return false;
+    value = (int)count;
+    return true;
+}
+
+// Bytes and tokens per second through the phases that run on every
+// input, up to and including semantic analysis
+static void printThroughput(ostream &out, TimeReport *report, size_t bytes, size_t tokens) {
+    static const char *frontEnd[] = { "input read", "lexing", "signature parsing", "parallel parsing",
+                                      "parsing", "parse tree release", "AST printing",
+                                      "semantic analysis", "error printing" };
+    double seconds = 0;
+    for (auto phase : frontEnd)
+        seconds += report->getWall(phase);
+    if (seconds <= 0)
+        return;
+    char line[200];
+    snprintf(line, sizeof(line), "front end: %.2f MB/s, %.0f tokens/s (%zu bytes, %zu tokens in %.3f ms)\n",
+             bytes / seconds / 1e6, tokens / seconds, bytes, tokens, seconds * 1000.0);
+    out << line;
+}
+
+// ANTLR allocates its tokens and parse tree itself, so they are counted
+// by walking them once they are complete, with the size of the heap
+// block each object takes
+static void countTokens(CommonTokenStream *tokens) {
+    std::vector<Token *> all = tokens->getTokens();
+    long long bytes = 0;
+    for (auto token : all)
+        bytes += malloc_usable_size(dynamic_cast<void *>(token));
+    MemStats::getCounter(MemStats::Antlr, "CommonToken").set(all.size(), bytes);
+}
+
+static void countParseTree(smallCParser *parser, tree::ParseTree *root) {
+    std::map<std::string, std::pair<long long, long long>> counts;
+    std::vector<tree::ParseTree *> work(1, root);
+    while (!work.empty()) {
+        tree::ParseTree *node = work.back();
+        work.pop_back();
+        auto ctx = dynamic_cast<ParserRuleContext *>(node);
+        std::string name = "TerminalNode";
+        if (ctx) {
+            name = parser->getRuleNames()[ctx->getRuleIndex()] + "Context";
+            name[0] = toupper(name[0]);
+        }
+        counts[name].first++;
+        counts[name].second += malloc_usable_size(dynamic_cast<void *>(node));
+        work.insert(work.end(), node->children.begin(), node->children.end());
+    }
+    for (auto &count : counts)
+        MemStats::getCounter(MemStats::Antlr, count.first).set(count.second.first, count.second.second);
+}
+
+static const char *typeSpelling(TypeNode *type) {
+    switch (type->getTypeEnum()) {
+        case TypeNode::Int:     return "int";
+        case TypeNode::Bool:    return "bool";
+        default:                return "void";
+    }
+}
+
+// The program's interface, one declaration per line, in source order
+static void printSignatures(std::ostream &out, ProgramNode *prg) {
+    if (prg->useIo())
+        out << "#include \"scio.h\"\n";
+    for (unsigned int i = 0; i < prg->getNumChildren(); i++) {
+        ASTNode *decl = prg->getChild(i);
+        if (auto func = dynamic_cast<FunctionDeclNode *>(decl)) {
+            out << typeSpelling(func->getRetType()) << " " << func->getIdent()->getName() << "(";
+            std::vector<ParameterNode *> params = func->getParams();
+            for (size_t p = 0; p < params.size(); p++) {
+                TypeNode *type = params[p]->getType();
+                out << (p ? ", " : "") << typeSpelling(type) << " " << params[p]->getIdent()->getName()
+                    << (type->isArray() ? "[]" : "");
+            }
+            out << ");\n";
+        }
+        else if (auto array = dynamic_cast<ArrayDeclNode *>(decl))
+            out << typeSpelling(array->getType()) << " " << array->getIdent()->getName() << "["
+                << array->getType()->getSize() << "];\n";
+        else if (auto scalar = dynamic_cast<ScalarDeclNode *>(decl))
+            out << typeSpelling(scalar->getType()) << " " << scalar->getIdent()->getName() << ";\n";
+    }
+}
+
+// One global declaration per line, in source order, after its hash
+static void printDeclHashes(std::ostream &out, ProgramNode *prg) {
+    for (unsigned int i = 0; i < prg->getNumChildren(); i++) {
+        auto decl = dynamic_cast<DeclNode *>(prg->getChild(i));
+        if (!decl)
+            continue;
+        auto func = dynamic_cast<FunctionDeclNode *>(decl);
+        out << Hasher::toHex(decl->getHash()) << " "
+            << (func ? (func->getProto() ? "prototype " : "function ") : "variable ")
+            << decl->getIdent()->getName() << "\n";
+    }
+}
+
 int main(int argc, const char *argv[]) {
-    // Check for the number of arguments
-    if (argc != 2) {
-	cerr << "Usage: " << argv[0] << " filename" << std::endl;
-	return -1;
+    // Parse the command line
+    const char *inputName = nullptr;
+    std::string outputName;
+    bool emitAsm = false;
+    bool dumpIR = false;
+    bool verifyIR = false;
+    bool timePasses = false;
+    bool timeReportText = false;
+    bool printAST = false;
+    bool printASTJSON = false;
+    bool signatures = false;
+    bool declHashes = false;
+    int parseThreads = -1;
+    bool profileParser = false;
+    bool memStats = false;
+    bool keepParseTree = false;
+    bool perfCounters = false;
+    std::string timeReportJSON;
+    std::string emitASTName;
+    std::string readASTName;
+    std::string cacheDir;
+    unsigned long long cacheMB = 256;
+    std::string traceName;
+    bool optimize = false;
+    bool printStats = false;
+    bool boundsChecks = false;
+    bool inlineReport = false;
+    bool vectorize = true;
+    int inlineThreshold = -1;
+    std::string profileGenerate;
+    std::string profileUse;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-S")
+            emitAsm = true;
+        else if (arg == "-o" && i + 1 < argc)
+            outputName = argv[++i];
+        else if (arg == "-O")
+            optimize = true;
+        else if (arg == "--bounds-check")
+            boundsChecks = true;
+        else if (arg == "--inline-report")
+            inlineReport = true;
+        else if (arg == "--inline-threshold" && i + 1 < argc) {
+            if (!parseCount(argv[++i], inlineThreshold)) {
+                usage(argv[0]);
+                return -1;
+            }
+        }
+        else if (arg == "--profile-generate" && i + 1 < argc)
+            profileGenerate = argv[++i];
+        else if (arg == "--profile-use" && i + 1 < argc)
+            profileUse = argv[++i];
+        else if (arg == "--no-vectorize")
+            vectorize = false;
+        else if (arg == "--stats")
+            printStats = true;
+        else if (arg == "--dump-ir")
+            dumpIR = true;
+        else if (arg == "--verify-ir")
+            verifyIR = true;
+        else if (arg == "--time-passes")
+            timePasses = true;
+        else if (arg == "--print-ast")
+            printAST = true;
+        else if (arg == "--print-ast-json")
+            printASTJSON = true;
+        else if (arg == "--parse-threads" && i + 1 < argc) {
+            if (!parseCount(argv[++i], parseThreads)) {
+                usage(argv[0]);
+                return -1;
+            }
+        }
+        else if (arg == "--emit-ast" && i + 1 < argc)
+            emitASTName = argv[++i];
+        else if (arg == "--read-ast" && i + 1 < argc)
+            readASTName = argv[++i];
+        else if (arg == "--cache-dir" && i + 1 < argc)
+            cacheDir = argv[++i];
+        else if (arg == "--cache-size" && i + 1 < argc) {
+            // A size in bytes must fit in 64 bits
+            const char *size = argv[++i];
+            char *end = nullptr;
+            cacheMB = isdigit((unsigned char)size[0]) ? strtoull(size, &end, 10) : 0;
+            if (cacheMB == 0 || *end != '\0' || cacheMB > (UINT64_MAX >> 20)) {
+                usage(argv[0]);
+                return -1;
+            }
+        }
+        else if (arg == "--signatures")
+            signatures = true;
+        else if (arg == "--decl-hashes")
+            declHashes = true;
+        else if (arg == "--profile-parser")
+            profileParser = true;
+        else if (arg == "--keep-parse-tree")
+            keepParseTree = true;
+        else if (arg == "--mem-stats")
+            memStats = true;
+        else if (arg == "--perf-counters")
+            perfCounters = true;
+        else if (arg == "--time-report")
+            timeReportText = true;
+        else if (arg == "--time-report-json" && i + 1 < argc)
+            timeReportJSON = argv[++i];
+        else if (arg == "--trace" && i + 1 < argc)
+            traceName = argv[++i];
+        else if (arg[0] != '-' && inputName == nullptr)
+            inputName = argv[i];
+        else {
+            usage(argv[0]);
+            return -1;
+        }
     }
 
+    // An AST file is printed without compiling anything
+    if (!readASTName.empty()) {
+        ASTFile file;
+        if (!file.open(readASTName)) {
+            cerr << "fatal: " << file.getError() << std::endl;
+            return -1;
+        }
+        file.print(cout);
+        return 0;
+    }
+
+    if (inputName == nullptr) {
+        usage(argv[0]);
+        return -1;
+    }
+
+    // Counting must start before the first counted object is allocated
+    MemStats::enabled = memStats;
+
+    // Phases are only timed when a report, a trace or counters were asked for
+    TimeReport *report = nullptr;
+    Trace *trace = nullptr;
+    PerfCounters *perf = nullptr;
+    if (!traceName.empty())
+        trace = new Trace();
+    if (perfCounters) {
+        perf = new PerfCounters();
+        if (!perf->open()) {
+            cerr << "warning: continuing without hardware counters: " << perf->getError() << std::endl;
+            delete perf;
+            perf = nullptr;
+        }
+    }
+    if (timeReportText || !timeReportJSON.empty() || trace || perf) {
+        report = new TimeReport();
+        report->setTrace(trace);
+        report->setPerfCounters(perf);
+    }
+
+    ANTLRInputStream *input = nullptr;
+    smallCLexer *lexer = nullptr;
+    CommonTokenStream *tokens = nullptr;
+    smallCParser *parser = nullptr;
+    ParserProfile *parserProfile = nullptr;
+    LazyParser *lazy = nullptr;
+    SemanticAnalyzer *sema = nullptr;
+    Module *ir = nullptr;
+    size_t inputBytes = 0;
+    size_t numTokens = 0;
+    size_t syntaxErrors = 0;
+
+    // Only checking runs are cached: their results are what they print
+    // and their status, and the AST file if one is written. A parser
+    // profile is about the run, not the source, so it is not replayed.
+    CompileCache *cache = nullptr;
+    CompileCache::Entry cacheEntry;
+    std::string cacheKey;
+    bool cacheResult = true;
+    if (!cacheDir.empty() && !emitAsm && !dumpIR && !profileParser) {
+        cache = new CompileCache(cacheDir, cacheMB << 20);
+        if (!cache->open()) {
+            cerr << "warning: continuing without the cache: " << cache->getError() << std::endl;
+            delete cache;
+            cache = nullptr;
+        }
+    }
+
+    // Every exit from here on frees what the compile built and prints the
+    // report. The AST is not freed: its node destructors print a trace
+    // message, which would end up in the compiler's output.
+    auto finish = [&](int status) {
+        if (cache && !cacheKey.empty()) {
+            TimeReport::Timer timer(report, "cache store");
+            cache->stopCapture(cacheEntry);
+            cacheEntry.status = status;
+            if (!emitASTName.empty() && status == 0) {
+                ifstream astStream(emitASTName, std::ios::binary);
+                std::stringstream ast;
+                ast << astStream.rdbuf();
+                cacheEntry.ast = ast.str();
+            }
+            if (cacheResult && !cache->store(cacheKey, cacheEntry))
+                cerr << "warning: " << cache->getError() << std::endl;
+        }
+        delete cache;
+        {
+            TimeReport::Timer timer(report, "teardown");
+            delete parser;
+            delete parserProfile;
+            delete lazy;
+            delete tokens;
+            delete lexer;
+            delete input;
+            delete sema;
+            delete ir;
+        }
+        if (memStats) {
+            MemStats::clear(MemStats::Antlr);
+            MemStats::print(cerr);
+        }
+        if (report) {
+            if (timeReportText) {
+                report->printText(cerr);
+                printThroughput(cerr, report, inputBytes, numTokens);
+            }
+            else if (perf)
+                report->printCounters(cerr);
+            if (!timeReportJSON.empty()) {
+                ofstream jsonStream(timeReportJSON);
+                if (jsonStream)
+                    report->printJSON(jsonStream);
+                else
+                    cerr << "warning: cannot open " << timeReportJSON << " for writing" << std::endl;
+            }
+            delete report;
+            delete perf;
+        }
+        if (trace) {
+            ofstream traceStream(traceName);
+            if (traceStream)
+                trace->print(traceStream);
+            else
+                cerr << "warning: cannot open " << traceName << " for writing" << std::endl;
+            delete trace;
+        }
+        return status;
+    };
+
     // Input stream handler
     ifstream inputStream;
 
     // Open the input file
-    inputStream.open(argv[1]);
+    inputStream.open(inputName);
     if (!inputStream) {
-    	cerr << "fatal: " << argv[1] << " not found or cannot be opened" << std::endl;
-	return -1;
-    }
-
-    // Create the input stream to the lexer
-    ANTLRInputStream input(inputStream);
-   
-    // Create a lexer which scans the input stream
-    // to create a token stream.
-    smallCLexer* lexer = new smallCLexer(&input);
-    CommonTokenStream tokens(lexer);
-
-    // Get the tokens
-    tokens.fill();
-
-    // Create a parser 
-    smallCParser* parser = new smallCParser(&tokens);
-
-    // Invoke the parser and get the root of the AST, i.e., the ProgramNode
-    ProgramNode* prg = parser->program()->prg;
-
-    // Uncomment these lines to print the AST tree using the provided
-    // ASTPrinter class
-    //ASTPrinter *printer = new smallc::ASTPrinter();
-    //if (parser->getNumberOfSyntaxErrors() == 0) {
-        //printer->visitProgramNode(prg);
-    //}
-    //else {
-        //cout << "cannot print AST with parse errors\n";
-    //}
-
-    // ECE467 STUDENT: add code to create your semantic analyzer
-    // object and invoke it by by visiting the program node
-    // Once done, check if there are error messages and print them
-        
-    return 0;
+        cerr << "fatal: " << inputName << " not found or cannot be opened" << std::endl;
+        return finish(-1);
+    }
+
+    // The source is kept for the cache to hash and for the line table,
+    // which turns the nodes' offsets into lines and columns
+    std::string source;
+    {
+        TimeReport::Timer timer(report, "input read");
+        std::stringstream bytes;
+        bytes << inputStream.rdbuf();
+        source = bytes.str();
+    }
+    LineTable lineTable(source);
+    LineTable::setCurrent(&lineTable);
+
+    if (cache) {
+        // The options that change what a checking run prints or writes
+        std::string options = std::string("print-ast=") + (printAST ? "1" : "0") +
+                              " print-ast-json=" + (printASTJSON ? "1" : "0") +
+                              " signatures=" + (signatures ? "1" : "0") +
+                              " decl-hashes=" + (declHashes ? "1" : "0") +
+                              " emit-ast=" + (emitASTName.empty() ? "0" : "1");
+        bool hit;
+        {
+            TimeReport::Timer timer(report, "cache lookup");
+            cacheKey = cache->makeKey(source, options);
+            hit = cache->lookup(cacheKey, cacheEntry);
+        }
+        if (hit) {
+            cout << cacheEntry.out << std::flush;
+            cerr << cacheEntry.err << std::flush;
+            if (!emitASTName.empty() && !cacheEntry.ast.empty()) {
+                ofstream astStream(emitASTName, std::ios::binary);
+                astStream << cacheEntry.ast;
+            }
+            cacheKey.clear();
+            inputBytes = source.size();
+            return finish(cacheEntry.status);
+        }
+        cache->startCapture();
+    }
+
+    {
+        TimeReport::Timer timer(report, "lexing");
+
+        // Create the input stream to the lexer
+        input = new ANTLRInputStream(source);
+
+        // Create a lexer which scans the input stream
+        // to create a token stream.
+        lexer = new smallCLexer(input);
+        tokens = new CommonTokenStream(lexer);
+
+        // Get the tokens
+        tokens->fill();
+    }
+    inputBytes = input->size();
+    numTokens = tokens->size();
+    if (memStats)
+        countTokens(tokens);
+
+    smallCParser::ProgramContext* tree = nullptr;
+    ProgramNode* prg = nullptr;
+
+    // Nothing in the AST points back into ANTLR: locations and names were
+    // copied out of the tokens. Once every body is parsed, the parser's
+    // rule contexts, which it keeps until it is deleted even without a
+    // parse tree, and the tokens and input go, so the AST is the only
+    // tree left for the rest of the compile.
+    auto releaseParse = [&]() {
+        TimeReport::Timer timer(report, "parse tree release");
+        delete parserProfile;
+        delete parser;
+        delete lazy;
+        delete tokens;
+        delete lexer;
+        delete input;
+        parserProfile = nullptr;
+        parser = nullptr;
+        lazy = nullptr;
+        tokens = nullptr;
+        lexer = nullptr;
+        input = nullptr;
+        tree = nullptr;
+        if (memStats)
+            MemStats::clear(MemStats::Antlr);
+    };
+
+    // Tools that only want the program's interface skip the function
+    // bodies, and a parallel parse splits the program at them; the
+    // signature scan gives up on malformed input, which the full parse
+    // then reports
+    if (signatures || parseThreads >= 0) {
+        TimeReport::Timer timer(report, "signature parsing");
+        lazy = new LazyParser(tokens);
+        prg = lazy->parseSignatures();
+        if (!prg) {
+            delete lazy;
+            lazy = nullptr;
+        }
+    }
+
+    if (lazy && parseThreads >= 0) {
+        {
+            TimeReport::Timer timer(report, "parallel parsing");
+            unsigned int threads = parseThreads;
+            if (threads == 0)
+                threads = std::max(1u, std::thread::hardware_concurrency());
+            lazy->parseBodies(threads, trace);
+        }
+        syntaxErrors = lazy->getNumSyntaxErrors();
+        if (!keepParseTree)
+            releaseParse();
+    }
+
+    if (!prg) {
+        {
+            TimeReport::Timer timer(report, "parsing");
+
+            // Create a parser
+            parser = new smallCParser(tokens);
+
+            // The grammar's actions build the AST as they parse, so the parse
+            // tree is only wanted to look at ANTLR's memory
+            parser->setBuildParseTree(keepParseTree || memStats);
+            if (profileParser) {
+                parserProfile = new ParserProfile(parser);
+                std::string grammar = parser->getGrammarFileName();
+                std::string exe = argv[0];
+                size_t slash = exe.rfind('/');
+                if (!parserProfile->readGrammar(grammar) &&
+                    (slash == std::string::npos || !parserProfile->readGrammar(exe.substr(0, slash + 1) + grammar)))
+                    cerr << "warning: cannot find " << grammar << "; grammar lines are not reported" << std::endl;
+            }
+
+            // Invoke the parser and get the root of the AST, i.e., the ProgramNode
+            tree = parser->program();
+            prg = tree->prg;
+        }
+        if (memStats)
+            countParseTree(parser, tree);
+
+        if (parserProfile)
+            parserProfile->print(cerr);
+        syntaxErrors = parser->getNumberOfSyntaxErrors();
+
+        if (!keepParseTree)
+            releaseParse();
+    }
+
+    // Print the AST tree using the provided ASTPrinter class
+    if (printAST || printASTJSON) {
+        if (syntaxErrors == 0) {
+            TimeReport::Timer timer(report, "AST printing");
+            if (printAST) {
+                ASTPrinter printer;
+                printer.visitProgramNode(prg);
+            }
+            if (printASTJSON) {
+                ASTJSONPrinter printer;
+                printer.visitProgramNode(prg);
+            }
+        }
+        else
+            cout << "cannot print AST with parse errors\n";
+    }
+
+    // Hashing visits every body, so it parses those not parsed yet
+    if (declHashes && syntaxErrors == 0) {
+        TimeReport::Timer timer(report, "AST hashing");
+        ASTHasher hasher;
+        hasher.hash(prg);
+    }
+
+    // Bodies parsed on demand, by the AST printer or the hasher, report
+    // their errors as they are parsed
+    if (lazy)
+        syntaxErrors = lazy->getNumSyntaxErrors();
+    if (syntaxErrors != 0)
+        return finish(-1);
+
+    if (declHashes) {
+        printDeclHashes(cout, prg);
+        return finish(0);
+    }
+
+    if (signatures) {
+        {
+            TimeReport::Timer timer(report, "signature printing");
+            printSignatures(cout, prg);
+        }
+        return finish(0);
+    }
+
+    // Run semantic analysis and report any errors
+    {
+        TimeReport::Timer timer(report, "semantic analysis");
+        sema = trace ? new TracingSemanticAnalyzer(trace) : new SemanticAnalyzer();
+        TimeReport::Timer visit(report, "SemanticAnalyzer");
+        sema->visitProgramNode(prg);
+    }
+    if (!sema->success()) {
+        {
+            TimeReport::Timer timer(report, "error printing");
+            sema->printErrorMsgs();
+        }
+        return finish(-1);
+    }
+
+    if (!emitASTName.empty()) {
+        bool written;
+        {
+            TimeReport::Timer timer(report, "AST writing");
+            ASTWriter writer;
+            written = writer.write(prg, emitASTName);
+        }
+        if (!written) {
+            cerr << "fatal: cannot write " << emitASTName << std::endl;
+            cacheResult = false;
+            return finish(-1);
+        }
+    }
+
+    if (!emitAsm && !dumpIR)
+        return finish(0);
+
+    // Lower the checked program to SSA IR and optimize it
+    {
+        TimeReport::Timer timer(report, "IR generation");
+        IRGen *irgen = new IRGen();
+        irgen->setBoundsChecks(boundsChecks);
+
+        // Functions main can never reach are dropped before any work is done on them
+        CallGraph callGraph;
+        {
+            TimeReport::Timer visit(report, "CallGraph");
+            callGraph.visitProgramNode(prg);
+        }
+        std::set<std::string> live = callGraph.getReachableFrom("main");
+        if (!live.empty()) {
+            irgen->setLiveFunctions(live);
+            unsigned int dropped = 0;
+            for (auto node : callGraph.getNodes()) {
+                if (node->isDefined() && !live.count(node->name))
+                    dropped++;
+            }
+            if (printStats)
+                cerr << "dfe: " << dropped << " functions unreachable from main dropped" << std::endl;
+        }
+        {
+            TimeReport::Timer visit(report, "IRGen");
+            irgen->visitProgramNode(prg);
+        }
+        ir = irgen->releaseModule();
+        delete irgen;
+    }
+
+    // Profile sites are numbered on the IR as generated, before any pass
+    // changes it, so both builds agree on them
+    ProfileData profile;
+    if (!profileUse.empty() && !profile.read(profileUse, cerr))
+        return finish(-1);
+
+    PassManager passes;
+    passes.setVerifyEach(verifyIR);
+    passes.setPrintStatistics(printStats);
+    passes.setTimeReport(report);
+    if (!profileGenerate.empty())
+        passes.add(new ProfileInstrument());
+    if (!profileUse.empty())
+        passes.add(new ProfileAnnotate(profile));
+    if (optimize) {
+        Inliner *inliner = new Inliner();
+        if (inlineReport)
+            inliner->setReport(&cerr);
+        if (inlineThreshold >= 0)
+            inliner->setThreshold(inlineThreshold);
+        passes.add(new TailRecursion());     // Loops may make a function inlinable
+        passes.add(inliner);
+        passes.add(new SCCP());
+        passes.add(new GVN());
+        // After GVN, so repeated index expressions are one value
+        passes.add(new BoundsCheckElim(cerr, true));
+        passes.add(new LICM());
+        passes.add(new StrengthReduce());
+        if (vectorize)
+            passes.add(new Vectorizer());
+        passes.add(new DeadCodeElim());
+        passes.add(new BlockLayout());      // Only with a profile
+    }
+    else
+        passes.add(new BoundsCheckElim(cerr, false));   // Only report bad accesses
+    bool verified;
+    {
+        TimeReport::Timer timer(report, optimize ? "optimization" : "IR passes");
+        verified = passes.run(ir);
+    }
+    if (!verified)
+        return finish(-1);
+    if (timePasses)
+        passes.printTimings(cerr);
+    if (dumpIR)
+        ir->print(cout);
+
+    // Compile the optimized IR to assembly
+    if (emitAsm) {
+        if (outputName.empty()) {
+            outputName = inputName;
+            size_t dot = outputName.rfind('.');
+            if (dot != std::string::npos && outputName.find('/', dot) == std::string::npos)
+                outputName.erase(dot);
+            outputName += ".s";
+        }
+        ofstream asmStream(outputName);
+        if (!asmStream) {
+            cerr << "fatal: cannot open " << outputName << " for writing" << std::endl;
+            return finish(-1);
+        }
+
+        TimeReport::Timer timer(report, "code generation");
+        CodeGen *codegen = new CodeGen();
+        {
+            TimeReport::Timer select(report, "instruction selection");
+            codegen->run(ir);
+        }
+        MachineModule *module = codegen->releaseModule();
+        module->profileFile = profileGenerate;
+        {
+            TimeReport::Timer regalloc(report, "register allocation");
+            for (auto fn : module->functions) {
+                LinearScan regalloc(fn);
+                regalloc.run();
+            }
+        }
+        {
+            TimeReport::Timer emit(report, "assembly emission");
+            AsmPrinter printer(asmStream);
+            printer.printModule(module);
+        }
+        delete module;
+        delete codegen;
+    }
+
+    return finish(0);
 }
 
@@ -0,0 +1,169 @@
+//
+//  ASTFile.cpp
+//  ECE467 Lab 3
+//
+//  Reading the binary AST format through a memory mapping.
+//
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ASTFile.h"
+#include "ASTNodes.h"
+
+namespace smallc {
+
+ASTFile::ASTFile()
+    : data(nullptr), size(0), header(nullptr), nodes(nullptr), children(nullptr), strings(nullptr), error() {}
+
+ASTFile::~ASTFile() {
+    if (data)
+        munmap((void*)data, size);
+}
+
+bool ASTFile::fail(const std::string &message) {
+    error = message;
+    return false;
+}
+
+bool ASTFile::open(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return fail(path + ": " + std::strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return fail(path + ": " + std::strerror(errno));
+    }
+    size = st.st_size;
+    if (size < sizeof(Header)) {
+        ::close(fd);
+        return fail(path + ": too short for an AST file");
+    }
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        return fail(path + ": mmap: " + std::strerror(errno));
+    data = (const char*)mapping;
+    if (!validate()) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+// Bounds are checked once here so the accessors need not; children
+// coming before their parent also rules out cycles
+bool ASTFile::validate() {
+    header = (const Header*)data;
+    if (header->magic == __builtin_bswap32(Magic))
+        return fail("written on a machine of the other byte order");
+    if (header->magic != Magic)
+        return fail("not an AST file");
+    if (header->version != Version)
+        return fail("AST format version " + std::to_string(header->version) + ", expected " +
+                    std::to_string(Version));
+
+    unsigned long long expected = sizeof(Header) + (unsigned long long)header->numNodes * sizeof(Node) +
+                                  (unsigned long long)header->numChildren * sizeof(uint32_t) +
+                                  header->stringBytes;
+    if (expected != size)
+        return fail("size does not match the header");
+    if (header->numNodes == 0 || header->root != header->numNodes - 1)
+        return fail("no root node");
+    if (header->stringBytes > 0 && data[size - 1] != '\0')
+        return fail("strings are not terminated");
+
+    nodes = (const Node*)(data + sizeof(Header));
+    children = (const uint32_t*)(nodes + header->numNodes);
+    strings = (const char*)(children + header->numChildren);
+    for (uint32_t i = 0; i < header->numNodes; i++) {
+        const Node &node = nodes[i];
+        if (node.kind >= NumKinds)
+            return fail("node " + std::to_string(i) + " is of no known kind");
+        if (node.name != NoName && node.name >= header->stringBytes)
+            return fail("node " + std::to_string(i) + " has its name out of bounds");
+        if ((unsigned long long)node.children + node.numChildren > header->numChildren)
+            return fail("node " + std::to_string(i) + " has its children out of bounds");
+        for (uint32_t c = 0; c < node.numChildren; c++) {
+            if (children[node.children + c] >= i)
+                return fail("node " + std::to_string(i) + " has a child that does not precede it");
+        }
+    }
+    return true;
+}
+
+const std::string &ASTFile::getError() {
+    return error;
+}
+
+uint32_t ASTFile::getNumNodes() {
+    return header->numNodes;
+}
+
+const ASTFile::Node &ASTFile::getRoot() {
+    return nodes[header->root];
+}
+
+const ASTFile::Node &ASTFile::getNode(uint32_t index) {
+    return nodes[index];
+}
+
+const ASTFile::Node &ASTFile::getChild(const Node &node, uint32_t i) {
+    return nodes[children[node.children + i]];
+}
+
+const char* ASTFile::getName(const Node &node) {
+    return node.name == NoName ? nullptr : strings + node.name;
+}
+
+const char* ASTFile::getKindName(uint8_t kind) {
+    static const char* names[NumKinds] = {
+        "Program", "ScalarDecl", "ArrayDecl", "FunctionDecl", "Parameter", "Scope",
+        "ExprStmt", "AssignStmt", "IfStmt", "WhileStmt", "ReturnStmt",
+        "UnaryExpr", "BinaryExpr", "BoolExpr", "IntExpr", "BoolConstant", "IntConstant",
+        "Call", "Reference"
+    };
+    return kind < NumKinds ? names[kind] : "?";
+}
+
+/**********************************************************************************/
+/* Printing                                                                       */
+/**********************************************************************************/
+
+void ASTFile::print(std::ostream &out) {
+    print(out, header->root, 0);
+}
+
+void ASTFile::print(std::ostream &out, uint32_t index, unsigned int depth) {
+    const Node &node = nodes[index];
+    out << std::string(2 * depth, ' ') << getKindName(node.kind);
+    switch (node.type) {
+        case TypeNode::Void:    out << " void"; break;
+        case TypeNode::Int:     out << " int"; break;
+        case TypeNode::Bool:    out << " bool"; break;
+        default:                break;
+    }
+    if (node.kind == UnaryExpr || node.kind == BinaryExpr)
+        out << " " << ExprNode::codeToStr(node.op);
+    if (node.name != NoName)
+        out << " " << strings + node.name;
+    if (node.kind == ArrayDecl)
+        out << "[" << node.value << "]";
+    else if (node.flags & IsArray)
+        out << "[]";
+    if (node.flags & UsesIo)
+        out << " io";
+    if (node.flags & IsProto)
+        out << " proto";
+    out << " (" << node.line << ":" << node.col << ")\n";
+    for (uint32_t c = 0; c < node.numChildren; c++)
+        print(out, children[node.children + c], depth + 1);
+}
+
+} // namespace smallc
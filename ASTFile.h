@@ -0,0 +1,138 @@
+//
+//  ASTFile.h
+//  ECE467 Lab 3
+//
+//  Binary format of a checked program's AST, written by ASTWriter for
+//  --emit-ast and read back by mapping the file into memory. The format
+//  is a flat image meant to be used in place: tools that run after the
+//  compiler read it through the mapping, with no parsing and no
+//  allocation per node.
+//
+//  A file is a header followed by three arrays:
+//
+//   - the nodes, fixed size records, each with its kind, location, type,
+//     operator, value, name and the range of its children;
+//   - the children, node indices, the children of a node contiguous and
+//     in source order;
+//   - the strings, identifiers and constant spellings, each ending in a
+//     NUL and stored once however often it is used.
+//
+//  Nodes are written children first, so every child has a smaller index
+//  than its parent and the root is the last node. Types and identifiers
+//  are folded into the node that owns them, and function arguments are
+//  the call's children directly.
+//
+//  Integers are in the writer's byte order; the magic number tells a file
+//  of the other order apart. A change to the layout changes Version, and
+//  files of any other version are rejected.
+//
+
+#ifndef ASTFile_h
+#define ASTFile_h
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace smallc {
+
+class ASTFile {
+public:
+    static const uint32_t Magic = 0x54534153;   // "SAST" in little endian
+    static const uint16_t Version = 1;
+    static const uint32_t NoName = 0xffffffff;
+    static const uint8_t NoType = 0xff;         // An expression not typed
+
+    enum Kind {
+        Program = 0, ScalarDecl, ArrayDecl, FunctionDecl, Parameter, Scope,
+        ExprStmt, AssignStmt, IfStmt, WhileStmt, ReturnStmt,
+        UnaryExpr, BinaryExpr, BoolExpr, IntExpr, BoolConstant, IntConstant,
+        Call, Reference, NumKinds
+    };
+
+    // Flags of a node
+    enum {
+        UsesIo = 1,         // Program: the I/O library is included
+        IsArray = 2,        // ArrayDecl, Parameter
+        IsProto = 4,        // FunctionDecl
+        HasElse = 8         // IfStmt
+    };
+
+    class Header {
+    public:
+        uint32_t magic;
+        uint16_t version;
+        uint16_t reserved;
+        uint32_t numNodes;
+        uint32_t numChildren;
+        uint32_t stringBytes;
+        uint32_t root;
+    };
+
+    // The children of each kind, in order:
+    //   Program         the global declarations
+    //   FunctionDecl    the parameters, then the body unless IsProto
+    //   Scope           the value declarations, then the statements
+    //   ExprStmt        the expression
+    //   AssignStmt      the target Reference, then the value
+    //   IfStmt          the condition, then, and else with HasElse
+    //   WhileStmt       the condition, then the body
+    //   ReturnStmt      the value, if any
+    //   UnaryExpr, BoolExpr, IntExpr    the operand
+    //   BinaryExpr      the left, then the right operand
+    //   Call            the arguments
+    //   Reference       the index, if the reference is to an element
+    class Node {
+    public:
+        uint8_t kind;
+        uint8_t type;       // TypeNode::TypeEnum of the declaration,
+                            // return, element or expression
+        uint8_t flags;
+        int8_t op;          // ExprNode::Opcode of an operator
+        uint32_t line;
+        uint32_t col;
+        int32_t value;      // Array size, constant value or number of
+                            // parameters or scope declarations
+        uint32_t name;      // Offset in the strings, or NoName
+        uint32_t children;  // Index of the first child in the children
+        uint32_t numChildren;
+    };
+
+private:
+    const char* data;
+    size_t size;
+    const Header* header;
+    const Node* nodes;
+    const uint32_t* children;
+    const char* strings;
+    std::string error;
+
+    bool fail(const std::string &message);
+    bool validate();
+    void print(std::ostream &out, uint32_t node, unsigned int depth);
+
+public:
+    ASTFile();
+    ~ASTFile();
+
+    // Maps the file and checks that it is well-formed; on failure the
+    // reason is in getError
+    bool open(const std::string &path);
+    const std::string &getError();
+
+    uint32_t getNumNodes();
+    const Node &getRoot();
+    const Node &getNode(uint32_t index);
+    const Node &getChild(const Node &node, uint32_t i);
+    const char* getName(const Node &node);  // nullptr without a name
+
+    static const char* getKindName(uint8_t kind);
+
+    // One line per node, indented by depth
+    void print(std::ostream &out);
+};
+
+} // namespace smallc
+
+#endif /* ASTFile_h */
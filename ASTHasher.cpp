@@ -0,0 +1,271 @@
+//
+//  ASTHasher.cpp
+//  ECE467 Lab 3
+//
+//  Merkle hashes of the global declarations.
+//
+
+#include "ASTFile.h"
+#include "ASTHasher.h"
+
+namespace smallc {
+
+ASTHasher::ASTHasher() : globals(), signatures(), scopes(), last(0) {}
+
+void ASTHasher::hash(ProgramNode* prg) {
+    globals.clear();
+    signatures.clear();
+    scopes.clear();
+
+    // Every signature first, since a function may call one defined after
+    // it; a definition's signature takes the place of its prototype's
+    for (unsigned int i = 0; i < prg->getNumChildren(); i++) {
+        ASTNode* child = prg->getChild(i);
+        if (auto func = dynamic_cast<FunctionDeclNode*>(child)) {
+            std::string name = func->getIdent()->getName();
+            if (!func->getProto() || signatures.find(name) == signatures.end())
+                signatures[name] = signatureOf(func);
+        }
+        else if (auto decl = dynamic_cast<DeclNode*>(child)) {
+            decl->setHash(hashOf(decl));
+            globals[decl->getIdent()->getName()] = decl->getHash();
+        }
+    }
+    for (unsigned int i = 0; i < prg->getNumChildren(); i++) {
+        if (auto func = dynamic_cast<FunctionDeclNode*>(prg->getChild(i)))
+            func->setHash(hashOf(func));
+    }
+}
+
+HashValue ASTHasher::hashOf(ASTNode* node) {
+    node->visit(this);
+    return last;
+}
+
+HashValue ASTHasher::signatureOf(FunctionDeclNode* func) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::FunctionDecl);
+    hashType(hasher, func->getRetType());
+    hasher.addField(func->getIdent()->getName());
+    hasher.addField((uint64_t)func->getNumParameters());
+    for (auto param : func->getParams())
+        hashType(hasher, param->getType());
+    return hasher.digest();
+}
+
+void ASTHasher::hashType(Hasher &hasher, TypeNode* type) {
+    hasher.addField((uint64_t)type->getTypeEnum());
+    hasher.addField((uint64_t)type->isArray());
+    if (type->isArray())
+        hasher.addField((uint64_t)static_cast<ArrayTypeNode*>(type)->getSize());
+}
+
+void ASTHasher::declareLocal(const std::string &name) {
+    if (!scopes.empty())
+        scopes.back().insert(name);
+}
+
+bool ASTHasher::isLocal(const std::string &name) {
+    for (auto scope = scopes.rbegin(); scope != scopes.rend(); ++scope) {
+        if (scope->count(name))
+            return true;
+    }
+    return false;
+}
+
+/**********************************************************************************/
+/* Declarations                                                                   */
+/**********************************************************************************/
+
+void ASTHasher::visitScalarDeclNode(ScalarDeclNode *scalar) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::ScalarDecl);
+    hashType(hasher, scalar->getType());
+    hasher.addField(scalar->getIdent()->getName());
+    declareLocal(scalar->getIdent()->getName());
+    last = hasher.digest();
+}
+
+void ASTHasher::visitArrayDeclNode(ArrayDeclNode *array) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::ArrayDecl);
+    hashType(hasher, array->getType());
+    hasher.addField(array->getIdent()->getName());
+    declareLocal(array->getIdent()->getName());
+    last = hasher.digest();
+}
+
+// The parameters' names are in the function's hash but not in its
+// signature's, so renaming one does not reach the callers
+void ASTHasher::visitFunctionDeclNode(FunctionDeclNode *func) {
+    Hasher hasher;
+    hasher.addHash(signatureOf(func));
+    hasher.addField((uint64_t)func->getProto());
+    if (!func->getProto() && func->getBody()) {
+        scopes.push_back(std::set<std::string>());
+        for (auto param : func->getParams())
+            hasher.addHash(hashOf(param));
+        hasher.addHash(hashOf(func->getBody()));
+        scopes.pop_back();
+    }
+    last = hasher.digest();
+}
+
+void ASTHasher::visitParameterNode(ParameterNode *param) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::Parameter);
+    hashType(hasher, param->getType());
+    hasher.addField(param->getIdent()->getName());
+    declareLocal(param->getIdent()->getName());
+    last = hasher.digest();
+}
+
+/**********************************************************************************/
+/* Statements                                                                     */
+/**********************************************************************************/
+
+void ASTHasher::visitScopeNode(ScopeNode *scope) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::Scope);
+    scopes.push_back(std::set<std::string>());
+    std::vector<DeclNode*> decls = scope->getDeclarations();
+    hasher.addField((uint64_t)decls.size());
+    for (auto decl : decls)
+        hasher.addHash(hashOf(decl));
+    for (unsigned int i = 0; i < scope->getNumChildren(); i++) {
+        if (scope->getChild(i))
+            hasher.addHash(hashOf(scope->getChild(i)));
+    }
+    scopes.pop_back();
+    last = hasher.digest();
+}
+
+void ASTHasher::visitExprStmtNode(ExprStmtNode *expr) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::ExprStmt);
+    hasher.addHash(hashOf(expr->getExpr()));
+    last = hasher.digest();
+}
+
+void ASTHasher::visitAssignStmtNode(AssignStmtNode *assign) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::AssignStmt);
+    hasher.addHash(hashOf(assign->getTarget()));
+    hasher.addHash(hashOf(assign->getValue()));
+    last = hasher.digest();
+}
+
+void ASTHasher::visitIfStmtNode(IfStmtNode *ifStmt) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::IfStmt);
+    hasher.addField((uint64_t)ifStmt->getHasElse());
+    hasher.addHash(hashOf(ifStmt->getCondition()));
+    hasher.addHash(hashOf(ifStmt->getThen()));
+    if (ifStmt->getHasElse())
+        hasher.addHash(hashOf(ifStmt->getElse()));
+    last = hasher.digest();
+}
+
+void ASTHasher::visitWhileStmtNode(WhileStmtNode *whileStmt) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::WhileStmt);
+    hasher.addHash(hashOf(whileStmt->getCondition()));
+    hasher.addHash(hashOf(whileStmt->getBody()));
+    last = hasher.digest();
+}
+
+void ASTHasher::visitReturnStmtNode(ReturnStmtNode *ret) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::ReturnStmt);
+    hasher.addField((uint64_t)(ret->getReturn() != nullptr));
+    if (ret->getReturn())
+        hasher.addHash(hashOf(ret->getReturn()));
+    last = hasher.digest();
+}
+
+/**********************************************************************************/
+/* Expressions                                                                    */
+/**********************************************************************************/
+
+// Expression types are left out: they are only known after semantic
+// analysis, and follow from the rest of the hash anyway
+
+void ASTHasher::visitUnaryExprNode(UnaryExprNode *unary) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::UnaryExpr);
+    hasher.addField((uint64_t)unary->getOpcode());
+    hasher.addHash(hashOf(unary->getOperand()));
+    last = hasher.digest();
+}
+
+void ASTHasher::visitBinaryExprNode(BinaryExprNode *bin) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::BinaryExpr);
+    hasher.addField((uint64_t)bin->getOpcode());
+    hasher.addHash(hashOf(bin->getLeft()));
+    hasher.addHash(hashOf(bin->getRight()));
+    last = hasher.digest();
+}
+
+void ASTHasher::visitBoolExprNode(BoolExprNode *boolExpr) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::BoolExpr);
+    hasher.addHash(hashOf(boolExpr->getValue()));
+    last = hasher.digest();
+}
+
+void ASTHasher::visitIntExprNode(IntExprNode *intExpr) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::IntExpr);
+    hasher.addHash(hashOf(intExpr->getValue()));
+    last = hasher.digest();
+}
+
+void ASTHasher::visitBoolConstantNode(BoolConstantNode *boolConst) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::BoolConstant);
+    hasher.addField((uint64_t)boolConst->getVal());
+    last = hasher.digest();
+}
+
+void ASTHasher::visitIntConstantNode(IntConstantNode *intConst) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::IntConstant);
+    hasher.addField((uint64_t)intConst->getVal());
+    last = hasher.digest();
+}
+
+void ASTHasher::visitArgumentNode(ArgumentNode *arg) {
+    last = hashOf(arg->getExpr());
+}
+
+// Library functions have no signature in the program; their name is
+// all there is to hash
+void ASTHasher::visitCallExprNode(CallExprNode *call) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::Call);
+    std::string name = call->getIdent()->getName();
+    hasher.addField(name);
+    auto callee = signatures.find(name);
+    hasher.addHash(callee != signatures.end() ? callee->second : 0);
+    std::vector<ArgumentNode*> args = call->getArguments();
+    hasher.addField((uint64_t)args.size());
+    for (auto arg : args)
+        hasher.addHash(hashOf(arg));
+    last = hasher.digest();
+}
+
+void ASTHasher::visitReferenceExprNode(ReferenceExprNode *ref) {
+    Hasher hasher;
+    hasher.addField((uint64_t)ASTFile::Reference);
+    std::string name = ref->getIdent()->getName();
+    hasher.addField(name);
+    auto global = isLocal(name) ? globals.end() : globals.find(name);
+    hasher.addHash(global != globals.end() ? global->second : 0);
+    hasher.addField((uint64_t)(ref->getIndex() != nullptr));
+    if (ref->getIndex())
+        hasher.addHash(hashOf(ref->getIndex()));
+    last = hasher.digest();
+}
+
+} // namespace smallc
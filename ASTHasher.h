@@ -0,0 +1,75 @@
+//
+//  ASTHasher.h
+//  ECE467 Lab 3
+//
+//  Merkle hashes of the global declarations, for caching results per
+//  function instead of per file. A node's hash covers its kind, types,
+//  names and values and the hashes of its children, but not its location,
+//  so moving a function or reformatting it keeps its hash.
+//
+//  A function's hash also covers the hashes of the globals it references
+//  and the signatures of the functions it calls, but not their bodies:
+//  editing a function's body changes its own hash only, while changing a
+//  global or a signature changes the hash of every function that uses it.
+//  Names are resolved by scope, so locals and parameters do not pull in
+//  globals they shadow.
+//
+
+#ifndef ASTHasher_h
+#define ASTHasher_h
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ASTNodes.h"
+#include "ASTVisitorBase.h"
+#include "Hash.h"
+
+namespace smallc {
+
+class ASTHasher : public ASTVisitorBase {
+private:
+    std::map<std::string, HashValue> globals;       // Hash of each global variable
+    std::map<std::string, HashValue> signatures;    // Signature hash of each function
+    std::vector<std::set<std::string> > scopes;     // Local names, innermost last
+    HashValue last;                                 // Hash of the node visited last
+
+    HashValue hashOf(ASTNode* node);
+    HashValue signatureOf(FunctionDeclNode* func);
+    void hashType(Hasher &hasher, TypeNode* type);
+    void declareLocal(const std::string &name);
+    bool isLocal(const std::string &name);
+
+public:
+    ASTHasher();
+
+    // Sets the hash of every global declaration in the program. Function
+    // bodies not parsed yet are parsed.
+    void hash(ProgramNode* prg);
+
+    void visitScalarDeclNode(ScalarDeclNode *scalar) override;
+    void visitArrayDeclNode(ArrayDeclNode *array) override;
+    void visitFunctionDeclNode(FunctionDeclNode *func) override;
+    void visitParameterNode(ParameterNode *param) override;
+    void visitScopeNode(ScopeNode *scope) override;
+    void visitExprStmtNode(ExprStmtNode *expr) override;
+    void visitAssignStmtNode(AssignStmtNode *assign) override;
+    void visitIfStmtNode(IfStmtNode *ifStmt) override;
+    void visitWhileStmtNode(WhileStmtNode *whileStmt) override;
+    void visitReturnStmtNode(ReturnStmtNode *ret) override;
+    void visitUnaryExprNode(UnaryExprNode *unary) override;
+    void visitBinaryExprNode(BinaryExprNode *bin) override;
+    void visitBoolExprNode(BoolExprNode *boolExpr) override;
+    void visitIntExprNode(IntExprNode *intExpr) override;
+    void visitBoolConstantNode(BoolConstantNode *boolConst) override;
+    void visitIntConstantNode(IntConstantNode *intConst) override;
+    void visitArgumentNode(ArgumentNode *arg) override;
+    void visitCallExprNode(CallExprNode *call) override;
+    void visitReferenceExprNode(ReferenceExprNode *ref) override;
+};
+
+} // namespace smallc
+
+#endif /* ASTHasher_h */
@@ -0,0 +1,296 @@
+//
+//  ASTJSONPrinter.cpp
+//  ECE467 Lab 3
+//
+//  Printing the AST as JSON.
+//
+
+#include "ASTJSONPrinter.h"
+#include "JSON.h"
+
+namespace smallc {
+
+ASTJSONPrinter::ASTJSONPrinter() : ASTPrinter(), first(true), depth(0) {}
+
+void ASTJSONPrinter::begin(ASTFile::Kind kind, ASTNode* node) {
+    flushIfFull();
+    if (!first)
+        buffer += ',';
+    if (depth == 1)
+        buffer += '\n';
+    first = false;
+    depth++;
+    buffer += "{\"kind\":\"";
+    buffer += ASTFile::getKindName(kind);
+    buffer += '"';
+    std::pair<unsigned int, unsigned int> location = node->getLocation();
+    field("line", location.first);
+    field("col", location.second);
+}
+
+void ASTJSONPrinter::beginChildren() {
+    key("children");
+    buffer += '[';
+    first = true;
+}
+
+void ASTJSONPrinter::endChildren() {
+    buffer += ']';
+    first = false;
+}
+
+void ASTJSONPrinter::end() {
+    buffer += '}';
+    depth--;
+}
+
+void ASTJSONPrinter::key(const char* name) {
+    buffer += ",\"";
+    buffer += name;
+    buffer += "\":";
+}
+
+void ASTJSONPrinter::field(const char* name, const std::string &value) {
+    key(name);
+    appendJSONString(buffer, value);
+}
+
+void ASTJSONPrinter::field(const char* name, long long value) {
+    key(name);
+    appendNumber(value);
+}
+
+void ASTJSONPrinter::flag(const char* name, bool value) {
+    key(name);
+    buffer += value ? "true" : "false";
+}
+
+void ASTJSONPrinter::typeField(const char* name, TypeNode* type) {
+    switch (type->getTypeEnum()) {
+        case TypeNode::Int:     field(name, std::string("int")); break;
+        case TypeNode::Bool:    field(name, std::string("bool")); break;
+        default:                field(name, std::string("void")); break;
+    }
+}
+
+/**********************************************************************************/
+/* Declarations                                                                   */
+/**********************************************************************************/
+
+void ASTJSONPrinter::visitProgramNode(ProgramNode *prg) {
+    first = true;
+    depth = 0;
+    begin(ASTFile::Program, prg);
+    flag("useIO", prg->useIo());
+    beginChildren();
+    for (unsigned int i = 0; i < prg->getNumChildren(); i++) {
+        if (prg->getChild(i))
+            prg->getChild(i)->visit(this);
+    }
+    buffer += '\n';
+    endChildren();
+    end();
+    buffer += '\n';
+    flush();
+}
+
+void ASTJSONPrinter::visitScalarDeclNode(ScalarDeclNode *scalar) {
+    begin(ASTFile::ScalarDecl, scalar);
+    typeField("type", scalar->getType());
+    field("name", scalar->getIdent()->getName());
+    end();
+}
+
+void ASTJSONPrinter::visitArrayDeclNode(ArrayDeclNode *array) {
+    begin(ASTFile::ArrayDecl, array);
+    typeField("type", array->getType());
+    field("size", array->getType()->getSize());
+    field("name", array->getIdent()->getName());
+    end();
+}
+
+void ASTJSONPrinter::visitFunctionDeclNode(FunctionDeclNode *func) {
+    begin(ASTFile::FunctionDecl, func);
+    typeField("type", func->getRetType());
+    field("name", func->getIdent()->getName());
+    flag("isProto", func->getProto());
+    beginChildren();
+    for (auto param : func->getParams())
+        param->visit(this);
+    if (!func->getProto() && func->getBody())
+        func->getBody()->visit(this);
+    endChildren();
+    end();
+}
+
+void ASTJSONPrinter::visitParameterNode(ParameterNode *param) {
+    begin(ASTFile::Parameter, param);
+    typeField("type", param->getType());
+    flag("isArray", param->getType()->isArray());
+    field("name", param->getIdent()->getName());
+    end();
+}
+
+/**********************************************************************************/
+/* Statements                                                                     */
+/**********************************************************************************/
+
+// The declarations are the first numDecls children
+void ASTJSONPrinter::visitScopeNode(ScopeNode *scope) {
+    begin(ASTFile::Scope, scope);
+    std::vector<DeclNode*> decls = scope->getDeclarations();
+    field("numDecls", decls.size());
+    beginChildren();
+    for (auto decl : decls)
+        decl->visit(this);
+    for (unsigned int i = 0; i < scope->getNumChildren(); i++) {
+        if (scope->getChild(i))
+            scope->getChild(i)->visit(this);
+    }
+    endChildren();
+    end();
+}
+
+void ASTJSONPrinter::visitExprStmtNode(ExprStmtNode *expr) {
+    begin(ASTFile::ExprStmt, expr);
+    beginChildren();
+    expr->getExpr()->visit(this);
+    endChildren();
+    end();
+}
+
+void ASTJSONPrinter::visitAssignStmtNode(AssignStmtNode *assign) {
+    begin(ASTFile::AssignStmt, assign);
+    beginChildren();
+    assign->getTarget()->visit(this);
+    assign->getValue()->visit(this);
+    endChildren();
+    end();
+}
+
+void ASTJSONPrinter::visitIfStmtNode(IfStmtNode *ifStmt) {
+    begin(ASTFile::IfStmt, ifStmt);
+    flag("hasElse", ifStmt->getHasElse());
+    beginChildren();
+    ifStmt->getCondition()->visit(this);
+    ifStmt->getThen()->visit(this);
+    if (ifStmt->getHasElse())
+        ifStmt->getElse()->visit(this);
+    endChildren();
+    end();
+}
+
+void ASTJSONPrinter::visitWhileStmtNode(WhileStmtNode *whileStmt) {
+    begin(ASTFile::WhileStmt, whileStmt);
+    beginChildren();
+    whileStmt->getCondition()->visit(this);
+    whileStmt->getBody()->visit(this);
+    endChildren();
+    end();
+}
+
+void ASTJSONPrinter::visitReturnStmtNode(ReturnStmtNode *ret) {
+    begin(ASTFile::ReturnStmt, ret);
+    if (!ret->returnVoid()) {
+        beginChildren();
+        ret->getReturn()->visit(this);
+        endChildren();
+    }
+    end();
+}
+
+/**********************************************************************************/
+/* Expressions                                                                    */
+/**********************************************************************************/
+
+// Expressions have a type once semantic analysis has run
+
+void ASTJSONPrinter::visitUnaryExprNode(UnaryExprNode *unary) {
+    begin(ASTFile::UnaryExpr, unary);
+    if (unary->getType())
+        typeField("type", unary->getType());
+    field("op", ExprNode::codeToStr(unary->getOpcode()));
+    beginChildren();
+    unary->getOperand()->visit(this);
+    endChildren();
+    end();
+}
+
+void ASTJSONPrinter::visitBinaryExprNode(BinaryExprNode *bin) {
+    begin(ASTFile::BinaryExpr, bin);
+    if (bin->getType())
+        typeField("type", bin->getType());
+    field("op", ExprNode::codeToStr(bin->getOpcode()));
+    beginChildren();
+    bin->getLeft()->visit(this);
+    bin->getRight()->visit(this);
+    endChildren();
+    end();
+}
+
+void ASTJSONPrinter::visitBoolExprNode(BoolExprNode *boolExpr) {
+    begin(ASTFile::BoolExpr, boolExpr);
+    if (boolExpr->getType())
+        typeField("type", boolExpr->getType());
+    beginChildren();
+    boolExpr->getValue()->visit(this);
+    endChildren();
+    end();
+}
+
+void ASTJSONPrinter::visitIntExprNode(IntExprNode *intExpr) {
+    begin(ASTFile::IntExpr, intExpr);
+    if (intExpr->getType())
+        typeField("type", intExpr->getType());
+    beginChildren();
+    intExpr->getValue()->visit(this);
+    endChildren();
+    end();
+}
+
+void ASTJSONPrinter::visitBoolConstantNode(BoolConstantNode *boolConst) {
+    begin(ASTFile::BoolConstant, boolConst);
+    if (boolConst->getType())
+        typeField("type", boolConst->getType());
+    flag("value", boolConst->getVal());
+    end();
+}
+
+void ASTJSONPrinter::visitIntConstantNode(IntConstantNode *intConst) {
+    begin(ASTFile::IntConstant, intConst);
+    if (intConst->getType())
+        typeField("type", intConst->getType());
+    field("value", intConst->getVal());
+    end();
+}
+
+void ASTJSONPrinter::visitArgumentNode(ArgumentNode *arg) {
+    arg->getExpr()->visit(this);
+}
+
+void ASTJSONPrinter::visitCallExprNode(CallExprNode *call) {
+    begin(ASTFile::Call, call);
+    if (call->getType())
+        typeField("type", call->getType());
+    field("name", call->getIdent()->getName());
+    beginChildren();
+    for (auto arg : call->getArguments())
+        arg->visit(this);
+    endChildren();
+    end();
+}
+
+void ASTJSONPrinter::visitReferenceExprNode(ReferenceExprNode *ref) {
+    begin(ASTFile::Reference, ref);
+    if (ref->getType())
+        typeField("type", ref->getType());
+    field("name", ref->getIdent()->getName());
+    if (ref->getIndex()) {
+        beginChildren();
+        ref->getIndex()->visit(this);
+        endChildren();
+    }
+    end();
+}
+
+} // namespace smallc
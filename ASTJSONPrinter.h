@@ -0,0 +1,68 @@
+//
+//  ASTJSONPrinter.h
+//  ECE467 Lab 3
+//
+//  Prints the AST as one JSON object, for --print-ast-json. Every node is
+//  an object with its "kind", "line" and "col", its attributes and, if it
+//  has any, its "children" array. Kinds are those of the binary AST
+//  format. As in that format, types and identifiers are attributes of
+//  their node rather than nodes, and call arguments are the expressions
+//  themselves.
+//
+//  The output streams through the ASTPrinter's buffer, with a line per
+//  top-level declaration, so it never holds more than a buffer's worth.
+//
+
+#ifndef ASTJSONPrinter_h
+#define ASTJSONPrinter_h
+
+#include <string>
+
+#include "ASTFile.h"
+#include "ASTPrinter.h"
+
+namespace smallc {
+
+class ASTJSONPrinter : public ASTPrinter {
+private:
+    bool first;             // No element yet in the array being printed
+    unsigned int depth;     // Nodes open
+
+    void begin(ASTFile::Kind kind, ASTNode* node);
+    void beginChildren();
+    void endChildren();
+    void end();
+    void key(const char* name);
+    void field(const char* name, const std::string &value);
+    void field(const char* name, long long value);
+    void flag(const char* name, bool value);
+    void typeField(const char* name, TypeNode* type);
+
+public:
+    ASTJSONPrinter();
+
+    void visitProgramNode(ProgramNode *prg) override;
+    void visitScalarDeclNode(ScalarDeclNode *scalar) override;
+    void visitArrayDeclNode(ArrayDeclNode *array) override;
+    void visitFunctionDeclNode(FunctionDeclNode *func) override;
+    void visitParameterNode(ParameterNode *param) override;
+    void visitScopeNode(ScopeNode *scope) override;
+    void visitExprStmtNode(ExprStmtNode *expr) override;
+    void visitAssignStmtNode(AssignStmtNode *assign) override;
+    void visitIfStmtNode(IfStmtNode *ifStmt) override;
+    void visitWhileStmtNode(WhileStmtNode *whileStmt) override;
+    void visitReturnStmtNode(ReturnStmtNode *ret) override;
+    void visitUnaryExprNode(UnaryExprNode *unary) override;
+    void visitBinaryExprNode(BinaryExprNode *bin) override;
+    void visitBoolExprNode(BoolExprNode *boolExpr) override;
+    void visitIntExprNode(IntExprNode *intExpr) override;
+    void visitBoolConstantNode(BoolConstantNode *boolConst) override;
+    void visitIntConstantNode(IntConstantNode *intConst) override;
+    void visitArgumentNode(ArgumentNode *arg) override;
+    void visitCallExprNode(CallExprNode *call) override;
+    void visitReferenceExprNode(ReferenceExprNode *ref) override;
+};
+
+} // namespace smallc
+
+#endif /* ASTJSONPrinter_h */
@@ -11,20 +11,30 @@
 //  this code, either publicly or to third parties.
 
 #include "ASTNodes.h"
+#include "LazyParser.h"
+#include "LineTable.h"
 
 #include <iostream>
+#include <cstdlib>
 
 using namespace smallc;
 
+// The 4-byte member that these put first shares 8 bytes with ASTNode's
+// offset; on 64-bit hosts that keeps the most common nodes at these sizes
+static_assert(sizeof(void*) != 8 || sizeof(PrimitiveTypeNode) == 56, "PrimitiveTypeNode grew");
+static_assert(sizeof(void*) != 8 || sizeof(ArrayTypeNode) == 64, "ArrayTypeNode grew");
+static_assert(sizeof(void*) != 8 || sizeof(UnaryExprNode) == 72, "UnaryExprNode grew");
+static_assert(sizeof(void*) != 8 || sizeof(BinaryExprNode) == 80, "BinaryExprNode grew");
+static_assert(sizeof(void*) != 8 || sizeof(IfStmtNode) == 80, "IfStmtNode grew");
+
 /**********************************************************************************/
 /* The ASTNode Class                                                              */
 /**********************************************************************************/
 ASTNode::ASTNode()
 {
     parent = nullptr;
-    location.first = 0;
-    location.second = 0;
     root = nullptr;
+    offset = LineTable::NoOffset;
 }
 
 ASTNode::~ASTNode()
@@ -40,11 +50,19 @@ ASTNode *ASTNode::getChild(unsigned int i) { return children[i]; }
 
 unsigned int ASTNode::getNumChildren() { return (unsigned int)children.size(); }
 
-unsigned int ASTNode::getLine() { return location.first; }
+unsigned int ASTNode::getLine() { return getLocation().first; }
+
+unsigned int ASTNode::getCol() { return getLocation().second; }
 
-unsigned int ASTNode::getCol() { return location.second; }
+std::pair<unsigned int, unsigned int>ASTNode::getLocation()
+{
+    LineTable *table = LineTable::getCurrent();
+    if (!table)
+        return std::make_pair(0u, 0u);
+    return table->getLocation(offset);
+}
 
-std::pair<unsigned int, unsigned int>ASTNode::getLocation() { return location; }
+uint32_t ASTNode::getOffset() { return offset; }
 
 ProgramNode *ASTNode::getRoot() { return root; }
 
@@ -60,17 +78,19 @@ void ASTNode::setParent(ASTNode *p) { parent = p; }
 
 void ASTNode::setRoot(ProgramNode *r) { root = r; }
 
-void ASTNode::setLine(unsigned int line) { location.first = line; }
+void ASTNode::setLine(unsigned int line) { setLocation(line, getCol()); }
 
-void ASTNode::setColumn(unsigned int column) { location.second = column; }
+void ASTNode::setColumn(unsigned int column) { setLocation(getLine(), column); }
 
 void ASTNode::setLocation(unsigned int line, unsigned int column)
 {
-    location.first = line;
-    location.second = column;
+    LineTable *table = LineTable::getCurrent();
+    offset = table ? table->getOffset(line, column) : LineTable::NoOffset;
 }
 
-void ASTNode::setLocation(std::pair<unsigned int, unsigned int> loc) { location = loc; }
+void ASTNode::setLocation(std::pair<unsigned int, unsigned int> loc) { setLocation(loc.first, loc.second); }
+
+void ASTNode::setOffset(uint32_t offset_) { offset = offset_; }
 
 bool ASTNode::hasVarTable()
 {
@@ -252,7 +272,7 @@ void ParameterNode::visit(ASTVisitorBase *visitor) {
 /* The Expression Class                                                           */
 /**********************************************************************************/
 
-ExprNode::ExprNode() : ASTNode() {}
+ExprNode::ExprNode() : ASTNode(), opcode(Unset), type(nullptr) {}
 void ExprNode::setType(PrimitiveTypeNode* type_) {
     type = type_;
 }
@@ -409,10 +429,17 @@ void IntExprNode::visit(ASTVisitorBase *visitor){
 
 ConstantExprNode::ConstantExprNode(const std::string &source_){
     source = source_;
+    val = 0;
 }
 void ConstantExprNode::setSource(const std::string &source_) {
     source = source_;
 }
+const std::string& ConstantExprNode::getSource() {
+    return source;
+}
+void ConstantExprNode::setVal(int val_) {
+    val = val_;
+}
 int ConstantExprNode::getVal(){
     return val;
 }
@@ -423,7 +450,9 @@ void ConstantExprNode::visit(ASTVisitorBase *visitor){
 /* The Boolean Constant Class                                                     */
 /**********************************************************************************/
 
-BoolConstantNode::BoolConstantNode(const std::string &source) : ConstantExprNode(source) {}
+BoolConstantNode::BoolConstantNode(const std::string &source) : ConstantExprNode(source) {
+    setVal(source == "true" ? 1 : 0);
+}
 void BoolConstantNode::visit(ASTVisitorBase *visitor){
     visitor->visitBoolConstantNode(this);
 }
@@ -432,7 +461,10 @@ void BoolConstantNode::visit(ASTVisitorBase *visitor){
 /* The Integer Constant Class                                                     */
 /**********************************************************************************/
 
-IntConstantNode::IntConstantNode(const std::string &source) : ConstantExprNode(source) {}
+IntConstantNode::IntConstantNode(const std::string &source) : ConstantExprNode(source) {
+    // The source text is "[-]digits"; values wrap to 32 bits like the target
+    setVal((int)std::strtoll(source.c_str(), nullptr, 10));
+}
 void IntConstantNode::visit(ASTVisitorBase *visitor){
     visitor->visitIntConstantNode(this);
 }
@@ -493,9 +525,10 @@ void CallExprNode::visit(ASTVisitorBase *visitor){
 /* The Reference Expression Class                                                 */
 /**********************************************************************************/
 
-ReferenceExprNode::ReferenceExprNode() : ExprNode() {}
+ReferenceExprNode::ReferenceExprNode() : ExprNode(), name(nullptr), index(nullptr) {}
 ReferenceExprNode::ReferenceExprNode(IdentifierNode *name_){
     name = name_;
+    index = nullptr;
 }
 ReferenceExprNode::ReferenceExprNode(IdentifierNode *name_, IntExprNode *exp){
     name = name_;
@@ -521,8 +554,8 @@ void ReferenceExprNode::visit(ASTVisitorBase *visitor){
 /* The Declaration Class                                                          */
 /**********************************************************************************/
 
-DeclNode::DeclNode() : ASTNode() {}
-DeclNode::DeclNode(TypeNode* type_, IdentifierNode* name_) {
+DeclNode::DeclNode() : ASTNode(), type(nullptr), name(nullptr), hash(0) {}
+DeclNode::DeclNode(TypeNode* type_, IdentifierNode* name_) : ASTNode(), hash(0) {
     type = type_;
     name = name_;
 }
@@ -532,12 +565,18 @@ void DeclNode::setName(IdentifierNode* name_) {
 void DeclNode::setType(TypeNode* type_) {
     type = type_;
 }
+void DeclNode::setHash(HashValue hash_) {
+    hash = hash_;
+}
 IdentifierNode* DeclNode::getIdent() {
     return name;
 }
 TypeNode* DeclNode::getType() {
     return type;
 }
+HashValue DeclNode::getHash() {
+    return hash;
+}
 bool DeclNode::isGlobal(){
     return false;
 }
@@ -604,12 +643,22 @@ void ScopeNode::visit(ASTVisitorBase *visitor){
 /* The Function Declaration Class                                                 */
 /**********************************************************************************/
 
-FunctionDeclNode::FunctionDeclNode() : DeclNode() {}
+FunctionDeclNode::FunctionDeclNode() : DeclNode(), isProto(false), body(nullptr), lazyParser(nullptr) {}
 void FunctionDeclNode::setProto(bool val){
     isProto = val;
 }
 void FunctionDeclNode::setBody(ScopeNode* val){
     body = val;
+    lazyParser = nullptr;
+}
+void FunctionDeclNode::setLazyBody(LazyParser* parser, size_t start, size_t stop){
+    body = nullptr;
+    lazyParser = parser;
+    bodyStart = start;
+    bodyStop = stop;
+}
+bool FunctionDeclNode::isBodyParsed(){
+    return lazyParser == nullptr;
 }
 void FunctionDeclNode::setRetType(PrimitiveTypeNode* type){
     DeclNode::setType(type);
@@ -624,6 +673,8 @@ bool FunctionDeclNode::getProto(){
     return isProto;
 }
 ScopeNode* FunctionDeclNode::getBody(){
+    if (lazyParser)
+        setBody(lazyParser->parseBody(bodyStart, bodyStop));
     return body;
 }
 PrimitiveTypeNode* FunctionDeclNode::getRetType(){
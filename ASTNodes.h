@@ -16,21 +16,26 @@
 #include <iostream>
 using namespace std;
 
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <sstream>
 
 #include "ASTVisitorBase.h"
+#include "Hash.h"
+#include "MemStats.h"
 #include "SymTable.h"
 
 namespace smallc {
 
 class ProgramNode;
+class LazyParser;
 
 /**********************************************************************************/
 /* The ASTNode Class   (abstract)                                                 */
 /**********************************************************************************/
 class ASTNode {
+    SMALLC_COUNT_NEW(ASTNode)
 private:
     // Vector of this node's children
     vector<ASTNode*> children;
@@ -38,11 +43,14 @@ private:
     // Pointer to this node's parents
     ASTNode* parent;
     
-    std::pair<unsigned int, unsigned int> location;
-    
     // Pointer to the program this node belongs to
     ProgramNode* root;
     
+    // Offset of the node in the source; its line and column come from
+    // the current LineTable. Last, so the 4-byte member that subclasses
+    // put first (a type, size, opcode or flag) shares its 8 bytes.
+    uint32_t offset;
+    
 protected:
     ASTNode(); // Constructor
     
@@ -55,6 +63,7 @@ public:
     unsigned int getLine();   // Get line number of node in source
     unsigned int getCol();    // Get column number of node in line
     std::pair<unsigned int, unsigned int> getLocation(); // Get location
+    uint32_t getOffset();     // Get offset of node in source
     ProgramNode* getRoot(); // Get the root program
     virtual bool hasVarTable(); // Does the node have a variable symbol table?
     FunctionDeclNode* getFunction (); // Get the function associated with the node, or nullptr
@@ -67,6 +76,7 @@ public:
     void setColumn(unsigned int column); // Set the column number of node in line
     void setLocation(unsigned int line, unsigned int column); // set location <line,column>
     void setLocation(std::pair<unsigned int, unsigned int> loc); // set location <line,column>
+    void setOffset(uint32_t offset_); // Set the offset of the node in source
 
     // Visit the node using the visitor object
     // NOTE: this is an abstract class!
@@ -77,6 +87,7 @@ public:
 /* The ProgramNode Class                                                          */
 /**********************************************************************************/
 class ProgramNode : public ASTNode {
+    SMALLC_COUNT_NEW(ProgramNode)
 private:
     bool iolib;                    // Is the I/O lib used?
     SymTable<FunctionEntry>* fenv; // Pointer to function symbol table
@@ -97,6 +108,7 @@ public:
 /* The TypeNode Class   (abstract)                                                */
 /**********************************************************************************/
 class TypeNode: public ASTNode{
+    SMALLC_COUNT_NEW(TypeNode)
 public:
     enum TypeEnum {Void = 0, Int, Bool};  // The types
     virtual void setType(TypeEnum);       // Set the type
@@ -109,6 +121,7 @@ public:
 /* The PrimitiveTypeNode Class                                                    */
 /**********************************************************************************/
 class PrimitiveTypeNode : public TypeNode {
+    SMALLC_COUNT_NEW(PrimitiveTypeNode)
 private:
     TypeEnum type;
     
@@ -126,9 +139,10 @@ public:
 /* The ArrayTypeNode Class                                                        */
 /**********************************************************************************/
 class ArrayTypeNode : public TypeNode {
+    SMALLC_COUNT_NEW(ArrayTypeNode)
 private:
-    PrimitiveTypeNode* type; // The element type
     int size;   // The size of the array, leaving as signed to check for size in Sema
+    PrimitiveTypeNode* type; // The element type
     
 public:
     ArrayTypeNode();
@@ -148,6 +162,7 @@ public:
 /* The IdentifierNode Class                                                       */
 /**********************************************************************************/
 class IdentifierNode : public ASTNode {
+    SMALLC_COUNT_NEW(IdentifierNode)
 private:
     std::string name;
     
@@ -162,6 +177,7 @@ public:
 /* The ParameterNode Class                                                        */
 /**********************************************************************************/
 class ParameterNode : public ASTNode {
+    SMALLC_COUNT_NEW(ParameterNode)
 private:
     TypeNode *type;            // Type of identifier
     IdentifierNode *name;      // Name of Identifier
@@ -180,12 +196,7 @@ public:
 /* The Expression Class      (abstract)                                           */
 /**********************************************************************************/
 class ExprNode : public ASTNode {
-private:
-    PrimitiveTypeNode *type;
-    
-protected:
-    ExprNode();
-    
+    SMALLC_COUNT_NEW(ExprNode)
 public:
     enum Opcode {
         Addition = 0,
@@ -205,6 +216,18 @@ public:
         Unset = -1
     };
     
+protected:
+    // The operator of unary and binary expressions. First, so it fills the
+    // padding after ASTNode's offset rather than growing those nodes.
+    Opcode opcode;
+    
+private:
+    PrimitiveTypeNode *type;
+    
+protected:
+    ExprNode();
+    
+public:
     void setType(PrimitiveTypeNode* type_);
     void setTypeInt();
     void setTypeBool();
@@ -252,9 +275,9 @@ public:
 /* The Unary Expression Class                                                     */
 /**********************************************************************************/
 class UnaryExprNode : public ExprNode {
+    SMALLC_COUNT_NEW(UnaryExprNode)
 private:
     ExprNode *operand;
-    Opcode opcode;
     
 public:
     UnaryExprNode();
@@ -272,10 +295,10 @@ public:
 /* The Binary Expression Class                                                    */
 /**********************************************************************************/
 class BinaryExprNode : public ExprNode {
+    SMALLC_COUNT_NEW(BinaryExprNode)
 private:
     ExprNode* left;
     ExprNode* right;
-    Opcode opcode;
     
 public:
     BinaryExprNode();
@@ -295,6 +318,7 @@ public:
 /* The Boolean Expression Class                                                   */
 /**********************************************************************************/
 class BoolExprNode : public ExprNode {
+    SMALLC_COUNT_NEW(BoolExprNode)
 private:
     ExprNode* value;
     
@@ -311,6 +335,7 @@ public:
 /* The Integer Expression Class                                                   */
 /**********************************************************************************/
 class IntExprNode : public ExprNode {
+    SMALLC_COUNT_NEW(IntExprNode)
 private:
     ExprNode* value;
     
@@ -327,13 +352,18 @@ public:
 /* The Constant Expression Class (abstract)                                       */
 /**********************************************************************************/
 class ConstantExprNode : public ExprNode {
+    SMALLC_COUNT_NEW(ConstantExprNode)
 private:
     std::string source;
     int val;
     
+protected:
+    void setVal(int val_);
+    
 public:
     explicit ConstantExprNode(const std::string &source_);
     void setSource(const std::string &source_);
+    const std::string& getSource();
     int getVal();
     void visit(ASTVisitorBase* visitor) override = 0;
 };
@@ -342,6 +372,7 @@ public:
 /* The Boolean Constant Class                                                     */
 /**********************************************************************************/
 class BoolConstantNode : public ConstantExprNode {
+    SMALLC_COUNT_NEW(BoolConstantNode)
 public:
     explicit BoolConstantNode(const std::string &source);
     void visit(ASTVisitorBase* visitor) override;
@@ -351,6 +382,7 @@ public:
 /* The Integer Constant Class                                                     */
 /**********************************************************************************/
 class IntConstantNode : public ConstantExprNode {
+    SMALLC_COUNT_NEW(IntConstantNode)
 public:
     explicit IntConstantNode(const std::string &source);
     void visit(ASTVisitorBase* visitor) override;
@@ -360,6 +392,7 @@ public:
 /* The Function Argument Class                                                    */
 /**********************************************************************************/
 class ArgumentNode : public ASTNode {
+    SMALLC_COUNT_NEW(ArgumentNode)
 private:
     ExprNode* expr;
     
@@ -376,6 +409,7 @@ public:
 /* The Call Expression Class                                                      */
 /**********************************************************************************/
 class CallExprNode : public ExprNode {
+    SMALLC_COUNT_NEW(CallExprNode)
 private:
     IdentifierNode *name;
     std::vector<ArgumentNode*> args;
@@ -398,6 +432,7 @@ public:
 /* The Reference Expression Class                                                 */
 /**********************************************************************************/
 class ReferenceExprNode : public ExprNode {
+    SMALLC_COUNT_NEW(ReferenceExprNode)
 private:
     IdentifierNode *name;
     IntExprNode* index;
@@ -417,17 +452,21 @@ public:
 /* The Declaration Class (abstract)                                               */
 /**********************************************************************************/
 class DeclNode : public ASTNode {
+    SMALLC_COUNT_NEW(DeclNode)
 private:
     TypeNode* type;
     IdentifierNode *name;
+    HashValue hash;     // Structural hash, set by ASTHasher on global declarations
     
 public:
     DeclNode();
     DeclNode(TypeNode* type_, IdentifierNode* name_);
     void setName(IdentifierNode* name_);
     void setType(TypeNode* type_);
+    void setHash(HashValue hash_);
     IdentifierNode* getIdent();
     virtual TypeNode* getType();
+    HashValue getHash();
     bool isGlobal();
     void visit(ASTVisitorBase* visitor) override = 0;
 };
@@ -436,6 +475,7 @@ public:
 /* The Scalar Declaration Class                                                   */
 /**********************************************************************************/
 class ScalarDeclNode : public DeclNode {
+    SMALLC_COUNT_NEW(ScalarDeclNode)
 public:
     ScalarDeclNode();
     ScalarDeclNode(PrimitiveTypeNode*& type_, IdentifierNode*& name_);
@@ -447,6 +487,7 @@ public:
 /* The Array Declaration Class                                                    */
 /**********************************************************************************/
 class ArrayDeclNode : public DeclNode {
+    SMALLC_COUNT_NEW(ArrayDeclNode)
 public:
     ArrayDeclNode();
     ArrayDeclNode(ArrayTypeNode* type_, IdentifierNode* name_);
@@ -458,6 +499,7 @@ public:
 /* The Stmt Class (abstract)                                                      */
 /**********************************************************************************/
 class StmtNode : public ASTNode {
+    SMALLC_COUNT_NEW(StmtNode)
 protected:
     StmtNode();
     
@@ -470,6 +512,7 @@ public:
 /* The Scope Class                                                                */
 /**********************************************************************************/
 class ScopeNode : public StmtNode {
+    SMALLC_COUNT_NEW(ScopeNode)
 private:
     std::vector<DeclNode*> decls;
     SymTable<VariableEntry>* env;
@@ -488,15 +531,21 @@ public:
 /* The Function Declaration Class                                                 */
 /**********************************************************************************/
 class FunctionDeclNode : public DeclNode {
+    SMALLC_COUNT_NEW(FunctionDeclNode)
 private:
     bool isProto;
     ScopeNode* body;
     std::vector<ParameterNode* > params;
+    LazyParser* lazyParser;    // Parses the body when it is first asked for,
+    size_t bodyStart;          // from the tokens of its braces
+    size_t bodyStop;
     
 public:
     FunctionDeclNode();
     void setProto(bool val);
     void setBody(ScopeNode* val);
+    void setLazyBody(LazyParser* parser, size_t start, size_t stop); // Body not parsed yet
+    bool isBodyParsed();
     void setRetType(PrimitiveTypeNode* type);
     void setParameter(std::vector<ParameterNode* > parameters);
     void addParameter(ParameterNode* param);
@@ -513,6 +562,7 @@ public:
 /* The Expression Statement Class                                                 */
 /**********************************************************************************/
 class ExprStmtNode : public StmtNode {
+    SMALLC_COUNT_NEW(ExprStmtNode)
 private:
     ExprNode* expr;
     
@@ -528,6 +578,7 @@ public:
 /* The Assignment Statement Class                                                 */
 /**********************************************************************************/
 class AssignStmtNode : public StmtNode {
+    SMALLC_COUNT_NEW(AssignStmtNode)
 private:
     ReferenceExprNode *target;
     ExprNode* val;
@@ -546,8 +597,9 @@ public:
 /* The If Statement Class                                                         */
 /**********************************************************************************/
 class IfStmtNode : public StmtNode {
-    ExprNode *condition;
+    SMALLC_COUNT_NEW(IfStmtNode)
     bool hasElse;
+    ExprNode *condition;
     StmtNode *Then;
     StmtNode *Else;
 public:
@@ -569,6 +621,7 @@ public:
 /* The While Statement Class                                                      */
 /**********************************************************************************/
 class WhileStmtNode : public StmtNode {
+    SMALLC_COUNT_NEW(WhileStmtNode)
     ExprNode *condition;
     StmtNode *body;
 public:
@@ -585,6 +638,7 @@ public:
 /* The Return Statement Class                                                     */
 /**********************************************************************************/
 class ReturnStmtNode : public StmtNode {
+    SMALLC_COUNT_NEW(ReturnStmtNode)
     ExprNode* ret;
 public:
     ReturnStmtNode();
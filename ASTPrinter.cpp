@@ -11,13 +11,27 @@
 //  this code, either publicly or to third parties.
 
 
+#include <charconv>
+
 #include "ASTPrinter.h"
 
 namespace smallc {
 
-ASTPrinter::ASTPrinter():indent(0), root(nullptr) { }
+ASTPrinter::ASTPrinter():indent(0), root(nullptr), out(&std::cout), buffer(), tabs() { buffer.reserve(BufferSize); }
+
+ASTPrinter::ASTPrinter(ProgramNode* prg):indent(0), root(prg), out(&std::cout), buffer(), tabs() { buffer.reserve(BufferSize); }
 
-ASTPrinter::ASTPrinter(ProgramNode* prg):indent(0), root(prg) { }
+ASTPrinter::~ASTPrinter() { flush(); }
+
+void
+ASTPrinter::setOutput(std::ostream* out_) { flush(); out = out_; }
+
+void
+ASTPrinter::flush() {
+    out->write(buffer.data(), buffer.size());
+    out->flush();
+    buffer.clear();
+}
 
 void
 ASTPrinter::incrIndent() { indent++; }
@@ -25,13 +39,39 @@ ASTPrinter::incrIndent() { indent++; }
 void
 ASTPrinter::decrIndent() { indent--; }
 
-std::string
-ASTPrinter::genPrefix() { return std::string(indent, '\t'); }
+// Called as each node starts, so the buffer is written out in chunks
+// of about BufferSize bytes
+void
+ASTPrinter::flushIfFull() {
+    if (buffer.size() >= BufferSize) {
+        out->write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
 
-std::string
-ASTPrinter::genLocation(ASTNode *node) {
-    return "(" + std::to_string(node->getLine()) + "," +
-    std::to_string(node->getCol()) + ")\n";
+void
+ASTPrinter::appendPrefix() {
+    flushIfFull();
+    if (tabs.size() < indent)
+        tabs.resize(indent, '\t');
+    buffer.append(tabs, 0, indent);
+}
+
+void
+ASTPrinter::appendLocation(ASTNode *node) {
+    std::pair<unsigned int, unsigned int> location = node->getLocation();
+    buffer += '(';
+    appendNumber(location.first);
+    buffer += ',';
+    appendNumber(location.second);
+    buffer += ")\n";
+}
+
+void
+ASTPrinter::appendNumber(long long value) {
+    char digits[24];
+    char *end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    buffer.append(digits, end - digits);
 }
 
 void 
@@ -42,17 +82,18 @@ ASTPrinter::visitASTNode(ASTNode *node) {
 }
 
 void ASTPrinter::visitProgramNode(ProgramNode *prg) {
-    std::string res = genPrefix();
-    res += "Program [useIO=" + std::to_string(prg->useIo()) + "]";
-    res += genLocation(prg);
-    std::cout << res;
+    appendPrefix();
+    buffer += "Program [useIO=";
+    appendNumber(prg->useIo());
+    buffer += "]";
+    appendLocation(prg);
     ASTVisitorBase::visitProgramNode(prg);
+    flush();
 }
 
 void ASTPrinter::visitScalarDeclNode(ScalarDeclNode *scalar) {
-    std::string res = genPrefix();
-    res += "Scalar Declaration";
-    std::cout << res;
+    appendPrefix();
+    buffer += "Scalar Declaration";
     scalar->getType()->visit(this);
     incrIndent();
     scalar->getIdent()->visit(this);
@@ -61,22 +102,22 @@ void ASTPrinter::visitScalarDeclNode(ScalarDeclNode *scalar) {
 }
 
 void ASTPrinter::visitPrimitiveTypeNode(PrimitiveTypeNode *type) {
-    std::string res = genPrefix();
+    appendPrefix();
     if (type->getTypeEnum() == smallc::TypeNode::Int)
-        res += "Int";
+        buffer += "Int";
     else if (type->getTypeEnum() == smallc::TypeNode::Bool)
-        res += "Bool";
+        buffer += "Bool";
     else
-        res += "Void";
-    res += genLocation(type);
-    std::cout << res;
+        buffer += "Void";
+    appendLocation(type);
     ASTVisitorBase::visitPrimitiveTypeNode(type);
 }
 
 void ASTPrinter::visitFunctionDeclNode(FunctionDeclNode *func) {
-    std::string res = genPrefix();
-    res += "Function[isProto=" + std::to_string(func->getProto()) + "]";
-    std::cout << res;
+    appendPrefix();
+    buffer += "Function[isProto=";
+    appendNumber(func->getProto());
+    buffer += "]";
     func->getRetType()->visit(this);
     incrIndent();
     func->getIdent()->visit(this);
@@ -89,17 +130,17 @@ void ASTPrinter::visitFunctionDeclNode(FunctionDeclNode *func) {
 }
 
 void ASTPrinter::visitIdentifierNode(IdentifierNode *id) {
-    std::string res = genPrefix();
-    res += "Identifier[name:" + id->getName() + "]";
-    res += genLocation(id);
-    std::cout << res;
+    appendPrefix();
+    buffer += "Identifier[name:";
+    buffer += id->getName();
+    buffer += "]";
+    appendLocation(id);
     ASTVisitorBase::visitIdentifierNode(id);
 }
 
 void ASTPrinter::visitParameterNode(ParameterNode *param) {
-    std::string res = genPrefix();
-    res += "Parameter";
-    std::cout << res;
+    appendPrefix();
+    buffer += "Parameter";
     param->getType()->visit(this);
     incrIndent();
     param->getIdent()->visit(this);
@@ -109,28 +150,29 @@ void ASTPrinter::visitParameterNode(ParameterNode *param) {
 
 void
 ASTPrinter::visitArrayTypeNode(ArrayTypeNode *type) {
-    std::string res = genPrefix();
+    appendPrefix();
     if (type->getTypeEnum() == smallc::TypeNode::Int)
-        res += "Int";
+        buffer += "Int";
     else if (type->getTypeEnum() == smallc::TypeNode::Bool)
-        res += "Bool";
+        buffer += "Bool";
     else
-        res += "Void";
+        buffer += "Void";
     if (type->getSize() == 0)
-        res += "*";
-    else
-        res += "[" + std::to_string(type->getSize()) + "]";
-    res += genLocation(type);
-    std::cout << res;
+        buffer += "*";
+    else {
+        buffer += "[";
+        appendNumber(type->getSize());
+        buffer += "]";
+    }
+    appendLocation(type);
     ASTVisitorBase::visitArrayTypeNode(type);
 }
 
 void
 ASTPrinter::visitScopeNode(ScopeNode *scope) {
-    std::string res = genPrefix();
-    res += "Scope";
-    res += genLocation(scope);
-    std::cout << res;
+    appendPrefix();
+    buffer += "Scope";
+    appendLocation(scope);
     incrIndent();
     for (auto i: scope->getDeclarations())
         i->visit(this);
@@ -140,9 +182,8 @@ ASTPrinter::visitScopeNode(ScopeNode *scope) {
 
 void 
 ASTPrinter::visitArrayDeclNode(ArrayDeclNode *array) {
-    std::string res = genPrefix();
-    res += "Array Declaration";
-    std::cout << res;
+    appendPrefix();
+    buffer += "Array Declaration";
     array->getType()->visit(this);
     incrIndent();
     array->getIdent()->visit(this);
@@ -152,10 +193,11 @@ ASTPrinter::visitArrayDeclNode(ArrayDeclNode *array) {
 
 void 
 ASTPrinter::visitIfStmtNode(IfStmtNode *ifStmt) {
-    std::string res = genPrefix();
-    res += "IfStmt[hasElse=" + std::to_string(ifStmt->getHasElse()) + "]";
-    res += genLocation(ifStmt);
-    std::cout << res;
+    appendPrefix();
+    buffer += "IfStmt[hasElse=";
+    appendNumber(ifStmt->getHasElse());
+    buffer += "]";
+    appendLocation(ifStmt);
     incrIndent();
     ifStmt->getCondition()->visit(this);
     ifStmt->getThen()->visit(this);
@@ -166,10 +208,9 @@ ASTPrinter::visitIfStmtNode(IfStmtNode *ifStmt) {
 }
 
 void ASTPrinter::visitBoolExprNode(BoolExprNode *boolExpr) {
-    std::string res = genPrefix();
-    res += "Bool Expression";
-    res += genLocation(boolExpr);
-    std::cout << res;
+    appendPrefix();
+    buffer += "Bool Expression";
+    appendLocation(boolExpr);
     incrIndent();
     boolExpr->getValue()->visit(this);
     decrIndent();
@@ -177,10 +218,11 @@ void ASTPrinter::visitBoolExprNode(BoolExprNode *boolExpr) {
 }
 
 void ASTPrinter::visitBinaryExprNode(BinaryExprNode *bin) {
-    std::string res = genPrefix();
-    res += "Binary Expression[opcode:" + ExprNode::codeToStr(bin->getOpcode()) + "]";
-    res += genLocation(bin);
-    std::cout << res;
+    appendPrefix();
+    buffer += "Binary Expression[opcode:";
+    buffer += ExprNode::codeToStr(bin->getOpcode());
+    buffer += "]";
+    appendLocation(bin);
     incrIndent();
     bin->getLeft()->visit(this);
     bin->getRight()->visit(this);
@@ -189,10 +231,9 @@ void ASTPrinter::visitBinaryExprNode(BinaryExprNode *bin) {
 }
 
 void ASTPrinter::visitIntExprNode(IntExprNode *intExpr) {
-    std::string res = genPrefix();
-    res += "Int Expression";
-    res += genLocation(intExpr);
-    std::cout << res;
+    appendPrefix();
+    buffer += "Int Expression";
+    appendLocation(intExpr);
     incrIndent();
     intExpr->getValue()->visit(this);
     decrIndent();
@@ -200,10 +241,9 @@ void ASTPrinter::visitIntExprNode(IntExprNode *intExpr) {
 }
 
 void ASTPrinter::visitReferenceExprNode(ReferenceExprNode *ref) {
-    std::string res = genPrefix();
-    res += "Reference";
-    res += genLocation(ref);
-    std::cout << res;
+    appendPrefix();
+    buffer += "Reference";
+    appendLocation(ref);
     incrIndent();
     ref->getIdent()->visit(this);
     if (ref->getIndex())
@@ -213,10 +253,9 @@ void ASTPrinter::visitReferenceExprNode(ReferenceExprNode *ref) {
 }
 
 void ASTPrinter::visitAssignStmtNode(AssignStmtNode *assign) {
-    std::string res = genPrefix();
-    res += "Assignment";
-    res += genLocation(assign);
-    std::cout << res;
+    appendPrefix();
+    buffer += "Assignment";
+    appendLocation(assign);
     incrIndent();
     assign->getTarget()->visit(this);
     assign->getValue()->visit(this);
@@ -225,10 +264,9 @@ void ASTPrinter::visitAssignStmtNode(AssignStmtNode *assign) {
 }
 
 void ASTPrinter::visitExprStmtNode(ExprStmtNode *expr) {
-    std::string res = genPrefix();
-    res += "Expression Statement";
-    res += genLocation(expr);
-    std::cout << res;
+    appendPrefix();
+    buffer += "Expression Statement";
+    appendLocation(expr);
     incrIndent();
     expr->getExpr()->visit(this);
     decrIndent();
@@ -236,10 +274,9 @@ void ASTPrinter::visitExprStmtNode(ExprStmtNode *expr) {
 }
 
 void ASTPrinter::visitWhileStmtNode(WhileStmtNode *whileStmt) {
-    std::string res = genPrefix();
-    res += "WhileStmt";
-    res += genLocation(whileStmt);
-    std::cout << res;
+    appendPrefix();
+    buffer += "WhileStmt";
+    appendLocation(whileStmt);
     incrIndent();
     whileStmt->getCondition()->visit(this);
     whileStmt->getBody()->visit(this);
@@ -248,26 +285,27 @@ void ASTPrinter::visitWhileStmtNode(WhileStmtNode *whileStmt) {
 }
 
 void ASTPrinter::visitIntConstantNode(IntConstantNode *intConst) {
-    std::string res = genPrefix();
-    res += "IntConstant[val=" + std::to_string(intConst->getVal()) + "]";
-    res += genLocation(intConst);
-    std::cout << res;
+    appendPrefix();
+    buffer += "IntConstant[val=";
+    appendNumber(intConst->getVal());
+    buffer += "]";
+    appendLocation(intConst);
     ASTVisitorBase::visitIntConstantNode(intConst);
 }
 
 void ASTPrinter::visitBoolConstantNode(BoolConstantNode *boolConst) {
-    std::string res = genPrefix();
-    res += "BoolConstant[val=" + std::to_string(boolConst->getVal()) + "]";
-    res += genLocation(boolConst);
-    std::cout << res;
+    appendPrefix();
+    buffer += "BoolConstant[val=";
+    appendNumber(boolConst->getVal());
+    buffer += "]";
+    appendLocation(boolConst);
     ASTVisitorBase::visitBoolConstantNode(boolConst);
 }
 
 void ASTPrinter::visitArgumentNode(ArgumentNode *arg) {
-    std::string res = genPrefix();
-    res += "Argument";
-    res += genLocation(arg);
-    std::cout << res;
+    appendPrefix();
+    buffer += "Argument";
+    appendLocation(arg);
     incrIndent();
     arg->getExpr()->visit(this);
     decrIndent();
@@ -275,10 +313,9 @@ void ASTPrinter::visitArgumentNode(ArgumentNode *arg) {
 }
 
 void ASTPrinter::visitCallExprNode(CallExprNode *call) {
-    std::string res = genPrefix();
-    res += "CallExpr";
-    res += genLocation(call);
-    std::cout << res;
+    appendPrefix();
+    buffer += "CallExpr";
+    appendLocation(call);
     incrIndent();
     call->getIdent()->visit(this);
     for (auto i: call->getArguments())
@@ -288,10 +325,11 @@ void ASTPrinter::visitCallExprNode(CallExprNode *call) {
 }
 
 void ASTPrinter::visitUnaryExprNode(UnaryExprNode *unary) {
-    std::string res = genPrefix();
-    res += "UnaryExpr[opcode:" + ExprNode::codeToStr(unary->getOpcode()) + "]";
-    res += genLocation(unary);
-    std::cout << res;
+    appendPrefix();
+    buffer += "UnaryExpr[opcode:";
+    buffer += ExprNode::codeToStr(unary->getOpcode());
+    buffer += "]";
+    appendLocation(unary);
     incrIndent();
     unary->getOperand()->visit(this);
     decrIndent();
@@ -299,10 +337,9 @@ void ASTPrinter::visitUnaryExprNode(UnaryExprNode *unary) {
 }
 
 void ASTPrinter::visitReturnStmtNode(ReturnStmtNode *ret) {
-    std::string res = genPrefix();
-    res += "ReturnStmt";
-    res += genLocation(ret);
-    std::cout << res;
+    appendPrefix();
+    buffer += "ReturnStmt";
+    appendLocation(ret);
     incrIndent();
     if (!ret->returnVoid())
         ret->getReturn()->visit(this);
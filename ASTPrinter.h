@@ -24,15 +24,30 @@ class ASTPrinter: public ASTVisitorBase{
 private:
     unsigned int indent;    // indentation of printing
     ProgramNode* root;      // Pointer to ProgramNode
+
+protected:
+    // Nodes are formatted into the buffer, which goes to the output in
+    // large chunks instead of one small write per node
+    static const size_t BufferSize = 1 << 16;
+    std::ostream* out;      // Where the AST goes, std::cout by default
+    std::string buffer;     // Formatted but not written yet
+    std::string tabs;       // Prefix of the deepest indent so far
+
+    void flushIfFull();                     // Write the buffer out once it is full
+    void appendPrefix();                    // Append the prefix
+    void appendLocation(ASTNode* node);     // Append the location and end the line
+    void appendNumber(long long value);     // Append a number in decimal
     
 public:
     ASTPrinter();         // Constructor
     explicit ASTPrinter(ProgramNode* prg); // Constructor with ProgramNode
+    ~ASTPrinter();        // Destructor, writes what is left in the buffer
+
+    void setOutput(std::ostream* out_); // Set where to print
+    void flush();          // Write the buffer to the output
 
     void incrIndent();     // Increase indent
     void decrIndent();     // Decrease indent
-    std::string genPrefix(); // Get the prefix
-    std::string genLocation(ASTNode* node); // Generate string with location
 
     // Visitors
     void visitASTNode(ASTNode* node) override;
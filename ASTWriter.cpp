@@ -0,0 +1,252 @@
+//
+//  ASTWriter.cpp
+//  ECE467 Lab 3
+//
+//  Writing a checked program in the binary AST format.
+//
+
+#include <fstream>
+
+#include "ASTWriter.h"
+
+namespace smallc {
+
+ASTWriter::ASTWriter() : nodes(), children(), strings(), stringOffsets(), io(false), last(0) {}
+
+bool ASTWriter::write(ProgramNode* prg, const std::string &path) {
+    nodes.clear();
+    children.clear();
+    strings.clear();
+    stringOffsets.clear();
+    emit(prg);
+
+    ASTFile::Header header;
+    header.magic = ASTFile::Magic;
+    header.version = ASTFile::Version;
+    header.reserved = 0;
+    header.numNodes = nodes.size();
+    header.numChildren = children.size();
+    header.stringBytes = strings.size();
+    header.root = last;
+
+    std::ofstream out(path, std::ios::binary);
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)nodes.data(), nodes.size() * sizeof(ASTFile::Node));
+    out.write((const char*)children.data(), children.size() * sizeof(uint32_t));
+    out.write(strings.data(), strings.size());
+    out.close();
+    return !out.fail();
+}
+
+uint32_t ASTWriter::emit(ASTNode* node) {
+    node->visit(this);
+    return last;
+}
+
+uint32_t ASTWriter::intern(const std::string &name) {
+    auto it = stringOffsets.find(name);
+    if (it != stringOffsets.end())
+        return it->second;
+    uint32_t offset = strings.size();
+    strings += name;
+    strings += '\0';
+    stringOffsets.insert(std::make_pair(name, offset));
+    return offset;
+}
+
+uint8_t ASTWriter::typeOf(TypeNode* type) {
+    return type ? (uint8_t)type->getTypeEnum() : ASTFile::NoType;
+}
+
+void ASTWriter::add(ASTFile::Kind kind, ASTNode* node, const std::vector<uint32_t> &kids) {
+    ASTFile::Node record;
+    record.kind = kind;
+    record.type = ASTFile::NoType;
+    record.flags = 0;
+    record.op = ExprNode::Unset;
+    record.line = node->getLine();
+    record.col = node->getCol();
+    record.value = 0;
+    record.name = ASTFile::NoName;
+    record.children = children.size();
+    record.numChildren = kids.size();
+    children.insert(children.end(), kids.begin(), kids.end());
+    nodes.push_back(record);
+    last = nodes.size() - 1;
+}
+
+ASTFile::Node &ASTWriter::current() {
+    return nodes.back();
+}
+
+/**********************************************************************************/
+/* Declarations                                                                   */
+/**********************************************************************************/
+
+void ASTWriter::visitProgramNode(ProgramNode *prg) {
+    std::vector<uint32_t> kids;
+    for (unsigned int i = 0; i < prg->getNumChildren(); i++) {
+        if (prg->getChild(i))
+            kids.push_back(emit(prg->getChild(i)));
+    }
+    add(ASTFile::Program, prg, kids);
+    if (prg->useIo())
+        current().flags |= ASTFile::UsesIo;
+}
+
+void ASTWriter::visitScalarDeclNode(ScalarDeclNode *scalar) {
+    add(ASTFile::ScalarDecl, scalar, {});
+    current().type = typeOf(scalar->getType());
+    current().name = intern(scalar->getIdent()->getName());
+}
+
+void ASTWriter::visitArrayDeclNode(ArrayDeclNode *array) {
+    add(ASTFile::ArrayDecl, array, {});
+    current().type = typeOf(array->getType());
+    current().flags |= ASTFile::IsArray;
+    current().value = array->getType()->getSize();
+    current().name = intern(array->getIdent()->getName());
+}
+
+void ASTWriter::visitFunctionDeclNode(FunctionDeclNode *func) {
+    std::vector<uint32_t> kids;
+    for (auto param : func->getParams())
+        kids.push_back(emit(param));
+    if (!func->getProto() && func->getBody())
+        kids.push_back(emit(func->getBody()));
+    add(ASTFile::FunctionDecl, func, kids);
+    current().type = typeOf(func->getRetType());
+    if (func->getProto())
+        current().flags |= ASTFile::IsProto;
+    current().value = func->getNumParameters();
+    current().name = intern(func->getIdent()->getName());
+}
+
+void ASTWriter::visitParameterNode(ParameterNode *param) {
+    add(ASTFile::Parameter, param, {});
+    current().type = typeOf(param->getType());
+    if (param->getType()->isArray())
+        current().flags |= ASTFile::IsArray;
+    current().name = intern(param->getIdent()->getName());
+}
+
+/**********************************************************************************/
+/* Statements                                                                     */
+/**********************************************************************************/
+
+void ASTWriter::visitScopeNode(ScopeNode *scope) {
+    std::vector<uint32_t> kids;
+    std::vector<DeclNode*> decls = scope->getDeclarations();
+    for (auto decl : decls)
+        kids.push_back(emit(decl));
+    for (unsigned int i = 0; i < scope->getNumChildren(); i++) {
+        if (scope->getChild(i))
+            kids.push_back(emit(scope->getChild(i)));
+    }
+    add(ASTFile::Scope, scope, kids);
+    current().value = decls.size();
+}
+
+void ASTWriter::visitExprStmtNode(ExprStmtNode *expr) {
+    add(ASTFile::ExprStmt, expr, {emit(expr->getExpr())});
+}
+
+void ASTWriter::visitAssignStmtNode(AssignStmtNode *assign) {
+    std::vector<uint32_t> kids;
+    kids.push_back(emit(assign->getTarget()));
+    kids.push_back(emit(assign->getValue()));
+    add(ASTFile::AssignStmt, assign, kids);
+}
+
+void ASTWriter::visitIfStmtNode(IfStmtNode *ifStmt) {
+    std::vector<uint32_t> kids;
+    kids.push_back(emit(ifStmt->getCondition()));
+    kids.push_back(emit(ifStmt->getThen()));
+    if (ifStmt->getHasElse())
+        kids.push_back(emit(ifStmt->getElse()));
+    add(ASTFile::IfStmt, ifStmt, kids);
+    if (ifStmt->getHasElse())
+        current().flags |= ASTFile::HasElse;
+}
+
+void ASTWriter::visitWhileStmtNode(WhileStmtNode *whileStmt) {
+    std::vector<uint32_t> kids;
+    kids.push_back(emit(whileStmt->getCondition()));
+    kids.push_back(emit(whileStmt->getBody()));
+    add(ASTFile::WhileStmt, whileStmt, kids);
+}
+
+void ASTWriter::visitReturnStmtNode(ReturnStmtNode *ret) {
+    std::vector<uint32_t> kids;
+    if (ret->getReturn())
+        kids.push_back(emit(ret->getReturn()));
+    add(ASTFile::ReturnStmt, ret, kids);
+}
+
+/**********************************************************************************/
+/* Expressions                                                                    */
+/**********************************************************************************/
+
+void ASTWriter::visitUnaryExprNode(UnaryExprNode *unary) {
+    add(ASTFile::UnaryExpr, unary, {emit(unary->getOperand())});
+    current().type = typeOf(unary->getType());
+    current().op = unary->getOpcode();
+}
+
+void ASTWriter::visitBinaryExprNode(BinaryExprNode *bin) {
+    std::vector<uint32_t> kids;
+    kids.push_back(emit(bin->getLeft()));
+    kids.push_back(emit(bin->getRight()));
+    add(ASTFile::BinaryExpr, bin, kids);
+    current().type = typeOf(bin->getType());
+    current().op = bin->getOpcode();
+}
+
+void ASTWriter::visitBoolExprNode(BoolExprNode *boolExpr) {
+    add(ASTFile::BoolExpr, boolExpr, {emit(boolExpr->getValue())});
+    current().type = typeOf(boolExpr->getType());
+}
+
+void ASTWriter::visitIntExprNode(IntExprNode *intExpr) {
+    add(ASTFile::IntExpr, intExpr, {emit(intExpr->getValue())});
+    current().type = typeOf(intExpr->getType());
+}
+
+void ASTWriter::visitBoolConstantNode(BoolConstantNode *boolConst) {
+    add(ASTFile::BoolConstant, boolConst, {});
+    current().type = typeOf(boolConst->getType());
+    current().value = boolConst->getVal();
+    current().name = intern(boolConst->getSource());
+}
+
+void ASTWriter::visitIntConstantNode(IntConstantNode *intConst) {
+    add(ASTFile::IntConstant, intConst, {});
+    current().type = typeOf(intConst->getType());
+    current().value = intConst->getVal();
+    current().name = intern(intConst->getSource());
+}
+
+// Arguments are not nodes of their own in the file
+void ASTWriter::visitArgumentNode(ArgumentNode *arg) {
+    emit(arg->getExpr());
+}
+
+void ASTWriter::visitCallExprNode(CallExprNode *call) {
+    std::vector<uint32_t> kids;
+    for (auto arg : call->getArguments())
+        kids.push_back(emit(arg));
+    add(ASTFile::Call, call, kids);
+    current().type = typeOf(call->getType());
+    current().name = intern(call->getIdent()->getName());
+}
+
+void ASTWriter::visitReferenceExprNode(ReferenceExprNode *ref) {
+    std::vector<uint32_t> kids;
+    if (ref->getIndex())
+        kids.push_back(emit(ref->getIndex()));
+    add(ASTFile::Reference, ref, kids);
+    current().type = typeOf(ref->getType());
+    current().name = intern(ref->getIdent()->getName());
+}
+
+} // namespace smallc
@@ -0,0 +1,68 @@
+//
+//  ASTWriter.h
+//  ECE467 Lab 3
+//
+//  Writes a checked program in the binary AST format of ASTFile, for
+//  --emit-ast. Each visit adds the node's record after its children's,
+//  so a node's children are contiguous in the children array.
+//
+
+#ifndef ASTWriter_h
+#define ASTWriter_h
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ASTFile.h"
+#include "ASTNodes.h"
+#include "ASTVisitorBase.h"
+
+namespace smallc {
+
+class ASTWriter : public ASTVisitorBase {
+private:
+    std::vector<ASTFile::Node> nodes;
+    std::vector<uint32_t> children;
+    std::string strings;
+    std::unordered_map<std::string, uint32_t> stringOffsets;
+    bool io;
+    uint32_t last;          // Index of the node visited last
+
+    uint32_t emit(ASTNode* node);
+    uint32_t intern(const std::string &name);
+    uint8_t typeOf(TypeNode* type);
+    void add(ASTFile::Kind kind, ASTNode* node, const std::vector<uint32_t> &kids);
+    ASTFile::Node &current();
+
+public:
+    ASTWriter();
+
+    // Writes the program to path; false if the file cannot be written
+    bool write(ProgramNode* prg, const std::string &path);
+
+    void visitProgramNode(ProgramNode *prg) override;
+    void visitScalarDeclNode(ScalarDeclNode *scalar) override;
+    void visitArrayDeclNode(ArrayDeclNode *array) override;
+    void visitFunctionDeclNode(FunctionDeclNode *func) override;
+    void visitParameterNode(ParameterNode *param) override;
+    void visitScopeNode(ScopeNode *scope) override;
+    void visitExprStmtNode(ExprStmtNode *expr) override;
+    void visitAssignStmtNode(AssignStmtNode *assign) override;
+    void visitIfStmtNode(IfStmtNode *ifStmt) override;
+    void visitWhileStmtNode(WhileStmtNode *whileStmt) override;
+    void visitReturnStmtNode(ReturnStmtNode *ret) override;
+    void visitUnaryExprNode(UnaryExprNode *unary) override;
+    void visitBinaryExprNode(BinaryExprNode *bin) override;
+    void visitBoolExprNode(BoolExprNode *boolExpr) override;
+    void visitIntExprNode(IntExprNode *intExpr) override;
+    void visitBoolConstantNode(BoolConstantNode *boolConst) override;
+    void visitIntConstantNode(IntConstantNode *intConst) override;
+    void visitArgumentNode(ArgumentNode *arg) override;
+    void visitCallExprNode(CallExprNode *call) override;
+    void visitReferenceExprNode(ReferenceExprNode *ref) override;
+};
+
+} // namespace smallc
+
+#endif /* ASTWriter_h */
@@ -0,0 +1,586 @@
+//
+//  AsmPrinter.cpp
+//  ECE467 Lab 3
+//
+//  Emits a register-allocated MachineModule as GNU assembler.
+//
+//  Frame layout, growing down from %rbp:
+//      saved callee-saved registers
+//      spill slots, 8 bytes each
+//      local arrays
+//  %rsp is kept 16-byte aligned after the prologue so calls need no
+//  further adjustment.
+//
+
+#include "AsmPrinter.h"
+
+namespace smallc {
+
+// Registers used for the first six arguments, in order
+static const int argRegs[6] = { RDI, RSI, RDX, RCX, R8, R9 };
+
+AsmPrinter::AsmPrinter(std::ostream &out_) : out(out_), fn(nullptr), frameSize(0), usesVecIndex(false) {}
+
+/**********************************************************************************/
+/* Operands                                                                       */
+/**********************************************************************************/
+
+std::string AsmPrinter::label(int block) {
+    return ".L" + fn->name + "_" + std::to_string(block);
+}
+
+std::string AsmPrinter::stubLabel(unsigned int index) {
+    return ".L" + fn->name + "_oob" + std::to_string(index);
+}
+
+std::string AsmPrinter::slot(int index) {
+    int offset = 8 * (int)savedRegs.size() + 8 * (index + 1);
+    return "-" + std::to_string(offset) + "(%rbp)";
+}
+
+std::string AsmPrinter::locVReg(int vreg, unsigned int bytes) {
+    const MachineLocation &l = fn->locs[vreg];
+    if (l.inReg)
+        return x86RegName(l.reg, bytes);
+    return slot(l.slot);
+}
+
+std::string AsmPrinter::loc(const MachineOperand &op, unsigned int bytes) {
+    if (op.isImm())
+        return "$" + std::to_string(op.val);
+    return locVReg(op.val, bytes);
+}
+
+bool AsmPrinter::inReg(const MachineOperand &op) {
+    return op.isVReg() && fn->locs[op.val].inReg;
+}
+
+bool AsmPrinter::sameLoc(const MachineOperand &a, const MachineOperand &b) {
+    return a.isVReg() && b.isVReg() && fn->locs[a.val] == fn->locs[b.val];
+}
+
+void AsmPrinter::move(const std::string &src, const std::string &dst, unsigned int bytes) {
+    if (src != dst)
+        out << "\tmov" << (bytes == 8 ? "q" : "l") << "\t" << src << ", " << dst << "\n";
+}
+
+void AsmPrinter::moveToReg(const MachineOperand &op, int reg, unsigned int bytes) {
+    move(loc(op, bytes), x86RegName(reg, bytes), bytes);
+}
+
+void AsmPrinter::moveFromReg(int reg, const MachineOperand &op, unsigned int bytes) {
+    move(x86RegName(reg, bytes), loc(op, bytes), bytes);
+}
+
+// Address of base[index] for 4-byte elements. Uses R10/R11 as scratch.
+std::string AsmPrinter::elemAddress(const MachineOperand &base, const MachineOperand &index) {
+    std::string baseReg;
+    if (inReg(base))
+        baseReg = loc(base, 8);
+    else {
+        moveToReg(base, R10, 8);
+        baseReg = x86RegName(R10, 8);
+    }
+    if (index.isImm())
+        return std::to_string(4 * (long)index.val) + "(" + baseReg + ")";
+    out << "\tmovslq\t" << loc(index, 4) << ", %r11\n";
+    return "(" + baseReg + ",%r11,4)";
+}
+
+/**********************************************************************************/
+/* Frame                                                                          */
+/**********************************************************************************/
+
+void AsmPrinter::layoutFrame() {
+    savedRegs.clear();
+    objectOffsets.clear();
+    std::vector<bool> used(NumX86Regs, false);
+    for (const auto &l : fn->locs) {
+        if (l.inReg)
+            used[l.reg] = true;
+    }
+    for (int r : { RBX, R12, R13, R14, R15 }) {
+        if (used[r])
+            savedRegs.push_back(r);
+    }
+
+    int saved = 8 * (int)savedRegs.size();
+    int offset = saved + 8 * fn->numSpillSlots;
+    for (int bytes : fn->frameObjects) {
+        offset += (bytes + 7) / 8 * 8;
+        objectOffsets.push_back(-offset);
+    }
+    frameSize = offset - saved;
+    if ((saved + frameSize) % 16 != 0)
+        frameSize += 8;
+}
+
+void AsmPrinter::printPrologue() {
+    out << "\tpushq\t%rbp\n";
+    out << "\tmovq\t%rsp, %rbp\n";
+    for (int r : savedRegs)
+        out << "\tpushq\t" << x86RegName(r, 8) << "\n";
+    if (frameSize > 0)
+        out << "\tsubq\t$" << frameSize << ", %rsp\n";
+
+    // Move incoming arguments to their allocated locations. Going through
+    // the stack sidesteps any overlap between argument and allocated registers.
+    unsigned int numRegArgs = fn->args.size() < 6 ? (unsigned int)fn->args.size() : 6;
+    for (unsigned int i = 0; i < numRegArgs; i++)
+        out << "\tpushq\t" << x86RegName(argRegs[i], 8) << "\n";
+    for (int i = (int)numRegArgs - 1; i >= 0; i--)
+        out << "\tpopq\t" << locVReg(fn->args[i], 8) << "\n";
+    for (unsigned int i = 6; i < fn->args.size(); i++) {
+        out << "\tmovq\t" << 16 + 8 * (i - 6) << "(%rbp), %rax\n";
+        move("%rax", locVReg(fn->args[i], 8), 8);
+    }
+}
+
+void AsmPrinter::printEpilogue() {
+    if (savedRegs.empty())
+        out << "\tmovq\t%rbp, %rsp\n";
+    else
+        out << "\tleaq\t-" << 8 * savedRegs.size() << "(%rbp), %rsp\n";
+    for (auto it = savedRegs.rbegin(); it != savedRegs.rend(); ++it)
+        out << "\tpopq\t" << x86RegName(*it, 8) << "\n";
+    out << "\tpopq\t%rbp\n";
+    out << "\tret\n";
+}
+
+/**********************************************************************************/
+/* Instructions                                                                   */
+/**********************************************************************************/
+
+static const char* condSuffix(MachineInstr::CondCode cc) {
+    switch (cc) {
+        case MachineInstr::EQ: return "e";
+        case MachineInstr::NE: return "ne";
+        case MachineInstr::LT: return "l";
+        case MachineInstr::LE: return "le";
+        case MachineInstr::GT: return "g";
+        case MachineInstr::GE: return "ge";
+    }
+    return "e";
+}
+
+void AsmPrinter::printBinary(const MachineInstr &mi) {
+    const char* opName = mi.op == MachineInstr::Add ? "addl" :
+                         mi.op == MachineInstr::Sub ? "subl" : "imull";
+    bool commutative = mi.op != MachineInstr::Sub;
+    const MachineOperand &a = mi.uses[0];
+    const MachineOperand &b = mi.uses[1];
+
+    if (inReg(mi.def) && !sameLoc(mi.def, b)) {
+        move(loc(a, 4), loc(mi.def, 4), 4);
+        out << "\t" << opName << "\t" << loc(b, 4) << ", " << loc(mi.def, 4) << "\n";
+    }
+    else if (inReg(mi.def) && commutative) {
+        out << "\t" << opName << "\t" << loc(a, 4) << ", " << loc(mi.def, 4) << "\n";
+    }
+    else {
+        moveToReg(a, RAX, 4);
+        out << "\t" << opName << "\t" << loc(b, 4) << ", %eax\n";
+        moveFromReg(RAX, mi.def, 4);
+    }
+}
+
+void AsmPrinter::printCall(const MachineInstr &mi) {
+    unsigned int numArgs = (unsigned int)mi.uses.size();
+    unsigned int numRegArgs = numArgs < 6 ? numArgs : 6;
+    unsigned int numStackArgs = numArgs - numRegArgs;
+    unsigned int pad = numStackArgs % 2 ? 8 : 0;
+
+    if (pad)
+        out << "\tsubq\t$8, %rsp\n";
+    for (int i = (int)numArgs - 1; i >= 6; i--)
+        out << "\tpushq\t" << loc(mi.uses[i], 8) << "\n";
+    // Argument registers may overlap allocated registers: stage through the stack
+    for (unsigned int i = 0; i < numRegArgs; i++)
+        out << "\tpushq\t" << loc(mi.uses[i], 8) << "\n";
+    for (int i = (int)numRegArgs - 1; i >= 0; i--)
+        out << "\tpopq\t" << x86RegName(argRegs[i], 8) << "\n";
+    out << "\tcall\t" << mi.sym << "\n";
+    if (numStackArgs)
+        out << "\taddq\t$" << 8 * numStackArgs + pad << ", %rsp\n";
+    if (mi.def.isVReg())
+        moveFromReg(RAX, mi.def, 4);
+}
+
+// An unsigned compare catches negative indices too. Failures jump to an
+// out-of-line stub so the check costs one compare and a not-taken branch.
+void AsmPrinter::printBoundsCheck(const MachineInstr &mi) {
+    const MachineOperand &index = mi.uses[0];
+    const MachineOperand &len = mi.uses[1];
+    unsigned int stub = (unsigned int)boundsStubs.size();
+    boundsStubs.push_back(mi.line);
+
+    if (index.isImm() && !len.isImm()) {
+        out << "\tcmpl\t" << loc(index, 4) << ", " << loc(len, 4) << "\n";
+        out << "\tjbe\t" << stubLabel(stub) << "\n";
+        return;
+    }
+    std::string lhs;
+    if (inReg(index) || (index.isVReg() && len.isImm()))
+        lhs = loc(index, 4);
+    else {
+        moveToReg(index, RAX, 4);
+        lhs = "%eax";
+    }
+    out << "\tcmpl\t" << loc(len, 4) << ", " << lhs << "\n";
+    out << "\tjae\t" << stubLabel(stub) << "\n";
+}
+
+void AsmPrinter::printInstr(const MachineInstr &mi, int nextBlock) {
+    switch (mi.op) {
+        case MachineInstr::Copy: {
+            unsigned int bytes = fn->vregIsPtr[mi.def.val] ? 8 : 4;
+            if (sameLoc(mi.def, mi.uses[0]))
+                break;
+            if (!inReg(mi.def) && mi.uses[0].isVReg() && !inReg(mi.uses[0])) {
+                moveToReg(mi.uses[0], RAX, bytes);
+                moveFromReg(RAX, mi.def, bytes);
+            }
+            else
+                move(loc(mi.uses[0], bytes), loc(mi.def, bytes), bytes);
+            break;
+        }
+        case MachineInstr::Add:
+        case MachineInstr::Sub:
+        case MachineInstr::Mul:
+            printBinary(mi);
+            break;
+        case MachineInstr::Div:
+            moveToReg(mi.uses[0], RAX, 4);
+            out << "\tcltd\n";
+            if (mi.uses[1].isImm()) {
+                moveToReg(mi.uses[1], R10, 4);
+                out << "\tidivl\t%r10d\n";
+            }
+            else
+                out << "\tidivl\t" << loc(mi.uses[1], 4) << "\n";
+            moveFromReg(RAX, mi.def, 4);
+            break;
+        case MachineInstr::Neg:
+        case MachineInstr::Not:
+            moveToReg(mi.uses[0], RAX, 4);
+            out << (mi.op == MachineInstr::Neg ? "\tnegl\t%eax\n" : "\txorl\t$1, %eax\n");
+            moveFromReg(RAX, mi.def, 4);
+            break;
+        case MachineInstr::SetCC:
+            moveToReg(mi.uses[0], RAX, 4);
+            out << "\tcmpl\t" << loc(mi.uses[1], 4) << ", %eax\n";
+            out << "\tset" << condSuffix(mi.cc) << "\t%al\n";
+            out << "\tmovzbl\t%al, %eax\n";
+            moveFromReg(RAX, mi.def, 4);
+            break;
+        case MachineInstr::CmpBr: {
+            const MachineOperand &a = mi.uses[0];
+            const MachineOperand &b = mi.uses[1];
+            if (inReg(a) || (a.isVReg() && !b.isVReg()))
+                out << "\tcmpl\t" << loc(b, 4) << ", " << loc(a, 4) << "\n";
+            else {
+                moveToReg(a, RAX, 4);
+                out << "\tcmpl\t" << loc(b, 4) << ", %eax\n";
+            }
+            if (mi.target[0] == nextBlock) {
+                out << "\tj" << condSuffix(MachineInstr::invert(mi.cc)) << "\t" << label(mi.target[1]) << "\n";
+                break;
+            }
+            out << "\tj" << condSuffix(mi.cc) << "\t" << label(mi.target[0]) << "\n";
+            if (mi.target[1] != nextBlock)
+                out << "\tjmp\t" << label(mi.target[1]) << "\n";
+            break;
+        }
+        case MachineInstr::Jmp:
+            if (mi.target[0] != nextBlock)
+                out << "\tjmp\t" << label(mi.target[0]) << "\n";
+            break;
+        case MachineInstr::Call:
+            printCall(mi);
+            break;
+        case MachineInstr::Ret:
+            if (!mi.uses.empty())
+                moveToReg(mi.uses[0], RAX, 4);
+            printEpilogue();
+            break;
+        case MachineInstr::LoadGlobal:
+            if (inReg(mi.def))
+                move(mi.sym + "(%rip)", loc(mi.def, 4), 4);
+            else {
+                move(mi.sym + "(%rip)", "%eax", 4);
+                moveFromReg(RAX, mi.def, 4);
+            }
+            break;
+        case MachineInstr::StoreGlobal:
+            if (inReg(mi.uses[0]) || mi.uses[0].isImm())
+                move(loc(mi.uses[0], 4), mi.sym + "(%rip)", 4);
+            else {
+                moveToReg(mi.uses[0], RAX, 4);
+                move("%eax", mi.sym + "(%rip)", 4);
+            }
+            break;
+        case MachineInstr::AddrGlobal:
+        case MachineInstr::AddrFrame: {
+            std::string addr = mi.op == MachineInstr::AddrGlobal ? mi.sym + "(%rip)" :
+                std::to_string(objectOffsets[mi.frameIdx]) + "(%rbp)";
+            if (inReg(mi.def))
+                out << "\tleaq\t" << addr << ", " << loc(mi.def, 8) << "\n";
+            else {
+                out << "\tleaq\t" << addr << ", %rax\n";
+                moveFromReg(RAX, mi.def, 8);
+            }
+            break;
+        }
+        case MachineInstr::LoadElem: {
+            std::string addr = elemAddress(mi.uses[0], mi.uses[1]);
+            if (inReg(mi.def))
+                move(addr, loc(mi.def, 4), 4);
+            else {
+                move(addr, "%eax", 4);
+                moveFromReg(RAX, mi.def, 4);
+            }
+            break;
+        }
+        case MachineInstr::StoreElem: {
+            std::string val;
+            if (inReg(mi.uses[2]) || mi.uses[2].isImm())
+                val = loc(mi.uses[2], 4);
+            else {
+                moveToReg(mi.uses[2], RAX, 4);
+                val = "%eax";
+            }
+            move(val, elemAddress(mi.uses[0], mi.uses[1]), 4);
+            break;
+        }
+        case MachineInstr::BoundsCheck:
+            printBoundsCheck(mi);
+            break;
+        case MachineInstr::VecLoad:
+        case MachineInstr::VecStore:
+        case MachineInstr::VecSplat:
+        case MachineInstr::VecIndex:
+        case MachineInstr::VecAdd:
+        case MachineInstr::VecSub:
+        case MachineInstr::VecMul:
+        case MachineInstr::VecNeg:
+        case MachineInstr::VecEnd:
+            if (mi.lanes == 8)
+                printAVX2(mi);
+            else
+                printSSE2(mi);
+            break;
+        case MachineInstr::ProfileInc:
+            out << "\tincq\t.Lsc_prof_counters+" << 8 * mi.uses[0].val << "(%rip)\n";
+            break;
+    }
+}
+
+/**********************************************************************************/
+/* Vector instructions                                                            */
+/**********************************************************************************/
+
+// Vector registers come from instruction selection; xmm14 and xmm15 are
+// left free as scratch
+std::string AsmPrinter::vecReg(const MachineOperand &op, unsigned int lanes) {
+    return (lanes == 8 ? "%ymm" : "%xmm") + std::to_string(op.val);
+}
+
+// Low lane of xmm from a scalar operand
+void AsmPrinter::moveToVec(const MachineOperand &op, const std::string &xmm, const char* movd) {
+    if (op.isImm()) {
+        out << "\tmovl\t$" << op.val << ", %eax\n";
+        out << "\t" << movd << "\t%eax, " << xmm << "\n";
+    }
+    else
+        out << "\t" << movd << "\t" << loc(op, 4) << ", " << xmm << "\n";
+}
+
+// SSE2 has two-operand forms and no 32-bit multiply
+void AsmPrinter::printSSE2(const MachineInstr &mi) {
+    std::string def = mi.def.isXReg() ? vecReg(mi.def, 4) : "";
+    switch (mi.op) {
+        case MachineInstr::VecLoad: {
+            std::string addr = elemAddress(mi.uses[0], mi.uses[1]);
+            out << "\tmovdqu\t" << addr << ", " << def << "\n";
+            break;
+        }
+        case MachineInstr::VecStore: {
+            std::string addr = elemAddress(mi.uses[0], mi.uses[1]);
+            out << "\tmovdqu\t" << vecReg(mi.uses[2], 4) << ", " << addr << "\n";
+            break;
+        }
+        case MachineInstr::VecSplat:
+        case MachineInstr::VecIndex:
+            moveToVec(mi.uses[0], def, "movd");
+            out << "\tpshufd\t$0, " << def << ", " << def << "\n";
+            if (mi.op == MachineInstr::VecIndex) {
+                out << "\tpaddd\t.Lsc_vec_index(%rip), " << def << "\n";
+                usesVecIndex = true;
+            }
+            break;
+        case MachineInstr::VecAdd:
+        case MachineInstr::VecSub:
+            out << "\tmovdqa\t" << vecReg(mi.uses[0], 4) << ", " << def << "\n";
+            out << "\t" << (mi.op == MachineInstr::VecAdd ? "paddd" : "psubd") << "\t"
+                << vecReg(mi.uses[1], 4) << ", " << def << "\n";
+            break;
+        case MachineInstr::VecMul: {
+            // Even lanes, then odd lanes shifted down, multiplied as 64-bit
+            // products; the low halves are interleaved back together
+            std::string a = vecReg(mi.uses[0], 4);
+            std::string b = vecReg(mi.uses[1], 4);
+            out << "\tmovdqa\t" << a << ", " << def << "\n";
+            out << "\tpmuludq\t" << b << ", " << def << "\n";
+            out << "\tmovdqa\t" << a << ", %xmm14\n";
+            out << "\tpsrlq\t$32, %xmm14\n";
+            out << "\tmovdqa\t" << b << ", %xmm15\n";
+            out << "\tpsrlq\t$32, %xmm15\n";
+            out << "\tpmuludq\t%xmm15, %xmm14\n";
+            out << "\tpshufd\t$8, " << def << ", " << def << "\n";
+            out << "\tpshufd\t$8, %xmm14, %xmm14\n";
+            out << "\tpunpckldq\t%xmm14, " << def << "\n";
+            break;
+        }
+        case MachineInstr::VecNeg:
+            out << "\tpxor\t" << def << ", " << def << "\n";
+            out << "\tpsubd\t" << vecReg(mi.uses[0], 4) << ", " << def << "\n";
+            break;
+        default:
+            break;
+    }
+}
+
+void AsmPrinter::printAVX2(const MachineInstr &mi) {
+    std::string def = mi.def.isXReg() ? vecReg(mi.def, 8) : "";
+    switch (mi.op) {
+        case MachineInstr::VecLoad: {
+            std::string addr = elemAddress(mi.uses[0], mi.uses[1]);
+            out << "\tvmovdqu\t" << addr << ", " << def << "\n";
+            break;
+        }
+        case MachineInstr::VecStore: {
+            std::string addr = elemAddress(mi.uses[0], mi.uses[1]);
+            out << "\tvmovdqu\t" << vecReg(mi.uses[2], 8) << ", " << addr << "\n";
+            break;
+        }
+        case MachineInstr::VecSplat:
+        case MachineInstr::VecIndex: {
+            std::string xmm = vecReg(mi.def, 4);
+            moveToVec(mi.uses[0], xmm, "vmovd");
+            out << "\tvpbroadcastd\t" << xmm << ", " << def << "\n";
+            if (mi.op == MachineInstr::VecIndex) {
+                out << "\tvpaddd\t.Lsc_vec_index(%rip), " << def << ", " << def << "\n";
+                usesVecIndex = true;
+            }
+            break;
+        }
+        case MachineInstr::VecAdd:
+        case MachineInstr::VecSub:
+        case MachineInstr::VecMul: {
+            const char* op = mi.op == MachineInstr::VecAdd ? "vpaddd"
+                : mi.op == MachineInstr::VecSub ? "vpsubd" : "vpmulld";
+            out << "\t" << op << "\t" << vecReg(mi.uses[1], 8) << ", " << vecReg(mi.uses[0], 8)
+                << ", " << def << "\n";
+            break;
+        }
+        case MachineInstr::VecNeg:
+            out << "\tvpxor\t" << def << ", " << def << ", " << def << "\n";
+            out << "\tvpsubd\t" << vecReg(mi.uses[0], 8) << ", " << def << ", " << def << "\n";
+            break;
+        case MachineInstr::VecEnd:
+            // Avoid the penalty for mixing 256-bit and legacy SSE code
+            out << "\tvzeroupper\n";
+            break;
+        default:
+            break;
+    }
+}
+
+/**********************************************************************************/
+/* Functions and modules                                                          */
+/**********************************************************************************/
+
+void AsmPrinter::printFunction(MachineFunction* func) {
+    fn = func;
+    boundsStubs.clear();
+    layoutFrame();
+    out << "\t.globl\t" << fn->name << "\n";
+    out << "\t.type\t" << fn->name << ", @function\n";
+    out << fn->name << ":\n";
+    printPrologue();
+    for (unsigned int b = 0; b < fn->blocks.size(); b++) {
+        if (b > 0)
+            out << label(b) << ":\t\t\t# " << fn->blocks[b].label << "\n";
+        int next = b + 1 < fn->blocks.size() ? (int)b + 1 : -1;
+        for (const auto &mi : fn->blocks[b].instrs)
+            printInstr(mi, next);
+    }
+    for (unsigned int i = 0; i < boundsStubs.size(); i++) {
+        out << stubLabel(i) << ":\n";
+        out << "\tmovl\t$" << boundsStubs[i] << ", %edi\n";
+        out << "\tcall\tscrt_bounds_error\n";
+    }
+    out << "\t.size\t" << fn->name << ", .-" << fn->name << "\n\n";
+    fn = nullptr;
+}
+
+void AsmPrinter::printModule(MachineModule* module) {
+    out << "\t.text\n";
+    for (auto func : module->functions)
+        printFunction(func);
+    if (!module->globals.empty()) {
+        out << "\t.bss\n";
+        for (const auto &g : module->globals) {
+            out << "\t.p2align\t4\n";
+            out << g.name << ":\n";
+            out << "\t.zero\t" << (g.size > 0 ? g.size : 4) << "\n";
+        }
+    }
+    if (usesVecIndex) {
+        out << "\t.section\t.rodata\n";
+        out << "\t.p2align\t5\n";
+        out << ".Lsc_vec_index:\n";
+        out << "\t.long\t0, 1, 2, 3, 4, 5, 6, 7\n";
+    }
+    if (!module->profileKeys.empty())
+        printProfileData(module);
+    out << "\t.section\t.note.GNU-stack,\"\",@progbits\n";
+}
+
+// The counters, their keys as one newline separated string, and a
+// constructor handing both to the runtime, which writes them out at exit
+void AsmPrinter::printProfileData(MachineModule* module) {
+    out << "\t.bss\n";
+    out << "\t.p2align\t3\n";
+    out << ".Lsc_prof_counters:\n";
+    out << "\t.zero\t" << 8 * module->profileKeys.size() << "\n";
+    out << "\t.section\t.rodata\n";
+    out << ".Lsc_prof_keys:\n";
+    for (const auto &key : module->profileKeys)
+        out << "\t.ascii\t\"" << escape(key) << "\\n\"\n";
+    out << "\t.byte\t0\n";
+    out << ".Lsc_prof_file:\n";
+    out << "\t.string\t\"" << escape(module->profileFile) << "\"\n";
+    out << "\t.section\t.init_array,\"aw\"\n";
+    out << "\t.p2align\t3\n";
+    out << "\t.quad\t.Lsc_prof_init\n";
+    out << "\t.text\n";
+    out << ".Lsc_prof_init:\n";
+    out << "\tleaq\t.Lsc_prof_counters(%rip), %rdi\n";
+    out << "\tmovl\t$" << module->profileKeys.size() << ", %esi\n";
+    out << "\tleaq\t.Lsc_prof_keys(%rip), %rdx\n";
+    out << "\tleaq\t.Lsc_prof_file(%rip), %rcx\n";
+    out << "\tjmp\tscrt_profile_register\n";
+}
+
+std::string AsmPrinter::escape(const std::string &str) {
+    std::string escaped;
+    for (char c : str) {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+} // namespace smallc
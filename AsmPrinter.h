@@ -0,0 +1,64 @@
+//
+//  AsmPrinter.h
+//  ECE467 Lab 3
+//
+//  Emits a register-allocated MachineModule as GNU assembler (AT&T
+//  syntax) for x86-64 System V. The output links against the scio
+//  runtime (scio.c).
+//
+
+#ifndef AsmPrinter_h
+#define AsmPrinter_h
+
+#include <ostream>
+#include <string>
+
+#include "MachineIR.h"
+
+namespace smallc {
+
+class AsmPrinter {
+private:
+    std::ostream &out;
+    MachineFunction* fn;            // Function being printed
+    std::vector<int> savedRegs;     // Callee-saved registers used by fn
+    std::vector<int> objectOffsets; // rbp offset of each frame object
+    int frameSize;                  // Bytes below the saved registers
+    std::vector<unsigned int> boundsStubs;  // Source line of each failed-check stub
+    bool usesVecIndex;              // Emit the lane numbers vector
+
+    void layoutFrame();
+    std::string label(int block);
+    std::string slot(int index);
+    std::string loc(const MachineOperand &op, unsigned int bytes);
+    std::string locVReg(int vreg, unsigned int bytes);
+    bool sameLoc(const MachineOperand &a, const MachineOperand &b);
+    bool inReg(const MachineOperand &op);
+    void move(const std::string &src, const std::string &dst, unsigned int bytes);
+    void moveToReg(const MachineOperand &op, int reg, unsigned int bytes);
+    void moveFromReg(int reg, const MachineOperand &op, unsigned int bytes);
+    void printPrologue();
+    void printEpilogue();
+    void printInstr(const MachineInstr &mi, int nextBlock);
+    void printCall(const MachineInstr &mi);
+    void printBinary(const MachineInstr &mi);
+    void printBoundsCheck(const MachineInstr &mi);
+    std::string stubLabel(unsigned int index);
+    std::string elemAddress(const MachineOperand &base, const MachineOperand &index);
+    std::string vecReg(const MachineOperand &op, unsigned int lanes);
+    void moveToVec(const MachineOperand &op, const std::string &xmm, const char* movd);
+    void printSSE2(const MachineInstr &mi);
+    void printAVX2(const MachineInstr &mi);
+    void printProfileData(MachineModule* module);
+    static std::string escape(const std::string &str);
+
+public:
+    explicit AsmPrinter(std::ostream &out_);
+
+    void printModule(MachineModule* module);
+    void printFunction(MachineFunction* func);
+};
+
+} // namespace smallc
+
+#endif /* AsmPrinter_h */
@@ -0,0 +1,99 @@
+//
+//  BlockLayout.cpp
+//  ECE467 Lab 3
+//
+//  Profile-guided block placement.
+//
+
+#include "BlockLayout.h"
+
+namespace smallc {
+
+BlockLayout::BlockLayout() : numMoved(0), numFunctions(0) {}
+
+const char* BlockLayout::getName() const { return "layout"; }
+
+void BlockLayout::printStatistics(std::ostream &out) {
+    out << "layout: " << numMoved << " blocks moved in " << numFunctions << " functions\n";
+}
+
+// A block without a count ran as often as control reached it
+void BlockLayout::inferCounts(Function* fn) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto bb : fn->getBlocks()) {
+            if (bb->hasProfileCount() || bb->getPredecessors().empty())
+                continue;
+            long long count = 0;
+            for (auto pred : bb->getPredecessors()) {
+                long long edge = pred->getEdgeCount(bb);
+                if (edge < 0) {
+                    count = -1;
+                    break;
+                }
+                count += edge;
+            }
+            if (count >= 0) {
+                bb->setProfileCount(count);
+                changed = true;
+            }
+        }
+    }
+}
+
+BasicBlock* BlockLayout::hottestSuccessor(BasicBlock* bb, std::set<BasicBlock*> &placed) {
+    BasicBlock* best = nullptr;
+    long long bestCount = 0;
+    for (auto succ : bb->getSuccessors()) {
+        long long count = bb->getEdgeCount(succ);
+        if (!placed.count(succ) && count > bestCount) {
+            best = succ;
+            bestCount = count;
+        }
+    }
+    return best;
+}
+
+bool BlockLayout::runOnFunction(Function* fn) {
+    if (!fn->getEntry()->hasProfileCount())
+        return false;
+    inferCounts(fn);
+
+    // Grow a chain from the entry, then from the hottest block left, until
+    // no block that ran is left; the rest keep their order at the end
+    std::vector<BasicBlock*> order;
+    std::set<BasicBlock*> placed;
+    BasicBlock* seed = fn->getEntry();
+    while (seed) {
+        for (BasicBlock* bb = seed; bb; bb = hottestSuccessor(bb, placed)) {
+            order.push_back(bb);
+            placed.insert(bb);
+        }
+        seed = nullptr;
+        for (auto bb : fn->getBlocks()) {
+            if (!placed.count(bb) && bb->getProfileCount() > 0 &&
+                (!seed || bb->getProfileCount() > seed->getProfileCount()))
+                seed = bb;
+        }
+    }
+    for (auto bb : fn->getBlocks()) {
+        if (!placed.count(bb))
+            order.push_back(bb);
+    }
+
+    unsigned int moved = 0;
+    for (unsigned int i = 0; i < order.size(); i++) {
+        if (fn->getBlocks()[i] != order[i])
+            moved++;
+    }
+    if (moved == 0)
+        return false;
+    for (unsigned int i = 1; i < order.size(); i++)
+        fn->moveBlockAfter(order[i], order[i - 1]);
+    numMoved += moved;
+    numFunctions++;
+    return true;
+}
+
+} // namespace smallc
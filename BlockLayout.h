@@ -0,0 +1,41 @@
+//
+//  BlockLayout.h
+//  ECE467 Lab 3
+//
+//  Profile-guided block placement. Blocks are laid out in chains that
+//  follow the most frequent edge out of each block, so the hot path of a
+//  function falls through instead of jumping, and blocks the profile
+//  never saw run are moved to the end of the function. The entry block
+//  stays first. Blocks created after the profile was read (preheaders,
+//  inlined copies) get counts inferred from their predecessors' edges.
+//  Without a profile the pass does nothing.
+//
+
+#ifndef BlockLayout_h
+#define BlockLayout_h
+
+#include <set>
+#include <vector>
+
+#include "PassManager.h"
+
+namespace smallc {
+
+class BlockLayout : public FunctionPass {
+private:
+    unsigned int numMoved;
+    unsigned int numFunctions;
+
+    static void inferCounts(Function* fn);
+    static BasicBlock* hottestSuccessor(BasicBlock* bb, std::set<BasicBlock*> &placed);
+
+public:
+    BlockLayout();
+    const char* getName() const override;
+    bool runOnFunction(Function* fn) override;
+    void printStatistics(std::ostream &out) override;
+};
+
+} // namespace smallc
+
+#endif /* BlockLayout_h */
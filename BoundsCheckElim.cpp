@@ -0,0 +1,352 @@
+//
+//  BoundsCheckElim.cpp
+//  ECE467 Lab 3
+//
+//  Interval analysis and bounds check elimination.
+//
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+#include "BoundsCheckElim.h"
+
+namespace smallc {
+
+/**********************************************************************************/
+/* The Interval Class                                                             */
+/**********************************************************************************/
+
+BoundsCheckElim::Interval::Interval() : lo(1), hi(0) {}
+
+BoundsCheckElim::Interval::Interval(long long lo_, long long hi_) : lo(lo_), hi(hi_) {}
+
+BoundsCheckElim::Interval BoundsCheckElim::Interval::full() {
+    return Interval(INT_MIN, INT_MAX);
+}
+
+bool BoundsCheckElim::Interval::isEmpty() const {
+    return lo > hi;
+}
+
+bool BoundsCheckElim::Interval::operator==(const Interval &other) const {
+    if (isEmpty() || other.isEmpty())
+        return isEmpty() == other.isEmpty();
+    return lo == other.lo && hi == other.hi;
+}
+
+bool BoundsCheckElim::Interval::operator!=(const Interval &other) const {
+    return !(*this == other);
+}
+
+BoundsCheckElim::Interval BoundsCheckElim::Interval::join(const Interval &other) const {
+    if (isEmpty())
+        return other;
+    if (other.isEmpty())
+        return *this;
+    return Interval(std::min(lo, other.lo), std::max(hi, other.hi));
+}
+
+BoundsCheckElim::Interval BoundsCheckElim::Interval::meet(const Interval &other) const {
+    return Interval(std::max(lo, other.lo), std::min(hi, other.hi));
+}
+
+/**********************************************************************************/
+/* The BoundsCheckElim Pass                                                       */
+/**********************************************************************************/
+
+BoundsCheckElim::BoundsCheckElim(std::ostream &diag_, bool removeChecks_)
+    : diag(diag_), removeChecks(removeChecks_), dt(nullptr),
+      numRemoved(0), numRemaining(0), numWarnings(0) {}
+
+const char* BoundsCheckElim::getName() const { return "bce"; }
+
+void BoundsCheckElim::printStatistics(std::ostream &out) {
+    out << "bce: " << numRemoved << " bounds checks removed, " << numRemaining
+        << " remaining, " << numWarnings << " out-of-bounds accesses reported\n";
+}
+
+BoundsCheckElim::Interval BoundsCheckElim::baseRange(Value* v) {
+    if (v->getKind() == Value::ConstantVal) {
+        int c = static_cast<Constant*>(v)->getVal();
+        return Interval(c, c);
+    }
+    if (v->getKind() == Value::InstructionVal) {
+        auto it = ranges.find(v);
+        return it == ranges.end() ? Interval() : it->second;
+    }
+    return Interval::full();
+}
+
+// The comparison that must have held for control to pass from one block to
+// the other, if the edge is taken on a single condition
+bool BoundsCheckElim::getEdgeCondition(BasicBlock* from, BasicBlock* to, Instruction* &cmp,
+                                       Instruction::Predicate &pred) {
+    Instruction* term = from->getTerminator();
+    if (!term || term->getOpcode() != Instruction::CondBr)
+        return false;
+    if (term->getBlockOperand(0) == term->getBlockOperand(1))
+        return false;
+    Value* cond = term->getOperand(0);
+    if (cond->getKind() != Value::InstructionVal)
+        return false;
+    cmp = static_cast<Instruction*>(cond);
+    if (cmp->getOpcode() != Instruction::Cmp)
+        return false;
+    pred = cmp->getPredicate();
+    if (term->getBlockOperand(1) == to)
+        pred = Instruction::invertPredicate(pred);
+    return true;
+}
+
+BoundsCheckElim::Interval BoundsCheckElim::refine(Value* v, Interval r, BasicBlock* from,
+                                                  BasicBlock* to) {
+    Instruction* cmp;
+    Instruction::Predicate pred;
+    if (!getEdgeCondition(from, to, cmp, pred))
+        return r;
+    Value* other;
+    if (cmp->getOperand(0) == v)
+        other = cmp->getOperand(1);
+    else if (cmp->getOperand(1) == v) {
+        other = cmp->getOperand(0);
+        pred = Instruction::swapPredicate(pred);
+    }
+    else
+        return r;
+
+    Interval o = baseRange(other);
+    if (o.isEmpty() || r.isEmpty())
+        return r;
+    switch (pred) {
+        case Instruction::LT: return r.meet(Interval(INT_MIN, o.hi - 1));
+        case Instruction::LE: return r.meet(Interval(INT_MIN, o.hi));
+        case Instruction::GT: return r.meet(Interval(o.lo + 1, INT_MAX));
+        case Instruction::GE: return r.meet(Interval(o.lo, INT_MAX));
+        case Instruction::EQ: return r.meet(o);
+        default:
+            // Only an excluded end point can be dropped
+            if (o.lo == o.hi && o.lo == r.lo)
+                r.lo++;
+            else if (o.lo == o.hi && o.hi == r.hi)
+                r.hi--;
+            return r;
+    }
+}
+
+// The range of v where bb starts, narrowed by every branch condition on
+// the way down the dominator tree. Only forward edges are used: a block
+// entered along an edge is then guaranteed to see the values compared on
+// that edge, not ones from a later loop iteration.
+BoundsCheckElim::Interval BoundsCheckElim::rangeAt(Value* v, BasicBlock* bb) {
+    Interval r = baseRange(v);
+    for (BasicBlock* b = bb; b && !r.isEmpty(); b = dt->getIdom(b)) {
+        if (b->getPredecessors().size() != 1)
+            continue;
+        BasicBlock* pred = b->getPredecessors()[0];
+        if (dt->isReachable(pred) && !dt->dominates(b, pred))
+            r = refine(v, r, pred, b);
+    }
+    return r;
+}
+
+// Results that do not fit in 32 bits wrap around, so anything is possible
+BoundsCheckElim::Interval BoundsCheckElim::fromCorners(long long a, long long b, long long c,
+                                                       long long d) {
+    long long lo = std::min(std::min(a, b), std::min(c, d));
+    long long hi = std::max(std::max(a, b), std::max(c, d));
+    if (lo < INT_MIN || hi > INT_MAX)
+        return Interval::full();
+    return Interval(lo, hi);
+}
+
+BoundsCheckElim::Interval BoundsCheckElim::evaluate(Instruction* inst) {
+    BasicBlock* bb = inst->getParent();
+    switch (inst->getOpcode()) {
+        case Instruction::Phi: {
+            Interval r;
+            for (unsigned int i = 0; i < inst->getNumOperands(); i++) {
+                BasicBlock* pred = inst->getBlockOperand(i);
+                if (!dt->isReachable(pred))
+                    continue;
+                Interval in = rangeAt(inst->getOperand(i), pred);
+                // The edge into the phi's block may add a condition
+                r = r.join(refine(inst->getOperand(i), in, pred, bb));
+            }
+            return r;
+        }
+        case Instruction::Add:
+        case Instruction::Sub:
+        case Instruction::Mul:
+        case Instruction::Div: {
+            Interval a = rangeAt(inst->getOperand(0), bb);
+            Interval b = rangeAt(inst->getOperand(1), bb);
+            if (a.isEmpty() || b.isEmpty())
+                return Interval();
+            switch (inst->getOpcode()) {
+                case Instruction::Add:
+                    return fromCorners(a.lo + b.lo, a.hi + b.hi, a.lo + b.lo, a.hi + b.hi);
+                case Instruction::Sub:
+                    return fromCorners(a.lo - b.hi, a.hi - b.lo, a.lo - b.hi, a.hi - b.lo);
+                case Instruction::Mul:
+                    return fromCorners(a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi);
+                default: {
+                    if (b.lo <= 0 && b.hi >= 0) {
+                        // Dividing by anything but 0 never grows the magnitude
+                        long long m = std::max(-a.lo, a.hi);
+                        return m > INT_MAX ? Interval::full() : Interval(-m, m);
+                    }
+                    return fromCorners(a.lo / b.lo, a.lo / b.hi, a.hi / b.lo, a.hi / b.hi);
+                }
+            }
+        }
+        case Instruction::Neg: {
+            Interval a = rangeAt(inst->getOperand(0), bb);
+            if (a.isEmpty())
+                return a;
+            return fromCorners(-a.hi, -a.lo, -a.hi, -a.lo);
+        }
+        case Instruction::Not:
+        case Instruction::Cmp:
+            return Interval(0, 1);
+        default:
+            return Interval::full();
+    }
+}
+
+void BoundsCheckElim::computeRanges() {
+    const std::vector<BasicBlock*> &rpo = dt->getReversePostOrder();
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto bb : rpo) {
+            for (auto inst : bb->getInstructions()) {
+                if (inst->getType() != Value::Int && inst->getType() != Value::Bool)
+                    continue;
+                Interval old = baseRange(inst);
+                Interval r = old.join(evaluate(inst));
+                if (r == old)
+                    continue;
+                // Loops converge once a growing bound is pushed to the limit
+                if (inst->getOpcode() == Instruction::Phi && !old.isEmpty() &&
+                    ++phiChanges[inst] > 2) {
+                    if (r.lo < old.lo)
+                        r.lo = INT_MIN;
+                    if (r.hi > old.hi)
+                        r.hi = INT_MAX;
+                }
+                ranges[inst] = r;
+                changed = true;
+            }
+        }
+    }
+
+    // Widening overshoots; re-evaluating from the fixpoint recovers bounds
+    // like the exit value of a loop counter and stays sound
+    for (unsigned int pass = 0; pass < 2; pass++) {
+        for (auto bb : rpo) {
+            for (auto inst : bb->getInstructions()) {
+                if (inst->getType() != Value::Int && inst->getType() != Value::Bool)
+                    continue;
+                Interval r = evaluate(inst).meet(baseRange(inst));
+                if (!r.isEmpty())
+                    ranges[inst] = r;
+            }
+        }
+    }
+}
+
+// Did a dominating branch establish index < len?
+bool BoundsCheckElim::provesBelow(Value* index, Value* len, BasicBlock* bb) {
+    for (BasicBlock* b = bb; b; b = dt->getIdom(b)) {
+        if (b->getPredecessors().size() != 1)
+            continue;
+        BasicBlock* from = b->getPredecessors()[0];
+        Instruction* cmp;
+        Instruction::Predicate pred;
+        if (!dt->isReachable(from) || dt->dominates(b, from) ||
+            !getEdgeCondition(from, b, cmp, pred))
+            continue;
+        Value* lhs = cmp->getOperand(0);
+        Value* rhs = cmp->getOperand(1);
+        if ((lhs == index && rhs == len && pred == Instruction::LT) ||
+            (lhs == len && rhs == index && pred == Instruction::GT))
+            return true;
+    }
+    return false;
+}
+
+bool BoundsCheckElim::isRedundant(Instruction* check, std::vector<Instruction*> &kept) {
+    for (auto other : kept) {
+        if (other->getOperand(0) == check->getOperand(0) &&
+            other->getOperand(1) == check->getOperand(1) && dt->dominates(other, check))
+            return true;
+    }
+    return false;
+}
+
+void BoundsCheckElim::checkAccess(Instruction* inst) {
+    Value* base = inst->getOperand(0);
+    if (!isIdentifiedObject(base))
+        return;
+    long long size = base->getKind() == Value::GlobalVal
+        ? static_cast<GlobalVariable*>(base)->getSize()
+        : static_cast<Instruction*>(base)->getAllocSize();
+    Interval r = rangeAt(inst->getOperand(1), inst->getParent());
+    if (r.isEmpty() || (r.hi >= 0 && r.lo < size))
+        return;
+    diag << "warning: " << inst->getLine() << ":" << inst->getCol() << " : array index ";
+    if (r.lo == r.hi)
+        diag << r.lo;
+    else
+        diag << "in [" << r.lo << ", " << r.hi << "]";
+    diag << " is out of bounds for array of size " << size << "\n";
+    numWarnings++;
+}
+
+bool BoundsCheckElim::runOnFunction(Function* fn) {
+    DominatorTree tree(fn);
+    dt = &tree;
+    computeRanges();
+
+    // Dominator tree preorder sees a check before the ones it dominates
+    bool changed = false;
+    std::vector<Instruction*> kept;
+    for (auto bb : tree.getPreOrder()) {
+        std::vector<Instruction*> insts(bb->getInstructions().begin(), bb->getInstructions().end());
+        for (auto inst : insts) {
+            if (inst->getOpcode() == Instruction::LoadElem ||
+                inst->getOpcode() == Instruction::StoreElem) {
+                checkAccess(inst);
+                continue;
+            }
+            if (inst->getOpcode() != Instruction::BoundsCheck)
+                continue;
+            if (!removeChecks) {
+                numRemaining++;
+                continue;
+            }
+            Value* index = inst->getOperand(0);
+            Value* len = inst->getOperand(1);
+            Interval ri = rangeAt(index, bb);
+            Interval rl = rangeAt(len, bb);
+            bool inBounds = !ri.isEmpty() && ri.lo >= 0 &&
+                ((!rl.isEmpty() && ri.hi < rl.lo) || provesBelow(index, len, bb));
+            if (inBounds || isRedundant(inst, kept)) {
+                inst->eraseFromParent();
+                numRemoved++;
+                changed = true;
+                continue;
+            }
+            kept.push_back(inst);
+            numRemaining++;
+        }
+    }
+
+    dt = nullptr;
+    ranges.clear();
+    phiChanges.clear();
+    return changed;
+}
+
+} // namespace smallc
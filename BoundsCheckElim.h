@@ -0,0 +1,79 @@
+//
+//  BoundsCheckElim.h
+//  ECE467 Lab 3
+//
+//  Bounds check elimination by interval analysis. Every int value gets a
+//  range [lo, hi], computed over the CFG with widening at phis so loops
+//  converge, and narrowed where a dominating branch compared it with
+//  something (inside "while (i < 10)" the body sees i <= 9). A BoundsCheck
+//  goes when the index range lies inside [0, len), when a dominating
+//  branch established index < len for the very same length, or when an
+//  identical check dominates it.
+//
+//  Independently of the checks, an element access whose index range lies
+//  entirely outside a global or local array is reported as a warning; for
+//  a constant index that is a definite out-of-bounds access.
+//
+
+#ifndef BoundsCheckElim_h
+#define BoundsCheckElim_h
+
+#include <map>
+#include <ostream>
+#include <vector>
+
+#include "PassManager.h"
+#include "Dominators.h"
+
+namespace smallc {
+
+class BoundsCheckElim : public FunctionPass {
+private:
+    // A closed range of 32-bit values; lo > hi is the empty range of a
+    // value not computed yet
+    class Interval {
+    public:
+        long long lo;
+        long long hi;
+        Interval();
+        Interval(long long lo_, long long hi_);
+        static Interval full();
+        bool isEmpty() const;
+        bool operator==(const Interval &other) const;
+        bool operator!=(const Interval &other) const;
+        Interval join(const Interval &other) const;
+        Interval meet(const Interval &other) const;
+    };
+
+    std::ostream &diag;
+    bool removeChecks;              // Otherwise only diagnose
+    DominatorTree* dt;
+    std::map<Value*, Interval> ranges;
+    std::map<Instruction*, unsigned int> phiChanges;
+
+    unsigned int numRemoved;
+    unsigned int numRemaining;
+    unsigned int numWarnings;
+
+    static Interval fromCorners(long long a, long long b, long long c, long long d);
+    Interval baseRange(Value* v);
+    bool getEdgeCondition(BasicBlock* from, BasicBlock* to, Instruction* &cmp,
+                          Instruction::Predicate &pred);
+    Interval refine(Value* v, Interval r, BasicBlock* from, BasicBlock* to);
+    Interval rangeAt(Value* v, BasicBlock* bb);
+    Interval evaluate(Instruction* inst);
+    void computeRanges();
+    bool provesBelow(Value* index, Value* len, BasicBlock* bb);
+    bool isRedundant(Instruction* check, std::vector<Instruction*> &kept);
+    void checkAccess(Instruction* inst);
+
+public:
+    BoundsCheckElim(std::ostream &diag_, bool removeChecks_);
+    const char* getName() const override;
+    bool runOnFunction(Function* fn) override;
+    void printStatistics(std::ostream &out) override;
+};
+
+} // namespace smallc
+
+#endif /* BoundsCheckElim_h */
@@ -0,0 +1,242 @@
+//
+//  CallGraph.cpp
+//  ECE467 Lab 3
+//
+//  Call graph construction and Tarjan's strongly connected components.
+//
+
+#include <algorithm>
+
+#include "CallGraph.h"
+
+namespace smallc {
+
+/**********************************************************************************/
+/* The Node Class                                                                 */
+/**********************************************************************************/
+
+CallGraph::Node::Node(const std::string &name_)
+    : name(name_), decl(nullptr), fn(nullptr), callees(), numCallSites(0), scc(-1) {}
+
+bool CallGraph::Node::isDefined() const {
+    return decl != nullptr || fn != nullptr;
+}
+
+/**********************************************************************************/
+/* The CallGraph Class                                                            */
+/**********************************************************************************/
+
+CallGraph::CallGraph() : ASTVisitorBase(), current(nullptr) {}
+
+CallGraph::CallGraph(Module* m) : ASTVisitorBase(), current(nullptr) {
+    for (auto fn : m->getFunctions()) {
+        if (fn->getEntry())
+            getOrCreate(fn->getName())->fn = fn;
+    }
+    for (auto fn : m->getFunctions()) {
+        if (!fn->getEntry())
+            continue;
+        Node* caller = getNode(fn->getName());
+        for (auto bb : fn->getBlocks()) {
+            for (auto inst : bb->getInstructions()) {
+                Function* callee = inst->getOpcode() == Instruction::Call
+                    ? inst->getCalleeFunction() : nullptr;
+                if (callee && callee->getEntry())
+                    addCall(caller, getNode(callee->getName()));
+            }
+        }
+    }
+    computeSCCs();
+}
+
+CallGraph::~CallGraph() {
+    for (auto node : nodes)
+        delete node;
+}
+
+CallGraph::Node* CallGraph::getOrCreate(const std::string &name) {
+    auto it = byName.find(name);
+    if (it != byName.end())
+        return it->second;
+    Node* node = new Node(name);
+    nodes.push_back(node);
+    byName[name] = node;
+    return node;
+}
+
+void CallGraph::addCall(Node* caller, Node* callee) {
+    caller->numCallSites++;
+    if (std::find(caller->callees.begin(), caller->callees.end(), callee) == caller->callees.end())
+        caller->callees.push_back(callee);
+}
+
+const std::vector<CallGraph::Node*>& CallGraph::getNodes() { return nodes; }
+
+CallGraph::Node* CallGraph::getNode(const std::string &name) {
+    auto it = byName.find(name);
+    return it == byName.end() ? nullptr : it->second;
+}
+
+const std::vector<std::vector<CallGraph::Node*> >& CallGraph::getSCCs() { return sccs; }
+
+bool CallGraph::isRecursive(Node* node) {
+    if (node->scc < 0)
+        return false;
+    if (sccs[node->scc].size() > 1)
+        return true;
+    return std::find(node->callees.begin(), node->callees.end(), node) != node->callees.end();
+}
+
+std::set<std::string> CallGraph::getReachableFrom(const std::string &root) {
+    std::set<std::string> reached;
+    Node* start = getNode(root);
+    if (!start || !start->isDefined())
+        return reached;
+    std::vector<Node*> work(1, start);
+    reached.insert(root);
+    while (!work.empty()) {
+        Node* node = work.back();
+        work.pop_back();
+        for (auto callee : node->callees) {
+            if (reached.insert(callee->name).second)
+                work.push_back(callee);
+        }
+    }
+    return reached;
+}
+
+/**********************************************************************************/
+/* Strongly Connected Components                                                  */
+/**********************************************************************************/
+
+// Tarjan's algorithm with an explicit stack, since generated programs can
+// have call chains deeper than the native stack allows
+void CallGraph::computeSCCs() {
+    sccs.clear();
+    std::map<Node*, unsigned int> index;
+    std::map<Node*, unsigned int> lowlink;
+    std::set<Node*> onStack;
+    std::vector<Node*> stack;
+    unsigned int nextIndex = 0;
+
+    for (auto root : nodes) {
+        if (index.count(root))
+            continue;
+        // Each frame is a node and the position of the next callee to visit
+        std::vector<std::pair<Node*, unsigned int> > frames;
+        frames.push_back(std::make_pair(root, 0u));
+        index[root] = lowlink[root] = nextIndex++;
+        stack.push_back(root);
+        onStack.insert(root);
+        while (!frames.empty()) {
+            Node* node = frames.back().first;
+            unsigned int &next = frames.back().second;
+            if (next < node->callees.size()) {
+                Node* callee = node->callees[next++];
+                if (!index.count(callee)) {
+                    index[callee] = lowlink[callee] = nextIndex++;
+                    stack.push_back(callee);
+                    onStack.insert(callee);
+                    frames.push_back(std::make_pair(callee, 0u));
+                }
+                else if (onStack.count(callee))
+                    lowlink[node] = std::min(lowlink[node], index[callee]);
+                continue;
+            }
+            frames.pop_back();
+            if (!frames.empty()) {
+                Node* parent = frames.back().first;
+                lowlink[parent] = std::min(lowlink[parent], lowlink[node]);
+            }
+            if (lowlink[node] != index[node])
+                continue;
+            // node is the root of a component
+            std::vector<Node*> scc;
+            Node* member;
+            do {
+                member = stack.back();
+                stack.pop_back();
+                onStack.erase(member);
+                member->scc = (int)sccs.size();
+                scc.push_back(member);
+            } while (member != node);
+            sccs.push_back(scc);
+        }
+    }
+}
+
+/**********************************************************************************/
+/* Building from the AST                                                          */
+/**********************************************************************************/
+
+void CallGraph::visitProgramNode(ProgramNode *prg) {
+    ASTVisitorBase::visitProgramNode(prg);
+    computeSCCs();
+}
+
+void CallGraph::visitFunctionDeclNode(FunctionDeclNode *func) {
+    Node* node = getOrCreate(func->getIdent()->getName());
+    if (func->getProto() || func->getBody() == nullptr)
+        return;
+    node->decl = func;
+    current = node;
+    func->getBody()->visit(this);
+    current = nullptr;
+}
+
+void CallGraph::visitExprStmtNode(ExprStmtNode *expr) {
+    expr->getExpr()->visit(this);
+}
+
+void CallGraph::visitAssignStmtNode(AssignStmtNode *assign) {
+    assign->getTarget()->visit(this);
+    assign->getValue()->visit(this);
+}
+
+void CallGraph::visitIfStmtNode(IfStmtNode *ifStmt) {
+    ifStmt->getCondition()->visit(this);
+    ifStmt->getThen()->visit(this);
+    if (ifStmt->getHasElse())
+        ifStmt->getElse()->visit(this);
+}
+
+void CallGraph::visitWhileStmtNode(WhileStmtNode *whileStmt) {
+    whileStmt->getCondition()->visit(this);
+    whileStmt->getBody()->visit(this);
+}
+
+void CallGraph::visitReturnStmtNode(ReturnStmtNode *ret) {
+    if (ret->getReturn())
+        ret->getReturn()->visit(this);
+}
+
+void CallGraph::visitBinaryExprNode(BinaryExprNode *bin) {
+    bin->getLeft()->visit(this);
+    bin->getRight()->visit(this);
+}
+
+void CallGraph::visitUnaryExprNode(UnaryExprNode *unary) {
+    unary->getOperand()->visit(this);
+}
+
+void CallGraph::visitBoolExprNode(BoolExprNode *boolExpr) {
+    boolExpr->getValue()->visit(this);
+}
+
+void CallGraph::visitIntExprNode(IntExprNode *intExpr) {
+    intExpr->getValue()->visit(this);
+}
+
+void CallGraph::visitReferenceExprNode(ReferenceExprNode *ref) {
+    if (ref->getIndex())
+        ref->getIndex()->visit(this);
+}
+
+void CallGraph::visitCallExprNode(CallExprNode *call) {
+    if (current)
+        addCall(current, getOrCreate(call->getIdent()->getName()));
+    for (auto arg : call->getArguments())
+        arg->getExpr()->visit(this);
+}
+
+} // namespace smallc
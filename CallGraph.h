@@ -0,0 +1,91 @@
+//
+//  CallGraph.h
+//  ECE467 Lab 3
+//
+//  The call graph of a program: one node per function, an edge from each
+//  function to every function it calls. It can be built from the checked
+//  AST (one edge per CallExprNode) or from the IR, which changes as
+//  calls are inlined.
+//
+//  Recursive functions are grouped into strongly connected components
+//  with Tarjan's algorithm. Tarjan finds a component only after every
+//  component it calls, so the components come out bottom-up: callees
+//  before their callers, the order inlining and interprocedural analyses
+//  want.
+//
+
+#ifndef CallGraph_h
+#define CallGraph_h
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ASTNodes.h"
+#include "ASTVisitorBase.h"
+#include "IR.h"
+
+namespace smallc {
+
+class CallGraph : public ASTVisitorBase {
+public:
+    class Node {
+    public:
+        std::string name;
+        FunctionDeclNode* decl;         // Definition in the AST, if built from it
+        Function* fn;                   // Definition in the IR, if built from it
+        std::vector<Node*> callees;     // Each callee once
+        unsigned int numCallSites;      // Calls made, counting repeats
+        int scc;                        // Index into the bottom-up components
+
+        explicit Node(const std::string &name_);
+        // Is there a body, or is this a library function?
+        bool isDefined() const;
+    };
+
+private:
+    std::vector<Node*> nodes;                   // Owned, in definition order
+    std::map<std::string, Node*> byName;
+    std::vector<std::vector<Node*> > sccs;      // Bottom-up
+    Node* current;                              // Function being visited
+
+    Node* getOrCreate(const std::string &name);
+    void addCall(Node* caller, Node* callee);
+    void computeSCCs();
+
+public:
+    CallGraph();
+    // From the calls in the IR; only defined functions get nodes
+    explicit CallGraph(Module* m);
+    ~CallGraph();
+
+    // Building from the AST
+    void visitProgramNode(ProgramNode *prg) override;
+    void visitFunctionDeclNode(FunctionDeclNode *func) override;
+    void visitExprStmtNode(ExprStmtNode *expr) override;
+    void visitAssignStmtNode(AssignStmtNode *assign) override;
+    void visitIfStmtNode(IfStmtNode *ifStmt) override;
+    void visitWhileStmtNode(WhileStmtNode *whileStmt) override;
+    void visitReturnStmtNode(ReturnStmtNode *ret) override;
+    void visitBinaryExprNode(BinaryExprNode *bin) override;
+    void visitUnaryExprNode(UnaryExprNode *unary) override;
+    void visitBoolExprNode(BoolExprNode *boolExpr) override;
+    void visitIntExprNode(IntExprNode *intExpr) override;
+    void visitReferenceExprNode(ReferenceExprNode *ref) override;
+    void visitCallExprNode(CallExprNode *call) override;
+
+    const std::vector<Node*>& getNodes();
+    Node* getNode(const std::string &name);
+    // Strongly connected components, callees before callers
+    const std::vector<std::vector<Node*> >& getSCCs();
+    // Does the function call itself, directly or through others?
+    bool isRecursive(Node* node);
+    // Names of the functions callable from root, root included; empty if
+    // root is not defined
+    std::set<std::string> getReachableFrom(const std::string &root);
+};
+
+} // namespace smallc
+
+#endif /* CallGraph_h */
@@ -0,0 +1,352 @@
+//
+//  CodeGen.cpp
+//  ECE467 Lab 3
+//
+//  Selects machine IR for an SSA IR module.
+//
+
+#include "CodeGen.h"
+
+namespace smallc {
+
+CodeGen::CodeGen() : module(new MachineModule()), mf(nullptr), curBlock(-1), nextXReg(0) {}
+
+CodeGen::~CodeGen() {
+    delete module;
+}
+
+MachineModule* CodeGen::releaseModule() {
+    MachineModule* m = module;
+    module = nullptr;
+    return m;
+}
+
+std::string CodeGen::functionSymbol(const std::string &name) {
+    // Prefix user functions so they cannot clash with libc; main is the entry
+    return name == "main" ? name : "sc_" + name;
+}
+
+std::string CodeGen::globalSymbol(const std::string &name) {
+    return "scv_" + name;
+}
+
+/**********************************************************************************/
+/* Helpers                                                                        */
+/**********************************************************************************/
+
+MachineInstr& CodeGen::emit(MachineInstr mi) {
+    mf->blocks[curBlock].instrs.push_back(mi);
+    return mf->blocks[curBlock].instrs.back();
+}
+
+MachineOperand CodeGen::operand(Value* v) {
+    if (v->getKind() == Value::ConstantVal)
+        return MachineOperand::imm(static_cast<Constant*>(v)->getVal());
+    if (v->getKind() == Value::GlobalVal) {
+        // Addresses are cheap to rematerialize at each use
+        MachineInstr mi(MachineInstr::AddrGlobal);
+        mi.def = MachineOperand::vreg(mf->newVReg(true));
+        mi.sym = globalSymbol(static_cast<GlobalVariable*>(v)->getName());
+        return emit(mi).def;
+    }
+    if (v->getKind() == Value::InstructionVal) {
+        auto alloca = frameIdx.find(static_cast<Instruction*>(v));
+        if (alloca != frameIdx.end()) {
+            MachineInstr mi(MachineInstr::AddrFrame);
+            mi.def = MachineOperand::vreg(mf->newVReg(true));
+            mi.frameIdx = alloca->second;
+            return emit(mi).def;
+        }
+        if (v->getType() == Value::Vec)
+            return MachineOperand::xreg(xregs[static_cast<Instruction*>(v)]);
+    }
+    return MachineOperand::vreg(vregs[v]);
+}
+
+MachineOperand CodeGen::defOf(Instruction* inst) {
+    // A vector value lives within its block; each gets its own register
+    if (inst->getType() == Value::Vec) {
+        xregs[inst] = nextXReg++;
+        return MachineOperand::xreg(xregs[inst]);
+    }
+    return MachineOperand::vreg(vregs[inst]);
+}
+
+static MachineInstr::CondCode condCode(Instruction::Predicate pred) {
+    switch (pred) {
+        case Instruction::EQ: return MachineInstr::EQ;
+        case Instruction::NE: return MachineInstr::NE;
+        case Instruction::LT: return MachineInstr::LT;
+        case Instruction::LE: return MachineInstr::LE;
+        case Instruction::GT: return MachineInstr::GT;
+        default:              return MachineInstr::GE;
+    }
+}
+
+// Copy the values flowing out of bb into the temporaries of the phis of
+// its successors
+void CodeGen::emitPhiCopies(BasicBlock* bb) {
+    for (auto succ : bb->getSuccessors()) {
+        for (auto phi : succ->getPhis()) {
+            MachineInstr copy(MachineInstr::Copy);
+            copy.def = MachineOperand::vreg(phiTemps[phi]);
+            copy.uses.push_back(operand(phi->getIncomingValueFor(bb)));
+            emit(copy);
+        }
+    }
+}
+
+/**********************************************************************************/
+/* Selection                                                                      */
+/**********************************************************************************/
+
+void CodeGen::run(Module* m) {
+    for (auto global : m->getGlobals()) {
+        int elems = global->isArray() ? global->getSize() : 1;
+        module->globals.push_back(MachineGlobal(globalSymbol(global->getName()), elems * 4));
+    }
+    module->profileKeys = m->getProfileKeys();
+    for (auto fn : m->getFunctions()) {
+        if (fn->getEntry())
+            selectFunction(fn);
+    }
+}
+
+void CodeGen::selectFunction(Function* fn) {
+    mf = new MachineFunction(functionSymbol(fn->getName()));
+    module->functions.push_back(mf);
+
+    for (auto arg : fn->getArgs()) {
+        vregs[arg] = mf->newVReg(arg->getType() == Value::Ptr);
+        mf->args.push_back(vregs[arg]);
+    }
+
+    // Number blocks in layout order and give every value a register up front,
+    // since phis may refer to values defined later in the layout
+    for (auto bb : fn->getBlocks())
+        blockIds[bb] = mf->newBlock(bb->getName());
+    for (auto bb : fn->getBlocks()) {
+        for (auto inst : bb->getInstructions()) {
+            if (inst->getOpcode() == Instruction::Alloca) {
+                frameIdx[inst] = mf->newFrameObject(inst->getAllocSize() * 4);
+                continue;
+            }
+            if (inst->getOpcode() == Instruction::Cmp && inst->getNumUses() == 1) {
+                Instruction* user = inst->getUsers()[0];
+                if (user->getOpcode() == Instruction::CondBr && user->getParent() == bb) {
+                    fusedCmps.insert(inst);
+                    continue;
+                }
+            }
+            if (inst->getType() != Value::Void && inst->getType() != Value::Vec)
+                vregs[inst] = mf->newVReg(inst->getType() == Value::Ptr);
+            if (inst->getOpcode() == Instruction::Phi)
+                phiTemps[inst] = mf->newVReg(inst->getType() == Value::Ptr);
+        }
+    }
+
+    for (auto bb : fn->getBlocks()) {
+        curBlock = blockIds[bb];
+        nextXReg = 0;
+        for (auto inst : bb->getInstructions()) {
+            if (inst->isTerminator())
+                emitPhiCopies(bb);
+            selectInstruction(inst);
+        }
+    }
+
+    mf = nullptr;
+    vregs.clear();
+    blockIds.clear();
+    frameIdx.clear();
+    phiTemps.clear();
+    fusedCmps.clear();
+    xregs.clear();
+}
+
+void CodeGen::selectInstruction(Instruction* inst) {
+    if (fusedCmps.count(inst))
+        return;
+
+    switch (inst->getOpcode()) {
+        case Instruction::Add:
+        case Instruction::Sub:
+        case Instruction::Mul:
+        case Instruction::Div:
+        case Instruction::Cmp: {
+            if (inst->getType() == Value::Vec) {
+                selectVector(inst);
+                break;
+            }
+            static const MachineInstr::Opcode ops[] = {
+                MachineInstr::Add, MachineInstr::Sub, MachineInstr::Mul, MachineInstr::Div
+            };
+            bool isCmp = inst->getOpcode() == Instruction::Cmp;
+            MachineInstr mi(isCmp ? MachineInstr::SetCC : ops[inst->getOpcode() - Instruction::Add]);
+            if (isCmp)
+                mi.cc = condCode(inst->getPredicate());
+            mi.uses.push_back(operand(inst->getOperand(0)));
+            mi.uses.push_back(operand(inst->getOperand(1)));
+            mi.def = defOf(inst);
+            emit(mi);
+            break;
+        }
+        case Instruction::Neg:
+        case Instruction::Not: {
+            if (inst->getType() == Value::Vec) {
+                selectVector(inst);
+                break;
+            }
+            MachineInstr mi(inst->getOpcode() == Instruction::Not ? MachineInstr::Not : MachineInstr::Neg);
+            mi.uses.push_back(operand(inst->getOperand(0)));
+            mi.def = defOf(inst);
+            emit(mi);
+            break;
+        }
+        case Instruction::Phi: {
+            MachineInstr copy(MachineInstr::Copy);
+            copy.def = defOf(inst);
+            copy.uses.push_back(MachineOperand::vreg(phiTemps[inst]));
+            emit(copy);
+            break;
+        }
+        case Instruction::Call: {
+            MachineInstr mi(MachineInstr::Call);
+            mi.sym = functionSymbol(inst->getCallee());
+            for (unsigned int i = 0; i < inst->getNumOperands(); i++)
+                mi.uses.push_back(operand(inst->getOperand(i)));
+            if (inst->getType() != Value::Void)
+                mi.def = defOf(inst);
+            emit(mi);
+            break;
+        }
+        case Instruction::Load:
+        case Instruction::Store: {
+            Value* addr = inst->getOperand(0);
+            bool isStore = inst->getOpcode() == Instruction::Store;
+            if (addr->getKind() == Value::GlobalVal) {
+                MachineInstr mi(isStore ? MachineInstr::StoreGlobal : MachineInstr::LoadGlobal);
+                mi.sym = globalSymbol(static_cast<GlobalVariable*>(addr)->getName());
+                if (isStore)
+                    mi.uses.push_back(operand(inst->getOperand(1)));
+                else
+                    mi.def = defOf(inst);
+                emit(mi);
+                break;
+            }
+            // Any other pointer is element 0 of an array
+            MachineInstr mi(isStore ? MachineInstr::StoreElem : MachineInstr::LoadElem);
+            mi.uses.push_back(operand(addr));
+            mi.uses.push_back(MachineOperand::imm(0));
+            if (isStore)
+                mi.uses.push_back(operand(inst->getOperand(1)));
+            else
+                mi.def = defOf(inst);
+            emit(mi);
+            break;
+        }
+        case Instruction::LoadElem: {
+            MachineInstr mi(MachineInstr::LoadElem);
+            mi.uses.push_back(operand(inst->getOperand(0)));
+            mi.uses.push_back(operand(inst->getOperand(1)));
+            mi.def = defOf(inst);
+            emit(mi);
+            break;
+        }
+        case Instruction::StoreElem: {
+            MachineInstr mi(MachineInstr::StoreElem);
+            for (unsigned int i = 0; i < 3; i++)
+                mi.uses.push_back(operand(inst->getOperand(i)));
+            emit(mi);
+            break;
+        }
+        case Instruction::BoundsCheck: {
+            MachineInstr mi(MachineInstr::BoundsCheck);
+            mi.uses.push_back(operand(inst->getOperand(0)));
+            mi.uses.push_back(operand(inst->getOperand(1)));
+            mi.line = inst->getLine();
+            emit(mi);
+            break;
+        }
+        case Instruction::VecLoad:
+        case Instruction::VecStore:
+        case Instruction::Splat:
+        case Instruction::VecIndex:
+        case Instruction::VecEnd:
+            selectVector(inst);
+            break;
+        case Instruction::HasAVX2: {
+            // Set by the runtime before main
+            MachineInstr mi(MachineInstr::LoadGlobal);
+            mi.sym = "scrt_has_avx2";
+            mi.def = defOf(inst);
+            emit(mi);
+            break;
+        }
+        case Instruction::ProfileCount: {
+            MachineInstr mi(MachineInstr::ProfileInc);
+            mi.uses.push_back(operand(inst->getOperand(0)));
+            emit(mi);
+            break;
+        }
+        case Instruction::Alloca:
+            break;
+        case Instruction::Br: {
+            MachineInstr mi(MachineInstr::Jmp);
+            mi.target[0] = blockIds[inst->getBlockOperand(0)];
+            emit(mi);
+            break;
+        }
+        case Instruction::CondBr: {
+            MachineInstr mi(MachineInstr::CmpBr);
+            Value* cond = inst->getOperand(0);
+            Instruction* cmp = static_cast<Instruction*>(cond);
+            if (cond->getKind() == Value::InstructionVal && fusedCmps.count(cmp)) {
+                mi.cc = condCode(cmp->getPredicate());
+                mi.uses.push_back(operand(cmp->getOperand(0)));
+                mi.uses.push_back(operand(cmp->getOperand(1)));
+            }
+            else {
+                mi.cc = MachineInstr::NE;
+                mi.uses.push_back(operand(cond));
+                mi.uses.push_back(MachineOperand::imm(0));
+            }
+            mi.target[0] = blockIds[inst->getBlockOperand(0)];
+            mi.target[1] = blockIds[inst->getBlockOperand(1)];
+            emit(mi);
+            break;
+        }
+        case Instruction::Ret: {
+            MachineInstr mi(MachineInstr::Ret);
+            if (inst->getNumOperands() > 0)
+                mi.uses.push_back(operand(inst->getOperand(0)));
+            else if (mf->name == "main")
+                mi.uses.push_back(MachineOperand::imm(0));
+            emit(mi);
+            break;
+        }
+    }
+}
+
+void CodeGen::selectVector(Instruction* inst) {
+    MachineInstr mi(MachineInstr::VecLoad);
+    switch (inst->getOpcode()) {
+        case Instruction::VecLoad:  mi.op = MachineInstr::VecLoad; break;
+        case Instruction::VecStore: mi.op = MachineInstr::VecStore; break;
+        case Instruction::Splat:    mi.op = MachineInstr::VecSplat; break;
+        case Instruction::VecIndex: mi.op = MachineInstr::VecIndex; break;
+        case Instruction::VecEnd:   mi.op = MachineInstr::VecEnd; break;
+        case Instruction::Add:      mi.op = MachineInstr::VecAdd; break;
+        case Instruction::Sub:      mi.op = MachineInstr::VecSub; break;
+        case Instruction::Mul:      mi.op = MachineInstr::VecMul; break;
+        default:                    mi.op = MachineInstr::VecNeg; break;
+    }
+    mi.lanes = inst->getLanes();
+    for (unsigned int i = 0; i < inst->getNumOperands(); i++)
+        mi.uses.push_back(operand(inst->getOperand(i)));
+    if (inst->getType() == Value::Vec)
+        mi.def = defOf(inst);
+    emit(mi);
+}
+
+} // namespace smallc
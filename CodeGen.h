@@ -0,0 +1,65 @@
+//
+//  CodeGen.h
+//  ECE467 Lab 3
+//
+//  Instruction selection: lowers the SSA IR in IR.h to the machine-level
+//  representation in MachineIR.h. Every SSA value gets a virtual register;
+//  local arrays get a frame object and globals are accessed through their
+//  symbols. Phis are eliminated by copying each incoming value into a
+//  per-phi temporary at the end of the predecessor and from the temporary
+//  into the phi's register at the top of its block, which is correct on
+//  critical edges and for phis that read each other. Vector values never
+//  leave their block, so they are given vector registers right here in
+//  order of definition; the vectorizer keeps their number within reach.
+//
+
+#ifndef CodeGen_h
+#define CodeGen_h
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "IR.h"
+#include "MachineIR.h"
+
+namespace smallc {
+
+class CodeGen {
+private:
+    MachineModule* module;
+    MachineFunction* mf;                    // Function being selected
+    int curBlock;                           // Block being filled
+    std::map<Value*, int> vregs;            // SSA value -> virtual register
+    std::map<BasicBlock*, int> blockIds;
+    std::map<Instruction*, int> frameIdx;   // Alloca -> frame object
+    std::map<Instruction*, int> phiTemps;   // Phi -> incoming copy register
+    std::set<Instruction*> fusedCmps;       // Compares folded into their branch
+    std::map<Instruction*, int> xregs;      // Vector value -> vector register
+    int nextXReg;                           // Next free vector register in the block
+
+    MachineInstr& emit(MachineInstr mi);
+    MachineOperand operand(Value* v);
+    MachineOperand defOf(Instruction* inst);
+    void selectFunction(Function* fn);
+    void selectInstruction(Instruction* inst);
+    void selectVector(Instruction* inst);
+    void emitPhiCopies(BasicBlock* bb);
+
+public:
+    CodeGen();
+    ~CodeGen();
+
+    void run(Module* m);
+
+    // Hand the generated module to the caller
+    MachineModule* releaseModule();
+
+    // Map smallC names to assembler symbols
+    static std::string functionSymbol(const std::string &name);
+    static std::string globalSymbol(const std::string &name);
+};
+
+} // namespace smallc
+
+#endif /* CodeGen_h */
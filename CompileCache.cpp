@@ -0,0 +1,327 @@
+//
+//  CompileCache.cpp
+//  ECE467 Lab 3
+//
+//  On-disk cache of checking results.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <dirent.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "CompileCache.h"
+#include "Hash.h"
+
+namespace smallc {
+
+namespace {
+
+const uint32_t EntryMagic = 0x45434353;    // "SCCE" in little endian
+const uint32_t EntryVersion = 1;
+
+class EntryHeader {
+public:
+    uint32_t magic;
+    uint32_t version;
+    int32_t status;
+    uint32_t reserved;
+    uint64_t outBytes;
+    uint64_t errBytes;
+    uint64_t astBytes;
+    char checksum[32];      // Hash of the three parts
+};
+
+std::string checksum(const CompileCache::Entry &entry) {
+    Hasher hasher;
+    hasher.addField(entry.out);
+    hasher.addField(entry.err);
+    hasher.addField(entry.ast);
+    return hasher.hex();
+}
+
+bool isKey(const char* name) {
+    size_t length = 0;
+    for (; name[length]; length++) {
+        if (!isxdigit((unsigned char)name[length]))
+            return false;
+    }
+    return length == 32;
+}
+
+// Finds the NT_GNU_BUILD_ID note of the main program, the first object
+// dl_iterate_phdr reports
+int findBuildID(struct dl_phdr_info* info, size_t, void* data) {
+    std::string &id = *(std::string*)data;
+    for (int i = 0; i < info->dlpi_phnum && id.empty(); i++) {
+        const ElfW(Phdr) &phdr = info->dlpi_phdr[i];
+        if (phdr.p_type != PT_NOTE)
+            continue;
+        const char* note = (const char*)(info->dlpi_addr + phdr.p_vaddr);
+        const char* end = note + phdr.p_memsz;
+        while (note + sizeof(ElfW(Nhdr)) <= end) {
+            const ElfW(Nhdr)* header = (const ElfW(Nhdr)*)note;
+            const char* name = note + sizeof(ElfW(Nhdr));
+            const unsigned char* desc = (const unsigned char*)(name + ((header->n_namesz + 3) & ~3u));
+            if (header->n_type == NT_GNU_BUILD_ID && header->n_namesz == 4 && std::memcmp(name, "GNU", 4) == 0) {
+                static const char digits[] = "0123456789abcdef";
+                for (unsigned int b = 0; b < header->n_descsz; b++) {
+                    id += digits[desc[b] >> 4];
+                    id += digits[desc[b] & 0xf];
+                }
+                break;
+            }
+            note = (const char*)desc + ((header->n_descsz + 3) & ~3u);
+        }
+    }
+    return 1;
+}
+
+} // namespace
+
+/**********************************************************************************/
+/* Output Capture                                                                 */
+/**********************************************************************************/
+
+CompileCache::TeeBuf::TeeBuf(std::streambuf* target_) : target(target_), copy() {}
+
+int CompileCache::TeeBuf::overflow(int c) {
+    if (c == traits_type::eof())
+        return traits_type::not_eof(c);
+    copy += (char)c;
+    return target->sputc((char)c);
+}
+
+std::streamsize CompileCache::TeeBuf::xsputn(const char* s, std::streamsize n) {
+    copy.append(s, n);
+    return target->sputn(s, n);
+}
+
+int CompileCache::TeeBuf::sync() {
+    return target->pubsync();
+}
+
+void CompileCache::startCapture() {
+    outTee = new TeeBuf(std::cout.rdbuf());
+    errTee = new TeeBuf(std::cerr.rdbuf());
+    std::cout.rdbuf(outTee);
+    std::cerr.rdbuf(errTee);
+}
+
+void CompileCache::stopCapture(Entry &entry) {
+    if (!outTee)
+        return;
+    std::cout.flush();
+    std::cerr.flush();
+    std::cout.rdbuf(outTee->target);
+    std::cerr.rdbuf(errTee->target);
+    entry.out = outTee->copy;
+    entry.err = errTee->copy;
+    delete outTee;
+    delete errTee;
+    outTee = nullptr;
+    errTee = nullptr;
+}
+
+/**********************************************************************************/
+/* The CompileCache Class                                                         */
+/**********************************************************************************/
+
+CompileCache::CompileCache(const std::string &dir_, unsigned long long maxBytes_)
+    : dir(dir_), maxBytes(maxBytes_), error(), outTee(nullptr), errTee(nullptr) {}
+
+CompileCache::~CompileCache() {
+    Entry discarded;
+    stopCapture(discarded);
+}
+
+bool CompileCache::fail(const std::string &message) {
+    error = message;
+    return false;
+}
+
+const std::string &CompileCache::getError() {
+    return error;
+}
+
+bool CompileCache::open() {
+    if (mkdir(dir.c_str(), 0777) != 0 && errno != EEXIST)
+        return fail(dir + ": " + std::strerror(errno));
+    struct stat st;
+    if (stat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+        return fail(dir + ": not a directory");
+    return true;
+}
+
+std::string CompileCache::entryPath(const std::string &key) {
+    return dir + "/" + key;
+}
+
+std::string CompileCache::buildID() {
+    static std::string id;
+    if (!id.empty())
+        return id;
+    dl_iterate_phdr(findBuildID, &id);
+    if (!id.empty())
+        return id;
+
+    Hasher hasher;
+    std::ifstream exe("/proc/self/exe", std::ios::binary);
+    char buffer[1 << 16];
+    while (exe.read(buffer, sizeof(buffer)) || exe.gcount() > 0)
+        hasher.update(buffer, exe.gcount());
+    id = "exe-" + hasher.hex();
+    return id;
+}
+
+std::string CompileCache::makeKey(const std::string &source, const std::string &options) {
+    Hasher hasher;
+    hasher.addField(buildID());
+    hasher.addField(options);
+    hasher.addField(source);
+    return hasher.hex();
+}
+
+/**********************************************************************************/
+/* Lookup and Store                                                               */
+/**********************************************************************************/
+
+bool CompileCache::lookup(const std::string &key, Entry &entry) {
+    std::string path = entryPath(key);
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    EntryHeader header;
+    bool valid = data.size() >= sizeof(header);
+    if (valid) {
+        std::memcpy(&header, data.data(), sizeof(header));
+        valid = header.magic == EntryMagic && header.version == EntryVersion &&
+                data.size() == sizeof(header) + header.outBytes + header.errBytes + header.astBytes;
+    }
+    if (valid) {
+        size_t offset = sizeof(header);
+        entry.status = header.status;
+        entry.out = data.substr(offset, header.outBytes);
+        offset += header.outBytes;
+        entry.err = data.substr(offset, header.errBytes);
+        offset += header.errBytes;
+        entry.ast = data.substr(offset, header.astBytes);
+        valid = checksum(entry).compare(0, 32, header.checksum, 32) == 0;
+    }
+    if (!valid) {
+        unlink(path.c_str());
+        return false;
+    }
+
+    // The modification time is the entry's last use
+    utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+    return true;
+}
+
+bool CompileCache::store(const std::string &key, const Entry &entry) {
+    EntryHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = EntryMagic;
+    header.version = EntryVersion;
+    header.status = entry.status;
+    header.outBytes = entry.out.size();
+    header.errBytes = entry.err.size();
+    header.astBytes = entry.ast.size();
+    std::memcpy(header.checksum, checksum(entry).data(), 32);
+
+    std::string path = entryPath(key);
+    std::string temp = dir + "/.tmp-" + key + "-" + std::to_string(getpid());
+    {
+        std::ofstream out(temp, std::ios::binary);
+        out.write((const char*)&header, sizeof(header));
+        out << entry.out << entry.err << entry.ast;
+        out.close();
+        if (out.fail()) {
+            unlink(temp.c_str());
+            return fail(temp + ": cannot write the cache entry");
+        }
+    }
+    if (rename(temp.c_str(), path.c_str()) != 0) {
+        unlink(temp.c_str());
+        return fail(path + ": " + std::strerror(errno));
+    }
+    evict();
+    return true;
+}
+
+// Another compiler already evicting will leave the cache under the limit,
+// so this one does not wait for it. Entries may vanish between listing
+// and removal; readers still holding one open keep their copy.
+void CompileCache::evict() {
+    std::string lockPath = dir + "/lock";
+    int lock = ::open(lockPath.c_str(), O_RDWR | O_CREAT, 0666);
+    if (lock < 0)
+        return;
+    if (flock(lock, LOCK_EX | LOCK_NB) != 0) {
+        close(lock);
+        return;
+    }
+
+    class File {
+    public:
+        std::string path;
+        unsigned long long bytes;
+        struct timespec used;
+    };
+    std::vector<File> files;
+    unsigned long long total = 0;
+    time_t now = time(nullptr);
+    if (DIR* entries = opendir(dir.c_str())) {
+        while (struct dirent* ent = readdir(entries)) {
+            File file;
+            file.path = dir + "/" + ent->d_name;
+            struct stat st;
+            if (stat(file.path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+                continue;
+            // Left behind by a compiler that died while storing
+            if (std::strncmp(ent->d_name, ".tmp-", 5) == 0) {
+                if (now - st.st_mtime > 3600)
+                    unlink(file.path.c_str());
+                continue;
+            }
+            if (!isKey(ent->d_name))
+                continue;
+            file.bytes = st.st_size;
+            file.used = st.st_mtim;
+            total += file.bytes;
+            files.push_back(file);
+        }
+        closedir(entries);
+    }
+
+    if (total > maxBytes) {
+        std::sort(files.begin(), files.end(), [](const File &a, const File &b) {
+            if (a.used.tv_sec != b.used.tv_sec)
+                return a.used.tv_sec < b.used.tv_sec;
+            return a.used.tv_nsec < b.used.tv_nsec;
+        });
+        for (size_t i = 0; i < files.size() && total > maxBytes; i++) {
+            if (unlink(files[i].path.c_str()) == 0)
+                total -= files[i].bytes;
+        }
+    }
+    flock(lock, LOCK_UN);
+    close(lock);
+}
+
+} // namespace smallc
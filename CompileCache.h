@@ -0,0 +1,86 @@
+//
+//  CompileCache.h
+//  ECE467 Lab 3
+//
+//  On-disk cache of checking results for --cache-dir. The key is a hash
+//  of the source, the compiler's build ID and the options that change
+//  the results. An entry holds what the check printed to stdout and
+//  stderr, its exit status and, if --emit-ast asked for it, the AST
+//  file, so a hit replays them without lexing, parsing or analyzing.
+//
+//  Every entry is a file named by its key. Writers write a temporary
+//  file and rename it into place, so concurrent compilers see a whole
+//  entry or none; a reader that finds a damaged one, by its length or
+//  checksum, treats it as a miss and removes it. A hit touches the entry,
+//  so its modification time is its last use. When a store takes the
+//  cache over its size limit, the least recently used entries are
+//  removed, by one compiler at a time under a lock file.
+//
+
+#ifndef CompileCache_h
+#define CompileCache_h
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+namespace smallc {
+
+class CompileCache {
+public:
+    class Entry {
+    public:
+        int status;
+        std::string out;        // What went to stdout
+        std::string err;        // What went to stderr
+        std::string ast;        // The --emit-ast file, or empty
+    };
+
+private:
+    // Passes output on to a stream's buffer and keeps a copy
+    class TeeBuf : public std::streambuf {
+    public:
+        std::streambuf* target;
+        std::string copy;
+
+        explicit TeeBuf(std::streambuf* target_);
+        int overflow(int c) override;
+        std::streamsize xsputn(const char* s, std::streamsize n) override;
+        int sync() override;
+    };
+
+    std::string dir;
+    unsigned long long maxBytes;
+    std::string error;
+    TeeBuf* outTee;
+    TeeBuf* errTee;
+
+    std::string entryPath(const std::string &key);
+    bool fail(const std::string &message);
+    void evict();
+
+public:
+    CompileCache(const std::string &dir_, unsigned long long maxBytes_);
+    ~CompileCache();
+
+    // Creates the directory if need be
+    bool open();
+    const std::string &getError();
+
+    // Identifies the compiler binary: its GNU build ID, or a hash of the
+    // executable if it was linked without one
+    static std::string buildID();
+
+    std::string makeKey(const std::string &source, const std::string &options);
+
+    bool lookup(const std::string &key, Entry &entry);
+    bool store(const std::string &key, const Entry &entry);
+
+    // Copies everything written to std::cout and std::cerr in between
+    void startCapture();
+    void stopCapture(Entry &entry);
+};
+
+} // namespace smallc
+
+#endif /* CompileCache_h */
@@ -0,0 +1,178 @@
+//
+//  DeadCodeElim.cpp
+//  ECE467 Lab 3
+//
+//  Dead instruction removal and CFG cleanup.
+//
+
+#include <set>
+#include <vector>
+
+#include "DeadCodeElim.h"
+
+namespace smallc {
+
+DeadCodeElim::DeadCodeElim() : numInsts(0), numBlocks(0) {}
+
+const char* DeadCodeElim::getName() const { return "dce"; }
+
+void DeadCodeElim::printStatistics(std::ostream &out) {
+    out << "dce: " << numInsts << " dead instructions removed, "
+        << numBlocks << " blocks merged or bypassed\n";
+}
+
+// Instructions that must stay even if their result is unused
+static bool isRoot(Instruction* inst) {
+    if (inst->getOpcode() == Instruction::Div) {
+        // Only a known divisor other than 0 and -1 cannot trap
+        Value* divisor = inst->getOperand(1);
+        if (divisor->getKind() != Value::ConstantVal)
+            return true;
+        int val = static_cast<Constant*>(divisor)->getVal();
+        return val == 0 || val == -1;
+    }
+    return inst->hasSideEffects();
+}
+
+bool DeadCodeElim::removeDeadInstructions(Function* fn) {
+    std::set<Instruction*> live;
+    std::vector<Instruction*> work;
+    for (auto bb : fn->getBlocks()) {
+        for (auto inst : bb->getInstructions()) {
+            if (isRoot(inst) && live.insert(inst).second)
+                work.push_back(inst);
+        }
+    }
+    while (!work.empty()) {
+        Instruction* inst = work.back();
+        work.pop_back();
+        for (unsigned int i = 0; i < inst->getNumOperands(); i++) {
+            Value* op = inst->getOperand(i);
+            if (op->getKind() != Value::InstructionVal)
+                continue;
+            Instruction* def = static_cast<Instruction*>(op);
+            if (live.insert(def).second)
+                work.push_back(def);
+        }
+    }
+
+    std::vector<Instruction*> dead;
+    for (auto bb : fn->getBlocks()) {
+        for (auto inst : bb->getInstructions()) {
+            if (!live.count(inst))
+                dead.push_back(inst);
+        }
+    }
+    // Dead values may use each other, so unlink them all before deleting
+    for (auto inst : dead)
+        inst->dropAllOperands();
+    for (auto inst : dead)
+        inst->eraseFromParent();
+    numInsts += (unsigned int)dead.size();
+    return !dead.empty();
+}
+
+// Redirect the predecessors of a block holding nothing but "br S" to S
+bool DeadCodeElim::bypassEmptyBlock(Function* fn, BasicBlock* bb) {
+    if (bb == fn->getEntry() || bb->getInstructions().size() != 1)
+        return false;
+    Instruction* term = bb->getTerminator();
+    if (term->getOpcode() != Instruction::Br)
+        return false;
+    BasicBlock* succ = term->getBlockOperand(0);
+    std::vector<BasicBlock*> preds = bb->getPredecessors();
+    if (succ == bb || preds.empty())
+        return false;
+
+    std::vector<Instruction*> phis = succ->getPhis();
+    if (!phis.empty()) {
+        // A predecessor already jumping to succ would need two phi entries
+        std::vector<BasicBlock*> &succPreds = succ->getPredecessors();
+        for (auto pred : preds) {
+            for (auto other : succPreds) {
+                if (other == pred)
+                    return false;
+            }
+        }
+    }
+    for (auto phi : phis) {
+        Value* v = phi->getIncomingValueFor(bb);
+        phi->removeIncoming(bb);
+        for (auto pred : preds)
+            phi->addIncoming(v, pred);
+    }
+
+    for (auto pred : preds) {
+        Instruction* predTerm = pred->getTerminator();
+        for (unsigned int i = 0; i < predTerm->getNumBlockOperands(); i++) {
+            if (predTerm->getBlockOperand(i) == bb)
+                predTerm->setBlockOperand(i, succ);
+        }
+        if (predTerm->getOpcode() == Instruction::CondBr &&
+            predTerm->getBlockOperand(0) == predTerm->getBlockOperand(1)) {
+            Instruction* br = new Instruction(Instruction::Br, Value::Void);
+            br->addBlockOperand(succ);
+            br->setLocation(predTerm->getLocation());
+            pred->insertBefore(predTerm, br);
+            predTerm->eraseFromParent();
+        }
+    }
+    fn->removeBlock(bb);
+    fn->recomputePredecessors();
+    return true;
+}
+
+// Append a block to its only predecessor when it is that block's only successor
+bool DeadCodeElim::mergeIntoPredecessor(Function* fn, BasicBlock* bb) {
+    if (bb == fn->getEntry() || bb->getPredecessors().size() != 1)
+        return false;
+    BasicBlock* pred = bb->getPredecessors()[0];
+    Instruction* predTerm = pred->getTerminator();
+    if (pred == bb || predTerm->getOpcode() != Instruction::Br)
+        return false;
+
+    for (auto phi : bb->getPhis()) {
+        phi->replaceAllUsesWith(phi->getOperand(0));
+        phi->eraseFromParent();
+    }
+    predTerm->eraseFromParent();
+    std::vector<Instruction*> insts(bb->getInstructions().begin(), bb->getInstructions().end());
+    for (auto inst : insts) {
+        bb->remove(inst);
+        pred->append(inst);
+    }
+    for (auto succ : pred->getSuccessors()) {
+        for (auto phi : succ->getPhis())
+            phi->replaceIncomingBlock(bb, pred);
+    }
+    fn->removeBlock(bb);
+    fn->recomputePredecessors();
+    return true;
+}
+
+bool DeadCodeElim::simplifyCFG(Function* fn) {
+    bool changed = false;
+    bool progress = true;
+    fn->recomputePredecessors();
+    while (progress) {
+        progress = false;
+        std::vector<BasicBlock*> blocks = fn->getBlocks();
+        for (auto bb : blocks) {
+            if (mergeIntoPredecessor(fn, bb) || bypassEmptyBlock(fn, bb)) {
+                numBlocks++;
+                progress = true;
+                break;
+            }
+        }
+        changed |= progress;
+    }
+    return changed;
+}
+
+bool DeadCodeElim::runOnFunction(Function* fn) {
+    bool changed = removeDeadInstructions(fn);
+    changed |= simplifyCFG(fn);
+    return changed;
+}
+
+} // namespace smallc
@@ -0,0 +1,38 @@
+//
+//  DeadCodeElim.h
+//  ECE467 Lab 3
+//
+//  Dead code elimination. Instructions are assumed dead unless they have
+//  side effects or feed something live (mark and sweep, so dead phi
+//  cycles go too). The CFG is then tidied up: blocks that only jump on
+//  are bypassed and a block is merged into its predecessor when it is
+//  that predecessor's only successor.
+//
+
+#ifndef DeadCodeElim_h
+#define DeadCodeElim_h
+
+#include "PassManager.h"
+
+namespace smallc {
+
+class DeadCodeElim : public FunctionPass {
+private:
+    unsigned int numInsts;
+    unsigned int numBlocks;
+
+    bool removeDeadInstructions(Function* fn);
+    bool bypassEmptyBlock(Function* fn, BasicBlock* bb);
+    bool mergeIntoPredecessor(Function* fn, BasicBlock* bb);
+    bool simplifyCFG(Function* fn);
+
+public:
+    DeadCodeElim();
+    const char* getName() const override;
+    bool runOnFunction(Function* fn) override;
+    void printStatistics(std::ostream &out) override;
+};
+
+} // namespace smallc
+
+#endif /* DeadCodeElim_h */
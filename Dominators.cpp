@@ -0,0 +1,241 @@
+//
+//  Dominators.cpp
+//  ECE467 Lab 3
+//
+//  Lengauer-Tarjan dominator tree construction.
+//
+
+#include <algorithm>
+
+#include "Dominators.h"
+
+namespace smallc {
+
+DominatorTree::DominatorTree(Function* fn_) : fn(fn_) {
+    recalculate();
+}
+
+void DominatorTree::recalculate() {
+    idom.clear();
+    children.clear();
+    treeIn.clear();
+    treeOut.clear();
+    fn->recomputePredecessors();
+    computeReversePostOrder();
+    computeIdoms();
+    numberTree();
+}
+
+void DominatorTree::computeReversePostOrder() {
+    rpo.clear();
+    BasicBlock* entry = fn->getEntry();
+    if (!entry)
+        return;
+
+    // Iterative DFS; a block is emitted once all its successors are done
+    std::map<BasicBlock*, bool> visited;
+    std::vector<std::pair<BasicBlock*, unsigned int> > stack;
+    std::vector<std::vector<BasicBlock*> > succs;
+    visited[entry] = true;
+    stack.push_back(std::make_pair(entry, 0u));
+    succs.push_back(entry->getSuccessors());
+    while (!stack.empty()) {
+        BasicBlock* bb = stack.back().first;
+        unsigned int &next = stack.back().second;
+        if (next < succs.back().size()) {
+            BasicBlock* succ = succs.back()[next++];
+            if (!visited[succ]) {
+                visited[succ] = true;
+                stack.push_back(std::make_pair(succ, 0u));
+                succs.push_back(succ->getSuccessors());
+            }
+            continue;
+        }
+        rpo.push_back(bb);
+        stack.pop_back();
+        succs.pop_back();
+    }
+    std::reverse(rpo.begin(), rpo.end());
+}
+
+// Lengauer & Tarjan, "A Fast Algorithm for Finding Dominators in a
+// Flowgraph", TOPLAS 1979. Vertices are numbered in DFS preorder.
+void DominatorTree::computeIdoms() {
+    BasicBlock* entry = fn->getEntry();
+    if (!entry)
+        return;
+
+    std::map<BasicBlock*, int> number;
+    std::vector<BasicBlock*> vertex;
+    std::vector<int> parent;
+
+    // DFS preorder numbering (iterative)
+    std::vector<std::pair<BasicBlock*, int> > stack;
+    stack.push_back(std::make_pair(entry, -1));
+    while (!stack.empty()) {
+        BasicBlock* bb = stack.back().first;
+        int par = stack.back().second;
+        stack.pop_back();
+        if (number.count(bb))
+            continue;
+        int n = (int)vertex.size();
+        number[bb] = n;
+        vertex.push_back(bb);
+        parent.push_back(par);
+        std::vector<BasicBlock*> succs = bb->getSuccessors();
+        for (auto it = succs.rbegin(); it != succs.rend(); ++it) {
+            if (!number.count(*it))
+                stack.push_back(std::make_pair(*it, n));
+        }
+    }
+
+    int n = (int)vertex.size();
+    std::vector<int> semi(n), label(n), ancestor(n, -1), dom(n, 0);
+    std::vector<std::vector<int> > bucket(n);
+    for (int i = 0; i < n; i++) {
+        semi[i] = i;
+        label[i] = i;
+    }
+
+    // eval() with iterative path compression
+    std::vector<int> path;
+    auto eval = [&](int v) {
+        if (ancestor[v] < 0)
+            return v;
+        path.clear();
+        int u = v;
+        while (ancestor[ancestor[u]] >= 0) {
+            path.push_back(u);
+            u = ancestor[u];
+        }
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            int w = *it;
+            if (semi[label[ancestor[w]]] < semi[label[w]])
+                label[w] = label[ancestor[w]];
+            ancestor[w] = ancestor[ancestor[w]];
+        }
+        return label[v];
+    };
+
+    for (int w = n - 1; w > 0; w--) {
+        for (auto pred : vertex[w]->getPredecessors()) {
+            auto it = number.find(pred);
+            if (it == number.end())
+                continue;   // Unreachable predecessor
+            int u = eval(it->second);
+            if (semi[u] < semi[w])
+                semi[w] = semi[u];
+        }
+        bucket[semi[w]].push_back(w);
+        ancestor[w] = parent[w];    // link(parent[w], w)
+        for (int v : bucket[parent[w]]) {
+            int u = eval(v);
+            dom[v] = semi[u] < semi[v] ? u : parent[w];
+        }
+        bucket[parent[w]].clear();
+    }
+    for (int w = 1; w < n; w++) {
+        if (dom[w] != semi[w])
+            dom[w] = dom[dom[w]];
+    }
+
+    idom[entry] = nullptr;
+    for (int w = 1; w < n; w++) {
+        idom[vertex[w]] = vertex[dom[w]];
+        children[vertex[dom[w]]].push_back(vertex[w]);
+    }
+}
+
+void DominatorTree::numberTree() {
+    BasicBlock* entry = fn->getEntry();
+    if (!entry)
+        return;
+    unsigned int counter = 0;
+    std::vector<std::pair<BasicBlock*, unsigned int> > stack;
+    treeIn[entry] = counter++;
+    stack.push_back(std::make_pair(entry, 0u));
+    while (!stack.empty()) {
+        BasicBlock* bb = stack.back().first;
+        unsigned int &next = stack.back().second;
+        const std::vector<BasicBlock*> &kids = getChildren(bb);
+        if (next < kids.size()) {
+            BasicBlock* kid = kids[next++];
+            treeIn[kid] = counter++;
+            stack.push_back(std::make_pair(kid, 0u));
+            continue;
+        }
+        treeOut[bb] = counter++;
+        stack.pop_back();
+    }
+}
+
+BasicBlock* DominatorTree::getIdom(BasicBlock* bb) {
+    auto it = idom.find(bb);
+    return it == idom.end() ? nullptr : it->second;
+}
+
+const std::vector<BasicBlock*>& DominatorTree::getChildren(BasicBlock* bb) {
+    return children[bb];
+}
+
+bool DominatorTree::isReachable(BasicBlock* bb) {
+    return idom.count(bb) != 0;
+}
+
+bool DominatorTree::dominates(BasicBlock* a, BasicBlock* b) {
+    if (!isReachable(b))
+        return true;    // Everything dominates unreachable code
+    if (!isReachable(a))
+        return false;
+    return treeIn[a] <= treeIn[b] && treeOut[b] <= treeOut[a];
+}
+
+bool DominatorTree::properlyDominates(BasicBlock* a, BasicBlock* b) {
+    return a != b && dominates(a, b);
+}
+
+bool DominatorTree::dominates(Instruction* def, Instruction* user) {
+    BasicBlock* defBB = def->getParent();
+    BasicBlock* useBB = user->getParent();
+    if (defBB != useBB)
+        return dominates(defBB, useBB);
+    for (auto inst : defBB->getInstructions()) {
+        if (inst == def)
+            return true;
+        if (inst == user)
+            return false;
+    }
+    return false;
+}
+
+const std::vector<BasicBlock*>& DominatorTree::getReversePostOrder() {
+    return rpo;
+}
+
+std::vector<BasicBlock*> DominatorTree::getPreOrder() {
+    std::vector<BasicBlock*> order;
+    if (!fn->getEntry())
+        return order;
+    std::vector<BasicBlock*> stack(1, fn->getEntry());
+    while (!stack.empty()) {
+        BasicBlock* bb = stack.back();
+        stack.pop_back();
+        order.push_back(bb);
+        const std::vector<BasicBlock*> &kids = getChildren(bb);
+        for (auto it = kids.rbegin(); it != kids.rend(); ++it)
+            stack.push_back(*it);
+    }
+    return order;
+}
+
+void DominatorTree::print(std::ostream &out) {
+    out << "dominator tree for @" << fn->getName() << ":\n";
+    for (auto bb : getPreOrder()) {
+        unsigned int depth = 0;
+        for (BasicBlock* p = getIdom(bb); p; p = getIdom(p))
+            depth++;
+        out << std::string(2 * depth + 2, ' ') << "%" << bb->getName() << "\n";
+    }
+}
+
+} // namespace smallc
@@ -0,0 +1,58 @@
+//
+//  Dominators.h
+//  ECE467 Lab 3
+//
+//  Dominator tree of a Function's CFG, computed with the Lengauer-Tarjan
+//  algorithm (the "simple" variant with path compression). Unreachable
+//  blocks are not part of the tree.
+//
+
+#ifndef Dominators_h
+#define Dominators_h
+
+#include <map>
+#include <ostream>
+#include <vector>
+
+#include "IR.h"
+
+namespace smallc {
+
+class DominatorTree {
+private:
+    Function* fn;
+    std::map<BasicBlock*, BasicBlock*> idom;
+    std::map<BasicBlock*, std::vector<BasicBlock*> > children;
+    std::map<BasicBlock*, unsigned int> treeIn;     // Dominator tree DFS numbering
+    std::map<BasicBlock*, unsigned int> treeOut;    // for O(1) dominance queries
+    std::vector<BasicBlock*> rpo;                   // CFG reverse postorder
+
+    void computeReversePostOrder();
+    void computeIdoms();
+    void numberTree();
+
+public:
+    explicit DominatorTree(Function* fn_);
+
+    // Rebuild after the CFG changed
+    void recalculate();
+
+    BasicBlock* getIdom(BasicBlock* bb);
+    const std::vector<BasicBlock*>& getChildren(BasicBlock* bb);
+    bool isReachable(BasicBlock* bb);
+    bool dominates(BasicBlock* a, BasicBlock* b);
+    bool properlyDominates(BasicBlock* a, BasicBlock* b);
+    // Does the value defined by def dominate its use in user?
+    bool dominates(Instruction* def, Instruction* user);
+
+    // Reachable blocks in CFG reverse postorder
+    const std::vector<BasicBlock*>& getReversePostOrder();
+    // Reachable blocks in dominator tree preorder
+    std::vector<BasicBlock*> getPreOrder();
+
+    void print(std::ostream &out);
+};
+
+} // namespace smallc
+
+#endif /* Dominators_h */
@@ -0,0 +1,221 @@
+//
+//  GVN.cpp
+//  ECE467 Lab 3
+//
+//  Dominator-based value numbering with load elimination.
+//
+
+#include <algorithm>
+
+#include "GVN.h"
+
+namespace smallc {
+
+bool GVN::ExprKey::operator<(const ExprKey &rhs) const {
+    if (opcode != rhs.opcode)
+        return opcode < rhs.opcode;
+    if (pred != rhs.pred)
+        return pred < rhs.pred;
+    if (ops != rhs.ops)
+        return ops < rhs.ops;
+    return blocks < rhs.blocks;
+}
+
+GVN::GVN() : dt(nullptr), epochCounter(0), numExprs(0), numLoads(0), numForwarded(0) {}
+
+const char* GVN::getName() const { return "gvn"; }
+
+void GVN::printStatistics(std::ostream &out) {
+    out << "gvn: " << numExprs << " redundant expressions, "
+        << numLoads << " redundant loads, "
+        << numForwarded << " loads forwarded from stores\n";
+}
+
+/**********************************************************************************/
+/* Keys                                                                           */
+/**********************************************************************************/
+
+GVN::ExprKey GVN::makeKey(Instruction* inst) {
+    ExprKey key;
+    key.opcode = inst->getOpcode();
+    key.pred = -1;
+    if (inst->getOpcode() == Instruction::Phi) {
+        // Incoming order does not matter
+        std::vector<std::pair<BasicBlock*, Value*> > incoming;
+        for (unsigned int i = 0; i < inst->getNumOperands(); i++)
+            incoming.push_back(std::make_pair(inst->getBlockOperand(i), inst->getOperand(i)));
+        std::sort(incoming.begin(), incoming.end());
+        for (auto &in : incoming) {
+            key.blocks.push_back(in.first);
+            key.ops.push_back(in.second);
+        }
+        // Phis are only equivalent within one block
+        key.blocks.push_back(inst->getParent());
+        return key;
+    }
+
+    for (unsigned int i = 0; i < inst->getNumOperands(); i++)
+        key.ops.push_back(inst->getOperand(i));
+    if (inst->getOpcode() == Instruction::Cmp) {
+        Instruction::Predicate pred = inst->getPredicate();
+        if (key.ops[1] < key.ops[0]) {
+            std::swap(key.ops[0], key.ops[1]);
+            pred = Instruction::swapPredicate(pred);
+        }
+        key.pred = pred;
+    }
+    else if (inst->getOpcode() == Instruction::Add || inst->getOpcode() == Instruction::Mul) {
+        if (key.ops[1] < key.ops[0])
+            std::swap(key.ops[0], key.ops[1]);
+    }
+    return key;
+}
+
+GVN::ExprKey GVN::makeLoadKey(Instruction::Opcode op, Value* base, Value* index) {
+    ExprKey key;
+    key.opcode = op;
+    key.pred = -1;
+    key.ops.push_back(base);
+    if (index)
+        key.ops.push_back(index);
+    return key;
+}
+
+/**********************************************************************************/
+/* Memory                                                                         */
+/**********************************************************************************/
+
+GVN::LoadEntry GVN::makeEntry(Value* val, Value* base, MemoryState &mem) {
+    LoadEntry entry;
+    entry.val = val;
+    entry.epoch = mem.epoch;
+    entry.wildGen = mem.wildGen;
+    entry.anyArrayGen = mem.anyArrayGen;
+    entry.objGen = mem.gens[base];
+    return entry;
+}
+
+bool GVN::isValid(const LoadEntry &entry, Value* base, MemoryState &mem) {
+    if (entry.epoch != mem.epoch)
+        return false;
+    if (!isIdentifiedObject(base))
+        return entry.anyArrayGen == mem.anyArrayGen;
+    return entry.objGen == mem.gens[base] && entry.wildGen == mem.wildGen;
+}
+
+void GVN::clobber(Value* base, bool isArray, MemoryState &mem) {
+    if (!isArray) {
+        mem.gens[base]++;
+        return;
+    }
+    mem.anyArrayGen++;
+    if (isIdentifiedObject(base))
+        mem.gens[base]++;
+    else
+        mem.wildGen++;
+}
+
+/**********************************************************************************/
+/* Walk                                                                           */
+/**********************************************************************************/
+
+bool GVN::processBlock(BasicBlock* bb, MemoryState mem) {
+    bool changed = false;
+    std::vector<ExprKey> scopeExprs;
+    std::vector<ExprKey> scopeLoads;
+
+    // Another path may have written memory on the way in
+    if (bb->getPredecessors().size() != 1)
+        mem.epoch = ++epochCounter;
+
+    std::vector<Instruction*> insts(bb->getInstructions().begin(), bb->getInstructions().end());
+    for (auto inst : insts) {
+        switch (inst->getOpcode()) {
+            case Instruction::Add:
+            case Instruction::Sub:
+            case Instruction::Mul:
+            case Instruction::Div:
+            case Instruction::Neg:
+            case Instruction::Not:
+            case Instruction::Cmp:
+            case Instruction::Phi: {
+                // A dominating division already trapped if it was going to
+                ExprKey key = makeKey(inst);
+                auto &avail = exprs[key];
+                if (!avail.empty()) {
+                    inst->replaceAllUsesWith(avail.back());
+                    inst->eraseFromParent();
+                    numExprs++;
+                    changed = true;
+                    break;
+                }
+                avail.push_back(inst);
+                scopeExprs.push_back(key);
+                break;
+            }
+            case Instruction::Load:
+            case Instruction::LoadElem: {
+                Value* base = inst->getOperand(0);
+                Value* index = inst->getOpcode() == Instruction::LoadElem ? inst->getOperand(1) : nullptr;
+                ExprKey key = makeLoadKey(Instruction::LoadElem, base, index);
+                auto &avail = loads[key];
+                if (!avail.empty() && isValid(avail.back(), base, mem)) {
+                    Value* val = avail.back().val;
+                    bool fromStore = val->getKind() != Value::InstructionVal ||
+                        static_cast<Instruction*>(val)->getOpcode() != inst->getOpcode();
+                    inst->replaceAllUsesWith(val);
+                    inst->eraseFromParent();
+                    if (fromStore)
+                        numForwarded++;
+                    else
+                        numLoads++;
+                    changed = true;
+                    break;
+                }
+                avail.push_back(makeEntry(inst, base, mem));
+                scopeLoads.push_back(key);
+                break;
+            }
+            case Instruction::Store:
+            case Instruction::StoreElem: {
+                // The stored value is what a following load would read
+                bool isArray = inst->getOpcode() == Instruction::StoreElem;
+                Value* base = inst->getOperand(0);
+                Value* index = isArray ? inst->getOperand(1) : nullptr;
+                Value* val = inst->getOperand(isArray ? 2 : 1);
+                clobber(base, isArray, mem);
+                ExprKey key = makeLoadKey(Instruction::LoadElem, base, index);
+                loads[key].push_back(makeEntry(val, base, mem));
+                scopeLoads.push_back(key);
+                break;
+            }
+            case Instruction::Call:
+            case Instruction::VecStore:
+                mem.epoch = ++epochCounter;
+                break;
+            default:
+                break;
+        }
+    }
+
+    for (auto child : dt->getChildren(bb))
+        changed |= processBlock(child, mem);
+
+    for (auto &key : scopeExprs)
+        exprs[key].pop_back();
+    for (auto &key : scopeLoads)
+        loads[key].pop_back();
+    return changed;
+}
+
+bool GVN::runOnFunction(Function* fn) {
+    DominatorTree tree(fn);
+    dt = &tree;
+    bool changed = processBlock(fn->getEntry(), MemoryState());
+    dt = nullptr;
+    exprs.clear();
+    loads.clear();
+    return changed;
+}
+
+} // namespace smallc
@@ -0,0 +1,88 @@
+//
+//  GVN.h
+//  ECE467 Lab 3
+//
+//  Dominator-based value numbering (Briggs, Cooper and Simpson, "Value
+//  Numbering", SP&E 1997). The dominator tree is walked with a scoped
+//  table of available expressions; an instruction computing an expression
+//  already available in a dominating block is replaced by the earlier
+//  value. Commutative operands and compare predicates are canonicalized
+//  first, so a+b and b+a share a number.
+//
+//  Loads take part too. Stores make their value available to later loads
+//  of the same location. Calls clobber all memory. Stores to a global
+//  scalar clobber only that global. Array stores clobber loads from the
+//  same array object and from any array parameter, which may alias
+//  anything. Memory is assumed clobbered on entry to a block with several
+//  predecessors (join points and loop headers).
+//
+
+#ifndef GVN_h
+#define GVN_h
+
+#include <map>
+#include <vector>
+
+#include "PassManager.h"
+#include "Dominators.h"
+
+namespace smallc {
+
+class GVN : public FunctionPass {
+private:
+    // An expression: opcode, predicate and (canonically ordered) operands
+    class ExprKey {
+    public:
+        int opcode;
+        int pred;
+        std::vector<Value*> ops;
+        std::vector<BasicBlock*> blocks;    // Phi incoming blocks
+        bool operator<(const ExprKey &rhs) const;
+    };
+
+    // Memory generations: bumped by every store that may change an object
+    class MemoryState {
+    public:
+        unsigned int epoch;                 // Calls and join points
+        unsigned int wildGen;               // Stores through array parameters
+        unsigned int anyArrayGen;           // Any array store
+        std::map<Value*, unsigned int> gens;// Stores to a known global or alloca
+        MemoryState() : epoch(0), wildGen(0), anyArrayGen(0) {}
+    };
+
+    // A value available for a load key, and the generations it was read at
+    class LoadEntry {
+    public:
+        Value* val;
+        unsigned int epoch;
+        unsigned int wildGen;
+        unsigned int anyArrayGen;
+        unsigned int objGen;
+    };
+
+    DominatorTree* dt;
+    unsigned int epochCounter;
+    std::map<ExprKey, std::vector<Value*> > exprs;      // Scoped: innermost last
+    std::map<ExprKey, std::vector<LoadEntry> > loads;
+
+    unsigned int numExprs;
+    unsigned int numLoads;
+    unsigned int numForwarded;
+
+    static ExprKey makeKey(Instruction* inst);
+    static ExprKey makeLoadKey(Instruction::Opcode op, Value* base, Value* index);
+    LoadEntry makeEntry(Value* val, Value* base, MemoryState &mem);
+    bool isValid(const LoadEntry &entry, Value* base, MemoryState &mem);
+    void clobber(Value* base, bool isArray, MemoryState &mem);
+    bool processBlock(BasicBlock* bb, MemoryState mem);
+
+public:
+    GVN();
+    const char* getName() const override;
+    bool runOnFunction(Function* fn) override;
+    void printStatistics(std::ostream &out) override;
+};
+
+} // namespace smallc
+
+#endif /* GVN_h */
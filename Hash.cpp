@@ -0,0 +1,67 @@
+//
+//  Hash.cpp
+//  ECE467 Lab 3
+//
+//  128-bit FNV-1a hashing.
+//
+
+#include "Hash.h"
+
+namespace smallc {
+
+namespace {
+
+const HashValue OffsetBasis = ((HashValue)0x6c62272e07bb0142ULL << 64) | 0x62b821756295c58dULL;
+const HashValue Prime = ((HashValue)0x0000000001000000ULL << 64) | 0x000000000000013bULL;
+
+} // namespace
+
+Hasher::Hasher() : state(OffsetBasis) {}
+
+void Hasher::update(const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    HashValue h = state;
+    for (size_t i = 0; i < size; i++) {
+        h ^= bytes[i];
+        h *= Prime;
+    }
+    state = h;
+}
+
+void Hasher::addField(const std::string &field) {
+    addField((uint64_t)field.size());
+    update(field.data(), field.size());
+}
+
+void Hasher::addField(uint64_t field) {
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; i++)
+        bytes[i] = (unsigned char)(field >> (8 * i));
+    update(bytes, sizeof(bytes));
+}
+
+void Hasher::addHash(HashValue hash) {
+    addField((uint64_t)hash);
+    addField((uint64_t)(hash >> 64));
+}
+
+HashValue Hasher::digest() const {
+    return state;
+}
+
+std::string Hasher::hex() const {
+    return toHex(state);
+}
+
+std::string Hasher::toHex(HashValue hash) {
+    static const char digits[] = "0123456789abcdef";
+    std::string text(32, '0');
+    HashValue h = hash;
+    for (int i = 31; i >= 0; i--) {
+        text[i] = digits[(unsigned)(h & 0xf)];
+        h >>= 4;
+    }
+    return text;
+}
+
+} // namespace smallc
@@ -0,0 +1,46 @@
+//
+//  Hash.h
+//  ECE467 Lab 3
+//
+//  128-bit FNV-1a hashing, for content-addressed keys. It is fast and
+//  well spread for telling contents apart, but it is not cryptographic:
+//  it does not resist inputs made to collide.
+//
+
+#ifndef Hash_h
+#define Hash_h
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace smallc {
+
+typedef unsigned __int128 HashValue;
+
+class Hasher {
+private:
+    HashValue state;
+
+public:
+    Hasher();
+
+    void update(const void* data, size_t size);
+
+    // A string with its length first, so that consecutive fields cannot
+    // run into each other
+    void addField(const std::string &field);
+    void addField(uint64_t field);
+    // Another hash, such as a child's in a Merkle tree
+    void addHash(HashValue hash);
+
+    HashValue digest() const;
+
+    // The hash so far, as 32 hexadecimal digits
+    std::string hex() const;
+    static std::string toHex(HashValue hash);
+};
+
+} // namespace smallc
+
+#endif /* Hash_h */
@@ -0,0 +1,760 @@
+//
+//  IR.cpp
+//  ECE467 Lab 3
+//
+//  SSA intermediate representation and its textual dump.
+//
+
+#include <algorithm>
+#include <set>
+
+#include "IR.h"
+
+namespace smallc {
+
+/**********************************************************************************/
+/* The Value Class                                                                */
+/**********************************************************************************/
+
+Value::Value(ValueKind kind_, Type type_) : kind(kind_), type(type_), users() {}
+
+Value::~Value() {}
+
+Value::ValueKind Value::getKind() const { return kind; }
+
+Value::Type Value::getType() const { return type; }
+
+void Value::setType(Type type_) { type = type_; }
+
+const std::vector<Instruction*>& Value::getUsers() const { return users; }
+
+unsigned int Value::getNumUses() const { return (unsigned int)users.size(); }
+
+bool Value::hasUses() const { return !users.empty(); }
+
+void Value::addUser(Instruction* user) { users.push_back(user); }
+
+void Value::removeUser(Instruction* user) {
+    auto it = std::find(users.begin(), users.end(), user);
+    if (it != users.end())
+        users.erase(it);
+}
+
+void Value::replaceAllUsesWith(Value* v) {
+    if (v == this)
+        return;
+    std::vector<Instruction*> uses = users;
+    for (auto user : uses) {
+        for (unsigned int i = 0; i < user->getNumOperands(); i++) {
+            if (user->getOperand(i) == this)
+                user->setOperand(i, v);
+        }
+    }
+}
+
+const char* Value::typeName(Type t) {
+    switch (t) {
+        case Void: return "void";
+        case Int:  return "int";
+        case Bool: return "bool";
+        case Ptr:  return "ptr";
+        case Vec:  return "vec";
+    }
+    return "?";
+}
+
+/**********************************************************************************/
+/* The Constant Class                                                             */
+/**********************************************************************************/
+
+Constant::Constant(Type type_, int val_) : Value(ConstantVal, type_), val(val_) {}
+
+int Constant::getVal() const { return val; }
+
+/**********************************************************************************/
+/* The Argument Class                                                             */
+/**********************************************************************************/
+
+Argument::Argument(Type type_, const std::string &name_, Function* parent_, unsigned int index_)
+    : Value(ArgumentVal, type_), name(name_), parent(parent_), index(index_) {}
+
+const std::string& Argument::getName() const { return name; }
+
+Function* Argument::getParent() { return parent; }
+
+unsigned int Argument::getIndex() const { return index; }
+
+/**********************************************************************************/
+/* The GlobalVariable Class                                                       */
+/**********************************************************************************/
+
+GlobalVariable::GlobalVariable(const std::string &name_, Type elemType_, int size_)
+    : Value(GlobalVal, Ptr), name(name_), elemType(elemType_), size(size_) {}
+
+const std::string& GlobalVariable::getName() const { return name; }
+
+Value::Type GlobalVariable::getElemType() const { return elemType; }
+
+int GlobalVariable::getSize() const { return size; }
+
+bool GlobalVariable::isArray() const { return size > 0; }
+
+/**********************************************************************************/
+/* The Instruction Class                                                          */
+/**********************************************************************************/
+
+Instruction::Instruction(Opcode opcode_, Type type_)
+    : Value(InstructionVal, type_), opcode(opcode_), pred(EQ), parent(nullptr),
+      operands(), blockOps(), callee(), calleeFn(nullptr), allocSize(0), location(0, 0),
+      profileCount(-1), lanes(0) {}
+
+Instruction::~Instruction() {
+    dropAllOperands();
+}
+
+Instruction::Opcode Instruction::getOpcode() const { return opcode; }
+
+void Instruction::setOpcode(Opcode opcode_) { opcode = opcode_; }
+
+Instruction::Predicate Instruction::getPredicate() const { return pred; }
+
+void Instruction::setPredicate(Predicate pred_) { pred = pred_; }
+
+BasicBlock* Instruction::getParent() { return parent; }
+
+void Instruction::setParent(BasicBlock* bb) { parent = bb; }
+
+Function* Instruction::getFunction() { return parent ? parent->getParent() : nullptr; }
+
+unsigned int Instruction::getNumOperands() const { return (unsigned int)operands.size(); }
+
+Value* Instruction::getOperand(unsigned int i) { return operands[i]; }
+
+void Instruction::setOperand(unsigned int i, Value* v) {
+    if (operands[i])
+        operands[i]->removeUser(this);
+    operands[i] = v;
+    if (v)
+        v->addUser(this);
+}
+
+void Instruction::addOperand(Value* v) {
+    operands.push_back(v);
+    if (v)
+        v->addUser(this);
+}
+
+void Instruction::removeOperand(unsigned int i) {
+    if (operands[i])
+        operands[i]->removeUser(this);
+    operands.erase(operands.begin() + i);
+}
+
+void Instruction::dropAllOperands() {
+    for (auto op : operands) {
+        if (op)
+            op->removeUser(this);
+    }
+    operands.clear();
+}
+
+unsigned int Instruction::getNumBlockOperands() const { return (unsigned int)blockOps.size(); }
+
+BasicBlock* Instruction::getBlockOperand(unsigned int i) { return blockOps[i]; }
+
+void Instruction::setBlockOperand(unsigned int i, BasicBlock* bb) { blockOps[i] = bb; }
+
+void Instruction::addBlockOperand(BasicBlock* bb) { blockOps.push_back(bb); }
+
+void Instruction::addIncoming(Value* v, BasicBlock* bb) {
+    addOperand(v);
+    blockOps.push_back(bb);
+}
+
+Value* Instruction::getIncomingValueFor(BasicBlock* bb) {
+    for (unsigned int i = 0; i < blockOps.size(); i++) {
+        if (blockOps[i] == bb)
+            return operands[i];
+    }
+    return nullptr;
+}
+
+void Instruction::removeIncoming(BasicBlock* bb) {
+    for (unsigned int i = 0; i < blockOps.size(); i++) {
+        if (blockOps[i] == bb) {
+            removeOperand(i);
+            blockOps.erase(blockOps.begin() + i);
+            return;
+        }
+    }
+}
+
+void Instruction::replaceIncomingBlock(BasicBlock* from, BasicBlock* to) {
+    for (auto &bb : blockOps) {
+        if (bb == from)
+            bb = to;
+    }
+}
+
+const std::string& Instruction::getCallee() const { return callee; }
+
+Function* Instruction::getCalleeFunction() { return calleeFn; }
+
+void Instruction::setCallee(const std::string &name, Function* fn) {
+    callee = name;
+    calleeFn = fn;
+}
+
+int Instruction::getAllocSize() const { return allocSize; }
+
+void Instruction::setAllocSize(int size) { allocSize = size; }
+
+unsigned int Instruction::getLine() const { return location.first; }
+
+unsigned int Instruction::getCol() const { return location.second; }
+
+std::pair<unsigned int, unsigned int> Instruction::getLocation() const { return location; }
+
+void Instruction::setLocation(std::pair<unsigned int, unsigned int> loc) { location = loc; }
+
+long long Instruction::getProfileCount() const { return profileCount; }
+
+void Instruction::setProfileCount(long long count) { profileCount = count; }
+
+unsigned int Instruction::getLanes() const { return lanes; }
+
+void Instruction::setLanes(unsigned int n) { lanes = n; }
+
+bool Instruction::isTerminator() const {
+    return opcode == Br || opcode == CondBr || opcode == Ret;
+}
+
+bool Instruction::isBinaryOp() const {
+    return opcode == Add || opcode == Sub || opcode == Mul || opcode == Div;
+}
+
+bool Instruction::mayWriteMemory() const {
+    return opcode == Store || opcode == StoreElem || opcode == VecStore || opcode == Call;
+}
+
+bool Instruction::mayReadMemory() const {
+    return opcode == Load || opcode == LoadElem || opcode == VecLoad || opcode == Call;
+}
+
+bool Instruction::hasSideEffects() const {
+    // Division and bounds checks may trap; profile counters must count
+    return mayWriteMemory() || isTerminator() || opcode == Div || opcode == BoundsCheck ||
+           opcode == ProfileCount || opcode == VecEnd;
+}
+
+void Instruction::eraseFromParent() {
+    if (parent)
+        parent->remove(this);
+    delete this;
+}
+
+const char* Instruction::opcodeName(Opcode op) {
+    switch (op) {
+        case Add:         return "add";
+        case Sub:         return "sub";
+        case Mul:         return "mul";
+        case Div:         return "div";
+        case Neg:         return "neg";
+        case Not:         return "not";
+        case Cmp:         return "cmp";
+        case Phi:         return "phi";
+        case Call:        return "call";
+        case Load:        return "load";
+        case Store:       return "store";
+        case LoadElem:    return "loadelem";
+        case StoreElem:   return "storeelem";
+        case BoundsCheck: return "boundscheck";
+        case ProfileCount: return "profcount";
+        case VecLoad:     return "vload";
+        case VecStore:    return "vstore";
+        case Splat:       return "splat";
+        case VecIndex:    return "vindex";
+        case HasAVX2:     return "hasavx2";
+        case VecEnd:      return "vecend";
+        case Alloca:      return "alloca";
+        case Br:          return "br";
+        case CondBr:      return "condbr";
+        case Ret:         return "ret";
+    }
+    return "?";
+}
+
+const char* Instruction::predicateName(Predicate p) {
+    switch (p) {
+        case EQ: return "eq";
+        case NE: return "ne";
+        case LT: return "lt";
+        case LE: return "le";
+        case GT: return "gt";
+        case GE: return "ge";
+    }
+    return "?";
+}
+
+// a p b  <=>  b swap(p) a
+Instruction::Predicate Instruction::swapPredicate(Predicate p) {
+    switch (p) {
+        case LT: return GT;
+        case LE: return GE;
+        case GT: return LT;
+        case GE: return LE;
+        default: return p;
+    }
+}
+
+// !(a p b)  <=>  a invert(p) b
+Instruction::Predicate Instruction::invertPredicate(Predicate p) {
+    switch (p) {
+        case EQ: return NE;
+        case NE: return EQ;
+        case LT: return GE;
+        case LE: return GT;
+        case GT: return LE;
+        case GE: return LT;
+    }
+    return p;
+}
+
+/**********************************************************************************/
+/* The BasicBlock Class                                                           */
+/**********************************************************************************/
+
+BasicBlock::BasicBlock(const std::string &name_, Function* parent_)
+    : name(name_), parent(parent_), profileCount(-1) {}
+
+BasicBlock::~BasicBlock() {
+    for (auto inst : insts)
+        inst->dropAllOperands();
+    for (auto inst : insts)
+        delete inst;
+}
+
+const std::string& BasicBlock::getName() const { return name; }
+
+void BasicBlock::setName(const std::string &name_) { name = name_; }
+
+Function* BasicBlock::getParent() { return parent; }
+
+std::list<Instruction*>& BasicBlock::getInstructions() { return insts; }
+
+bool BasicBlock::empty() const { return insts.empty(); }
+
+Instruction* BasicBlock::getTerminator() {
+    if (insts.empty() || !insts.back()->isTerminator())
+        return nullptr;
+    return insts.back();
+}
+
+std::vector<BasicBlock*> BasicBlock::getSuccessors() {
+    std::vector<BasicBlock*> succs;
+    Instruction* term = getTerminator();
+    if (!term)
+        return succs;
+    for (unsigned int i = 0; i < term->getNumBlockOperands(); i++) {
+        BasicBlock* bb = term->getBlockOperand(i);
+        if (std::find(succs.begin(), succs.end(), bb) == succs.end())
+            succs.push_back(bb);
+    }
+    return succs;
+}
+
+std::vector<BasicBlock*>& BasicBlock::getPredecessors() { return preds; }
+
+std::vector<Instruction*> BasicBlock::getPhis() {
+    std::vector<Instruction*> phis;
+    for (auto inst : insts) {
+        if (inst->getOpcode() != Instruction::Phi)
+            break;
+        phis.push_back(inst);
+    }
+    return phis;
+}
+
+long long BasicBlock::getProfileCount() const { return profileCount; }
+
+void BasicBlock::setProfileCount(long long count) { profileCount = count; }
+
+bool BasicBlock::hasProfileCount() const { return profileCount >= 0; }
+
+long long BasicBlock::getEdgeCount(BasicBlock* succ) {
+    Instruction* term = getTerminator();
+    if (!term || profileCount < 0)
+        return -1;
+    if (term->getOpcode() == Instruction::Br)
+        return term->getBlockOperand(0) == succ ? profileCount : 0;
+    if (term->getOpcode() != Instruction::CondBr)
+        return 0;
+    bool isTrue = term->getBlockOperand(0) == succ;
+    bool isFalse = term->getBlockOperand(1) == succ;
+    if (!isTrue && !isFalse)
+        return 0;
+    if (isTrue && isFalse)
+        return profileCount;
+    long long taken = term->getProfileCount();
+    if (taken < 0)
+        return -1;
+    // Counts read from a stale profile may not add up
+    return isTrue ? taken : std::max(profileCount - taken, 0LL);
+}
+
+void BasicBlock::append(Instruction* inst) {
+    inst->setParent(this);
+    insts.push_back(inst);
+}
+
+void BasicBlock::insertBefore(Instruction* pos, Instruction* inst) {
+    inst->setParent(this);
+    insts.insert(std::find(insts.begin(), insts.end(), pos), inst);
+}
+
+void BasicBlock::insertBeforeTerminator(Instruction* inst) {
+    Instruction* term = getTerminator();
+    if (term)
+        insertBefore(term, inst);
+    else
+        append(inst);
+}
+
+void BasicBlock::insertAfterPhis(Instruction* inst) {
+    inst->setParent(this);
+    auto it = insts.begin();
+    while (it != insts.end() && (*it)->getOpcode() == Instruction::Phi)
+        ++it;
+    insts.insert(it, inst);
+}
+
+void BasicBlock::remove(Instruction* inst) {
+    insts.remove(inst);
+    inst->setParent(nullptr);
+}
+
+/**********************************************************************************/
+/* The Function Class                                                             */
+/**********************************************************************************/
+
+Function::Function(const std::string &name_, Value::Type retType_, Module* parent_)
+    : name(name_), retType(retType_), parent(parent_), decl(nullptr), nextBlockId(0) {}
+
+Function::~Function() {
+    for (auto bb : blocks) {
+        for (auto inst : bb->getInstructions())
+            inst->dropAllOperands();
+    }
+    for (auto bb : blocks)
+        delete bb;
+    for (auto arg : args)
+        delete arg;
+}
+
+const std::string& Function::getName() const { return name; }
+
+Value::Type Function::getRetType() const { return retType; }
+
+Module* Function::getParent() { return parent; }
+
+FunctionDeclNode* Function::getDecl() { return decl; }
+
+void Function::setDecl(FunctionDeclNode* decl_) { decl = decl_; }
+
+Argument* Function::addArgument(Value::Type type, const std::string &argName) {
+    Argument* arg = new Argument(type, argName, this, (unsigned int)args.size());
+    args.push_back(arg);
+    return arg;
+}
+
+std::vector<Argument*>& Function::getArgs() { return args; }
+
+std::vector<BasicBlock*>& Function::getBlocks() { return blocks; }
+
+BasicBlock* Function::getEntry() { return blocks.empty() ? nullptr : blocks[0]; }
+
+BasicBlock* Function::createBlock(const std::string &blockName) {
+    // Keep block names unique within the function
+    std::string unique = blockName;
+    if (nextBlockId > 0)
+        unique += std::to_string(nextBlockId);
+    nextBlockId++;
+    BasicBlock* bb = new BasicBlock(unique, this);
+    blocks.push_back(bb);
+    return bb;
+}
+
+void Function::moveBlockAfter(BasicBlock* bb, BasicBlock* pos) {
+    blocks.erase(std::find(blocks.begin(), blocks.end(), bb));
+    blocks.insert(std::find(blocks.begin(), blocks.end(), pos) + 1, bb);
+}
+
+void Function::removeBlock(BasicBlock* bb) {
+    blocks.erase(std::find(blocks.begin(), blocks.end(), bb));
+    delete bb;
+}
+
+void Function::recomputePredecessors() {
+    for (auto bb : blocks)
+        bb->getPredecessors().clear();
+    for (auto bb : blocks) {
+        for (auto succ : bb->getSuccessors())
+            succ->getPredecessors().push_back(bb);
+    }
+}
+
+unsigned int Function::removeUnreachableBlocks() {
+    std::set<BasicBlock*> reachable;
+    std::vector<BasicBlock*> work;
+    if (getEntry()) {
+        work.push_back(getEntry());
+        reachable.insert(getEntry());
+    }
+    while (!work.empty()) {
+        BasicBlock* bb = work.back();
+        work.pop_back();
+        for (auto succ : bb->getSuccessors()) {
+            if (reachable.insert(succ).second)
+                work.push_back(succ);
+        }
+    }
+
+    std::vector<BasicBlock*> dead;
+    for (auto bb : blocks) {
+        if (!reachable.count(bb))
+            dead.push_back(bb);
+    }
+    if (dead.empty())
+        return 0;
+
+    // Detach the dead blocks from live phis, then from each other
+    for (auto bb : dead) {
+        for (auto succ : bb->getSuccessors()) {
+            if (!reachable.count(succ))
+                continue;
+            for (auto phi : succ->getPhis())
+                phi->removeIncoming(bb);
+        }
+    }
+    for (auto bb : dead) {
+        for (auto inst : bb->getInstructions())
+            inst->dropAllOperands();
+    }
+    for (auto bb : dead)
+        removeBlock(bb);
+    recomputePredecessors();
+    return (unsigned int)dead.size();
+}
+
+unsigned int Function::getInstructionCount() {
+    unsigned int count = 0;
+    for (auto bb : blocks)
+        count += (unsigned int)bb->getInstructions().size();
+    return count;
+}
+
+/**********************************************************************************/
+/* The Module Class                                                               */
+/**********************************************************************************/
+
+Module::Module() {}
+
+Module::~Module() {
+    for (auto fn : functions)
+        delete fn;
+    for (auto g : globals)
+        delete g;
+    for (auto &c : constants)
+        delete c.second;
+}
+
+std::vector<Function*>& Module::getFunctions() { return functions; }
+
+Function* Module::getFunction(const std::string &name) {
+    for (auto fn : functions) {
+        if (fn->getName() == name)
+            return fn;
+    }
+    return nullptr;
+}
+
+Function* Module::createFunction(const std::string &name, Value::Type retType) {
+    Function* fn = new Function(name, retType, this);
+    functions.push_back(fn);
+    return fn;
+}
+
+void Module::removeFunction(Function* fn) {
+    functions.erase(std::find(functions.begin(), functions.end(), fn));
+    delete fn;
+}
+
+std::vector<GlobalVariable*>& Module::getGlobals() { return globals; }
+
+GlobalVariable* Module::createGlobal(const std::string &name, Value::Type elemType, int size) {
+    GlobalVariable* g = new GlobalVariable(name, elemType, size);
+    globals.push_back(g);
+    return g;
+}
+
+Constant* Module::getConstant(Value::Type type, int val) {
+    auto key = std::make_pair((int)type, val);
+    auto it = constants.find(key);
+    if (it != constants.end())
+        return it->second;
+    Constant* c = new Constant(type, val);
+    constants[key] = c;
+    return c;
+}
+
+Constant* Module::getInt(int val) { return getConstant(Value::Int, val); }
+
+Constant* Module::getBool(bool val) { return getConstant(Value::Bool, val ? 1 : 0); }
+
+unsigned int Module::addProfileCounter(const std::string &key) {
+    profileKeys.push_back(key);
+    return (unsigned int)profileKeys.size() - 1;
+}
+
+const std::vector<std::string>& Module::getProfileKeys() { return profileKeys; }
+
+unsigned int Module::getInstructionCount() {
+    unsigned int count = 0;
+    for (auto fn : functions)
+        count += fn->getInstructionCount();
+    return count;
+}
+
+/**********************************************************************************/
+/* Textual dump                                                                   */
+/**********************************************************************************/
+
+namespace {
+
+class SlotTracker {
+public:
+    std::map<Value*, unsigned int> slots;
+
+    std::string name(Value* v) {
+        switch (v->getKind()) {
+            case Value::ConstantVal:
+                return std::to_string(static_cast<Constant*>(v)->getVal());
+            case Value::ArgumentVal:
+                return "%" + static_cast<Argument*>(v)->getName();
+            case Value::GlobalVal:
+                return "@" + static_cast<GlobalVariable*>(v)->getName();
+            case Value::InstructionVal: {
+                auto it = slots.find(v);
+                if (it == slots.end())
+                    return "%<badref>";
+                return "%" + std::to_string(it->second);
+            }
+        }
+        return "?";
+    }
+};
+
+void printInstruction(std::ostream &out, Instruction* inst, SlotTracker &st) {
+    out << "    ";
+    if (inst->getType() != Value::Void)
+        out << st.name(inst) << " = ";
+    out << Instruction::opcodeName(inst->getOpcode());
+
+    switch (inst->getOpcode()) {
+        case Instruction::Cmp:
+            out << " " << Instruction::predicateName(inst->getPredicate()) << " "
+                << st.name(inst->getOperand(0)) << ", " << st.name(inst->getOperand(1));
+            break;
+        case Instruction::Phi:
+            out << " " << Value::typeName(inst->getType());
+            for (unsigned int i = 0; i < inst->getNumOperands(); i++) {
+                out << (i ? ", " : " ") << "[ " << st.name(inst->getOperand(i)) << ", %"
+                    << inst->getBlockOperand(i)->getName() << " ]";
+            }
+            break;
+        case Instruction::Call:
+            out << " " << Value::typeName(inst->getType()) << " @" << inst->getCallee() << "(";
+            for (unsigned int i = 0; i < inst->getNumOperands(); i++)
+                out << (i ? ", " : "") << st.name(inst->getOperand(i));
+            out << ")";
+            break;
+        case Instruction::Alloca:
+            out << " [" << inst->getAllocSize() << "]";
+            break;
+        case Instruction::Br:
+        case Instruction::CondBr:
+            for (unsigned int i = 0; i < inst->getNumOperands(); i++)
+                out << " " << st.name(inst->getOperand(i)) << ",";
+            for (unsigned int i = 0; i < inst->getNumBlockOperands(); i++)
+                out << (i ? ", %" : " %") << inst->getBlockOperand(i)->getName();
+            break;
+        default:
+            if (inst->getLanes())
+                out << " <" << inst->getLanes() << " x int>";
+            else if (inst->getType() != Value::Void)
+                out << " " << Value::typeName(inst->getType());
+            for (unsigned int i = 0; i < inst->getNumOperands(); i++)
+                out << (i ? ", " : " ") << st.name(inst->getOperand(i));
+            break;
+    }
+    if (inst->getLine())
+        out << "    ; " << inst->getLine() << ":" << inst->getCol();
+    out << "\n";
+}
+
+} // anonymous namespace
+
+void Function::print(std::ostream &out) {
+    SlotTracker st;
+    unsigned int next = 0;
+    for (auto bb : blocks) {
+        for (auto inst : bb->getInstructions()) {
+            if (inst->getType() != Value::Void)
+                st.slots[inst] = next++;
+        }
+    }
+
+    out << "define " << Value::typeName(retType) << " @" << name << "(";
+    for (unsigned int i = 0; i < args.size(); i++)
+        out << (i ? ", " : "") << Value::typeName(args[i]->getType()) << " %" << args[i]->getName();
+    out << ") {\n";
+    for (auto bb : blocks) {
+        out << bb->getName() << ":";
+        if (!bb->getPredecessors().empty()) {
+            out << "\t\t\t\t; preds =";
+            for (auto pred : bb->getPredecessors())
+                out << " %" << pred->getName();
+        }
+        if (bb->hasProfileCount())
+            out << "\t; count = " << bb->getProfileCount();
+        out << "\n";
+        for (auto inst : bb->getInstructions())
+            printInstruction(out, inst, st);
+    }
+    out << "}\n";
+}
+
+void Module::print(std::ostream &out) {
+    for (auto g : globals) {
+        out << "@" << g->getName() << " = global " << Value::typeName(g->getElemType());
+        if (g->isArray())
+            out << "[" << g->getSize() << "]";
+        out << "\n";
+    }
+    if (!globals.empty())
+        out << "\n";
+    for (unsigned int i = 0; i < functions.size(); i++) {
+        if (i)
+            out << "\n";
+        functions[i]->print(out);
+    }
+}
+
+bool isIdentifiedObject(Value* ptr) {
+    if (ptr->getKind() == Value::GlobalVal)
+        return true;
+    return ptr->getKind() == Value::InstructionVal &&
+           static_cast<Instruction*>(ptr)->getOpcode() == Instruction::Alloca;
+}
+
+} // namespace smallc
@@ -0,0 +1,348 @@
+//
+//  IR.h
+//  ECE467 Lab 3
+//
+//  SSA intermediate representation. A Module holds global variables and
+//  functions; a Function is a CFG of BasicBlocks; a BasicBlock is a list
+//  of Instructions ending in exactly one terminator (Br, CondBr, Ret).
+//  Every Value keeps the list of Instructions using it so passes can
+//  replace values in place.
+//
+//  Local scalars are SSA values; globals and arrays live in memory and are
+//  accessed with Load/Store (scalars) and LoadElem/StoreElem (elements).
+//
+
+#ifndef IR_h
+#define IR_h
+
+#include <list>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace smallc {
+
+class BasicBlock;
+class Function;
+class Module;
+class Instruction;
+class FunctionDeclNode;
+
+/**********************************************************************************/
+/* The Value Class   (abstract)                                                   */
+/**********************************************************************************/
+class Value {
+public:
+    enum ValueKind { ConstantVal = 0, ArgumentVal, GlobalVal, InstructionVal };
+    enum Type { Void = 0, Int, Bool, Ptr, Vec };    // Vec: getLanes() ints
+
+private:
+    ValueKind kind;
+    Type type;
+    std::vector<Instruction*> users;   // One entry per use
+
+protected:
+    Value(ValueKind kind_, Type type_);
+
+public:
+    virtual ~Value();
+    ValueKind getKind() const;
+    Type getType() const;
+    void setType(Type type_);
+
+    const std::vector<Instruction*>& getUsers() const;
+    unsigned int getNumUses() const;
+    bool hasUses() const;
+    void addUser(Instruction* user);
+    void removeUser(Instruction* user);
+    void replaceAllUsesWith(Value* v);
+
+    static const char* typeName(Type t);
+};
+
+/**********************************************************************************/
+/* The Constant Class                                                             */
+/**********************************************************************************/
+class Constant : public Value {
+private:
+    int val;
+
+public:
+    Constant(Type type_, int val_);
+    int getVal() const;
+};
+
+/**********************************************************************************/
+/* The Argument Class                                                             */
+/**********************************************************************************/
+class Argument : public Value {
+private:
+    std::string name;
+    Function* parent;
+    unsigned int index;
+
+public:
+    Argument(Type type_, const std::string &name_, Function* parent_, unsigned int index_);
+    const std::string& getName() const;
+    Function* getParent();
+    unsigned int getIndex() const;
+};
+
+/**********************************************************************************/
+/* The GlobalVariable Class                                                       */
+/**********************************************************************************/
+// A global is a pointer to its storage: a single element for scalars,
+// getSize() elements for arrays.
+class GlobalVariable : public Value {
+private:
+    std::string name;
+    Type elemType;
+    int size;       // Number of elements, 0 for scalars
+
+public:
+    GlobalVariable(const std::string &name_, Type elemType_, int size_);
+    const std::string& getName() const;
+    Type getElemType() const;
+    int getSize() const;
+    bool isArray() const;
+};
+
+/**********************************************************************************/
+/* The Instruction Class                                                          */
+/**********************************************************************************/
+class Instruction : public Value {
+public:
+    enum Opcode {
+        Add = 0,    // op0 + op1
+        Sub,        // op0 - op1
+        Mul,        // op0 * op1
+        Div,        // op0 / op1, truncating toward zero
+        Neg,        // -op0
+        Not,        // !op0
+        Cmp,        // op0 <pred> op1
+        Phi,        // op[i] when coming from block[i]
+        Call,       // callee(op...)
+        Load,       // *op0
+        Store,      // *op0 = op1
+        LoadElem,   // op0[op1]
+        StoreElem,  // op0[op1] = op2
+        BoundsCheck,// trap unless 0 <= op0 < op1
+        ProfileCount,// bump profile counter op0
+        VecLoad,    // op0[op1 .. op1 + lanes - 1]
+        VecStore,   // op0[op1 .. op1 + lanes - 1] = op2
+        Splat,      // op0 in every lane
+        VecIndex,   // op0, op0 + 1, ..., op0 + lanes - 1
+        HasAVX2,    // Does the CPU running the program support AVX2?
+        VecEnd,     // Vector code of getLanes() width is done with the vector unit
+        Alloca,     // Local array of getAllocSize() elements
+        Br,         // goto block[0]
+        CondBr,     // if (op0) goto block[0] else goto block[1]
+        Ret         // return [op0]
+    };
+
+    enum Predicate { EQ = 0, NE, LT, LE, GT, GE };
+
+private:
+    Opcode opcode;
+    Predicate pred;
+    BasicBlock* parent;
+    std::vector<Value*> operands;
+    std::vector<BasicBlock*> blockOps;  // Branch targets / phi incoming blocks
+    std::string callee;                 // Call target name
+    Function* calleeFn;                 // Call target, nullptr if external
+    int allocSize;                      // Alloca element count
+    std::pair<unsigned int, unsigned int> location;
+    long long profileCount;             // Call: times made; CondBr: times taken; -1 if unknown
+    unsigned int lanes;                 // Vector width of Vec results and VecStore
+
+public:
+    Instruction(Opcode opcode_, Type type_);
+    ~Instruction() override;
+
+    Opcode getOpcode() const;
+    void setOpcode(Opcode opcode_);
+    Predicate getPredicate() const;
+    void setPredicate(Predicate pred_);
+    BasicBlock* getParent();
+    void setParent(BasicBlock* bb);
+    Function* getFunction();
+
+    // Value operands
+    unsigned int getNumOperands() const;
+    Value* getOperand(unsigned int i);
+    void setOperand(unsigned int i, Value* v);
+    void addOperand(Value* v);
+    void removeOperand(unsigned int i);
+    void dropAllOperands();
+
+    // Block operands
+    unsigned int getNumBlockOperands() const;
+    BasicBlock* getBlockOperand(unsigned int i);
+    void setBlockOperand(unsigned int i, BasicBlock* bb);
+    void addBlockOperand(BasicBlock* bb);
+
+    // Phi helpers
+    void addIncoming(Value* v, BasicBlock* bb);
+    Value* getIncomingValueFor(BasicBlock* bb);
+    void removeIncoming(BasicBlock* bb);
+    void replaceIncomingBlock(BasicBlock* from, BasicBlock* to);
+
+    // Call helpers
+    const std::string& getCallee() const;
+    Function* getCalleeFunction();
+    void setCallee(const std::string &name, Function* fn);
+
+    int getAllocSize() const;
+    void setAllocSize(int size);
+
+    unsigned int getLine() const;
+    unsigned int getCol() const;
+    std::pair<unsigned int, unsigned int> getLocation() const;
+    void setLocation(std::pair<unsigned int, unsigned int> loc);
+
+    long long getProfileCount() const;
+    void setProfileCount(long long count);
+
+    unsigned int getLanes() const;
+    void setLanes(unsigned int n);
+
+    // Classification
+    bool isTerminator() const;
+    bool isBinaryOp() const;
+    bool mayWriteMemory() const;
+    bool mayReadMemory() const;
+    bool hasSideEffects() const;
+
+    // Unlink from the parent block and delete
+    void eraseFromParent();
+
+    static const char* opcodeName(Opcode op);
+    static const char* predicateName(Predicate p);
+    static Predicate swapPredicate(Predicate p);
+    static Predicate invertPredicate(Predicate p);
+};
+
+/**********************************************************************************/
+/* The BasicBlock Class                                                           */
+/**********************************************************************************/
+class BasicBlock {
+private:
+    std::string name;
+    Function* parent;
+    std::list<Instruction*> insts;
+    std::vector<BasicBlock*> preds;
+    long long profileCount;             // Times executed, -1 if unknown
+
+public:
+    BasicBlock(const std::string &name_, Function* parent_);
+    ~BasicBlock();
+
+    const std::string& getName() const;
+    void setName(const std::string &name_);
+    Function* getParent();
+
+    std::list<Instruction*>& getInstructions();
+    bool empty() const;
+    Instruction* getTerminator();
+    std::vector<BasicBlock*> getSuccessors();
+    std::vector<BasicBlock*>& getPredecessors();
+    std::vector<Instruction*> getPhis();
+
+    long long getProfileCount() const;
+    void setProfileCount(long long count);
+    bool hasProfileCount() const;
+    // Times control went from this block to succ, -1 if unknown
+    long long getEdgeCount(BasicBlock* succ);
+
+    // Insertion; the block takes ownership
+    void append(Instruction* inst);
+    void insertBefore(Instruction* pos, Instruction* inst);
+    void insertBeforeTerminator(Instruction* inst);
+    void insertAfterPhis(Instruction* inst);
+    // Unlink without deleting
+    void remove(Instruction* inst);
+};
+
+/**********************************************************************************/
+/* The Function Class                                                             */
+/**********************************************************************************/
+class Function {
+private:
+    std::string name;
+    Value::Type retType;
+    std::vector<Argument*> args;
+    std::vector<BasicBlock*> blocks;    // blocks[0] is the entry
+    Module* parent;
+    FunctionDeclNode* decl;             // Source declaration, if any
+    unsigned int nextBlockId;           // Suffix for the next block name
+
+public:
+    Function(const std::string &name_, Value::Type retType_, Module* parent_);
+    ~Function();
+
+    const std::string& getName() const;
+    Value::Type getRetType() const;
+    Module* getParent();
+    FunctionDeclNode* getDecl();
+    void setDecl(FunctionDeclNode* decl_);
+
+    Argument* addArgument(Value::Type type, const std::string &argName);
+    std::vector<Argument*>& getArgs();
+
+    std::vector<BasicBlock*>& getBlocks();
+    BasicBlock* getEntry();
+    BasicBlock* createBlock(const std::string &blockName);
+    void moveBlockAfter(BasicBlock* bb, BasicBlock* pos);
+    void removeBlock(BasicBlock* bb);
+
+    // CFG maintenance
+    void recomputePredecessors();
+    unsigned int removeUnreachableBlocks();
+
+    unsigned int getInstructionCount();
+    void print(std::ostream &out);
+};
+
+/**********************************************************************************/
+/* The Module Class                                                               */
+/**********************************************************************************/
+class Module {
+private:
+    std::vector<Function*> functions;
+    std::vector<GlobalVariable*> globals;
+    std::map<std::pair<int, int>, Constant*> constants;
+    std::vector<std::string> profileKeys;   // One per profile counter
+
+public:
+    Module();
+    ~Module();
+
+    std::vector<Function*>& getFunctions();
+    Function* getFunction(const std::string &name);
+    Function* createFunction(const std::string &name, Value::Type retType);
+    void removeFunction(Function* fn);
+
+    std::vector<GlobalVariable*>& getGlobals();
+    GlobalVariable* createGlobal(const std::string &name, Value::Type elemType, int size);
+
+    // Constants are uniqued per module
+    Constant* getConstant(Value::Type type, int val);
+    Constant* getInt(int val);
+    Constant* getBool(bool val);
+
+    // Profile counters added by instrumentation, identified by their keys
+    unsigned int addProfileCounter(const std::string &key);
+    const std::vector<std::string>& getProfileKeys();
+
+    unsigned int getInstructionCount();
+    void print(std::ostream &out);
+};
+
+// Globals and allocas are distinct memory objects; any other pointer (an
+// array parameter) may point into any array
+bool isIdentifiedObject(Value* ptr);
+
+} // namespace smallc
+
+#endif /* IR_h */
@@ -0,0 +1,611 @@
+//
+//  IRGen.cpp
+//  ECE467 Lab 3
+//
+//  Lowers a semantically checked ProgramNode to SSA IR.
+//
+
+#include <algorithm>
+
+#include "IRGen.h"
+
+namespace smallc {
+
+IRGen::IRGen() : ASTVisitorBase(), module(new Module()), fn(nullptr), curBlock(nullptr), value(nullptr),
+                 arrayLen(nullptr), boundsChecks(false), pruneFunctions(false) {}
+
+IRGen::~IRGen() {
+    delete module;
+}
+
+Module* IRGen::releaseModule() {
+    Module* m = module;
+    module = nullptr;
+    return m;
+}
+
+void IRGen::setBoundsChecks(bool flag) {
+    boundsChecks = flag;
+}
+
+void IRGen::setLiveFunctions(const std::set<std::string> &names) {
+    pruneFunctions = true;
+    liveFunctions = names;
+}
+
+Value::Type IRGen::irType(TypeNode::TypeEnum type) {
+    switch (type) {
+        case TypeNode::Int:  return Value::Int;
+        case TypeNode::Bool: return Value::Bool;
+        default:             return Value::Void;
+    }
+}
+
+/**********************************************************************************/
+/* SSA construction                                                               */
+/**********************************************************************************/
+
+void IRGen::writeVariable(int var, BasicBlock* bb, Value* v) {
+    currentDef[bb][var] = v;
+}
+
+Value* IRGen::resolve(Value* v) {
+    auto it = replacedPhis.find(v);
+    while (it != replacedPhis.end()) {
+        v = it->second;
+        it = replacedPhis.find(v);
+    }
+    return v;
+}
+
+Value* IRGen::readVariable(int var, BasicBlock* bb) {
+    auto &defs = currentDef[bb];
+    auto it = defs.find(var);
+    if (it != defs.end())
+        return resolve(it->second);
+    return readVariableRecursive(var, bb);
+}
+
+Value* IRGen::readVariableRecursive(int var, BasicBlock* bb) {
+    Value* val;
+    std::vector<BasicBlock*> &preds = bb->getPredecessors();
+    if (!sealed.count(bb)) {
+        // Not all predecessors are known yet: complete the phi on sealing
+        Instruction* phi = new Instruction(Instruction::Phi, varTypes[var]);
+        bb->insertAfterPhis(phi);
+        incompletePhis[bb][var] = phi;
+        val = phi;
+    }
+    else if (preds.empty()) {
+        // Unreachable code; any value will do
+        val = module->getConstant(varTypes[var], 0);
+    }
+    else if (preds.size() == 1) {
+        val = readVariable(var, preds[0]);
+    }
+    else {
+        // Break cycles through loops with an operandless phi first
+        Instruction* phi = new Instruction(Instruction::Phi, varTypes[var]);
+        bb->insertAfterPhis(phi);
+        writeVariable(var, bb, phi);
+        val = addPhiOperands(var, phi);
+    }
+    writeVariable(var, bb, val);
+    return val;
+}
+
+Value* IRGen::addPhiOperands(int var, Instruction* phi) {
+    phisUnderConstruction.insert(phi);
+    std::vector<BasicBlock*> preds = phi->getParent()->getPredecessors();
+    for (auto pred : preds)
+        phi->addIncoming(readVariable(var, pred), pred);
+    phisUnderConstruction.erase(phi);
+    return tryRemoveTrivialPhi(phi);
+}
+
+Value* IRGen::tryRemoveTrivialPhi(Instruction* phi) {
+    if (phisUnderConstruction.count(phi))
+        return phi;
+    Value* same = nullptr;
+    for (unsigned int i = 0; i < phi->getNumOperands(); i++) {
+        Value* op = phi->getOperand(i);
+        if (op == same || op == phi)
+            continue;
+        if (same)
+            return phi;     // Merges at least two values: not trivial
+        same = op;
+    }
+    if (!same)
+        same = module->getConstant(phi->getType(), 0);
+
+    std::vector<Instruction*> users;
+    for (auto user : phi->getUsers()) {
+        if (user != phi && std::find(users.begin(), users.end(), user) == users.end())
+            users.push_back(user);
+    }
+    phi->replaceAllUsesWith(same);
+    replacedPhis[phi] = same;
+    phi->getParent()->remove(phi);
+    phi->dropAllOperands();
+    deadPhis.push_back(phi);
+
+    // Removing this phi may have made the phis using it trivial too
+    for (auto user : users) {
+        if (user->getOpcode() == Instruction::Phi && user->getParent())
+            tryRemoveTrivialPhi(user);
+    }
+    return same;
+}
+
+void IRGen::sealBlock(BasicBlock* bb) {
+    sealed.insert(bb);
+    auto pending = incompletePhis[bb];
+    incompletePhis.erase(bb);
+    for (auto &p : pending)
+        addPhiOperands(p.first, p.second);
+}
+
+void IRGen::finishFunction() {
+    for (auto phi : deadPhis)
+        delete phi;
+    fn->removeUnreachableBlocks();
+    fn->recomputePredecessors();
+
+    varTypes.clear();
+    currentDef.clear();
+    incompletePhis.clear();
+    sealed.clear();
+    phisUnderConstruction.clear();
+    replacedPhis.clear();
+    deadPhis.clear();
+}
+
+/**********************************************************************************/
+/* Helpers                                                                        */
+/**********************************************************************************/
+
+bool IRGen::terminated() {
+    return curBlock->getTerminator() != nullptr;
+}
+
+Instruction* IRGen::emit(Instruction* inst, ASTNode* node) {
+    // Code after a return is unreachable but must still be well formed
+    if (terminated()) {
+        curBlock = fn->createBlock("dead");
+        sealBlock(curBlock);
+    }
+    curBlock->append(inst);
+    if (node)
+        inst->setLocation(node->getLocation());
+    return inst;
+}
+
+void IRGen::branch(BasicBlock* target, ASTNode* node) {
+    Instruction* br = emit(new Instruction(Instruction::Br, Value::Void), node);
+    br->addBlockOperand(target);
+    target->getPredecessors().push_back(br->getParent());
+}
+
+void IRGen::condBranch(Value* cond, BasicBlock* ifTrue, BasicBlock* ifFalse, ASTNode* node) {
+    if (ifTrue == ifFalse)
+        return branch(ifTrue, node);
+    Instruction* br = emit(new Instruction(Instruction::CondBr, Value::Void), node);
+    br->addOperand(cond);
+    br->addBlockOperand(ifTrue);
+    br->addBlockOperand(ifFalse);
+    ifTrue->getPredecessors().push_back(br->getParent());
+    ifFalse->getPredecessors().push_back(br->getParent());
+}
+
+IRGen::VarInfo& IRGen::lookup(const std::string &name) {
+    for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
+        auto found = it->find(name);
+        if (found != it->end())
+            return found->second;
+    }
+    // Sema guarantees every name is declared
+    return scopes.front()[name];
+}
+
+Value* IRGen::genExpr(ExprNode* expr) {
+    expr->visit(this);
+    return resolve(value);
+}
+
+static bool isComparison(ExprNode::Opcode op, Instruction::Predicate &pred) {
+    switch (op) {
+        case ExprNode::Equal:          pred = Instruction::EQ; return true;
+        case ExprNode::NotEqual:       pred = Instruction::NE; return true;
+        case ExprNode::LessThan:       pred = Instruction::LT; return true;
+        case ExprNode::LessorEqual:    pred = Instruction::LE; return true;
+        case ExprNode::Greater:        pred = Instruction::GT; return true;
+        case ExprNode::GreaterorEqual: pred = Instruction::GE; return true;
+        default:                       return false;
+    }
+}
+
+// Branch to ifTrue or ifFalse on the value of a condition, with
+// short-circuit evaluation of && and ||
+void IRGen::genCond(ExprNode* expr, BasicBlock* ifTrue, BasicBlock* ifFalse) {
+    if (auto wrap = dynamic_cast<BoolExprNode*>(expr))
+        return genCond(wrap->getValue(), ifTrue, ifFalse);
+    if (auto wrap = dynamic_cast<IntExprNode*>(expr))
+        return genCond(wrap->getValue(), ifTrue, ifFalse);
+
+    if (auto unary = dynamic_cast<UnaryExprNode*>(expr)) {
+        if (unary->getOpcode() == ExprNode::Not)
+            return genCond(unary->getOperand(), ifFalse, ifTrue);
+    }
+
+    if (auto bin = dynamic_cast<BinaryExprNode*>(expr)) {
+        if (bin->getOpcode() == ExprNode::And || bin->getOpcode() == ExprNode::Or) {
+            BasicBlock* rhs = fn->createBlock("cond");
+            if (bin->getOpcode() == ExprNode::And)
+                genCond(bin->getLeft(), rhs, ifFalse);
+            else
+                genCond(bin->getLeft(), ifTrue, rhs);
+            sealBlock(rhs);
+            curBlock = rhs;
+            return genCond(bin->getRight(), ifTrue, ifFalse);
+        }
+    }
+
+    condBranch(genExpr(expr), ifTrue, ifFalse, expr);
+}
+
+void IRGen::checkBounds(VarInfo &var, Value* index, ASTNode* node) {
+    if (!boundsChecks)
+        return;
+    Instruction* check = new Instruction(Instruction::BoundsCheck, Value::Void);
+    check->addOperand(index);
+    check->addOperand(var.len);
+    emit(check, node);
+}
+
+void IRGen::declareLocal(DeclNode* decl) {
+    VarInfo var;
+    var.type = irType(decl->getType()->getTypeEnum());
+    var.len = nullptr;
+    if (decl->getType()->isArray()) {
+        // Arrays are allocated once in the entry block, even inside loops
+        var.kind = VarInfo::LocalArray;
+        Instruction* alloca = new Instruction(Instruction::Alloca, Value::Ptr);
+        alloca->setAllocSize(static_cast<ArrayTypeNode*>(decl->getType())->getSize());
+        alloca->setLocation(decl->getLocation());
+        fn->getEntry()->insertAfterPhis(alloca);
+        var.addr = alloca;
+        var.len = module->getInt(alloca->getAllocSize());
+    }
+    else {
+        // Scalars start out as zero so every use has a reaching definition
+        var.kind = VarInfo::Local;
+        var.var = (int)varTypes.size();
+        var.addr = nullptr;
+        varTypes.push_back(var.type);
+        writeVariable(var.var, curBlock, module->getConstant(var.type, 0));
+    }
+    scopes.back()[decl->getIdent()->getName()] = var;
+}
+
+/**********************************************************************************/
+/* Declarations                                                                   */
+/**********************************************************************************/
+
+void IRGen::visitProgramNode(ProgramNode *prg) {
+    // The I/O library functions provided by the scio runtime
+    retTypes["readInt"] = Value::Int;
+    retTypes["readBool"] = Value::Bool;
+    retTypes["writeInt"] = Value::Void;
+    retTypes["writeBool"] = Value::Void;
+    retTypes["newLine"] = Value::Void;
+    for (unsigned int i = 0; i < prg->getNumChildren(); i++) {
+        auto func = dynamic_cast<FunctionDeclNode*>(prg->getChild(i));
+        if (func)
+            retTypes[func->getIdent()->getName()] = irType(func->getRetType()->getTypeEnum());
+    }
+
+    scopes.push_back(std::map<std::string, VarInfo>());
+    ASTVisitorBase::visitProgramNode(prg);
+    scopes.pop_back();
+
+    // Bind calls to functions defined later in the file
+    for (auto f : module->getFunctions()) {
+        for (auto bb : f->getBlocks()) {
+            for (auto inst : bb->getInstructions()) {
+                if (inst->getOpcode() == Instruction::Call)
+                    inst->setCallee(inst->getCallee(), module->getFunction(inst->getCallee()));
+            }
+        }
+    }
+}
+
+void IRGen::visitFunctionDeclNode(FunctionDeclNode *func) {
+    if (func->getProto() || func->getBody() == nullptr)
+        return;
+    const std::string &name = func->getIdent()->getName();
+    if (pruneFunctions && !liveFunctions.count(name))
+        return;
+    fn = module->createFunction(name, irType(func->getRetType()->getTypeEnum()));
+    fn->setDecl(func);
+    curBlock = fn->createBlock("entry");
+    sealBlock(curBlock);
+
+    scopes.push_back(std::map<std::string, VarInfo>());
+    for (auto param : func->getParams()) {
+        VarInfo var;
+        var.type = irType(param->getType()->getTypeEnum());
+        var.len = nullptr;
+        const std::string &paramName = param->getIdent()->getName();
+        if (param->getType()->isArray()) {
+            var.kind = VarInfo::ParamArray;
+            var.addr = fn->addArgument(Value::Ptr, paramName);
+            if (boundsChecks)
+                var.len = fn->addArgument(Value::Int, paramName + ".len");
+        }
+        else {
+            var.kind = VarInfo::Local;
+            var.var = (int)varTypes.size();
+            var.addr = nullptr;
+            varTypes.push_back(var.type);
+            writeVariable(var.var, curBlock, fn->addArgument(var.type, paramName));
+        }
+        scopes.back()[paramName] = var;
+    }
+
+    func->getBody()->visit(this);
+    if (!terminated()) {
+        Instruction* ret = emit(new Instruction(Instruction::Ret, Value::Void), func);
+        if (fn->getRetType() != Value::Void)
+            ret->addOperand(module->getConstant(fn->getRetType(), 0));
+    }
+    scopes.pop_back();
+    finishFunction();
+    fn = nullptr;
+    curBlock = nullptr;
+}
+
+void IRGen::visitScalarDeclNode(ScalarDeclNode *scalar) {
+    if (fn) {
+        declareLocal(scalar);
+        return;
+    }
+    VarInfo var;
+    var.kind = VarInfo::Global;
+    var.type = irType(scalar->getType()->getTypeEnum());
+    var.len = nullptr;
+    var.addr = module->createGlobal(scalar->getIdent()->getName(), var.type, 0);
+    scopes.back()[scalar->getIdent()->getName()] = var;
+}
+
+void IRGen::visitArrayDeclNode(ArrayDeclNode *array) {
+    if (fn) {
+        declareLocal(array);
+        return;
+    }
+    VarInfo var;
+    var.kind = VarInfo::GlobalArray;
+    var.type = irType(array->getType()->getTypeEnum());
+    var.addr = module->createGlobal(array->getIdent()->getName(), var.type, array->getType()->getSize());
+    var.len = module->getInt(array->getType()->getSize());
+    scopes.back()[array->getIdent()->getName()] = var;
+}
+
+/**********************************************************************************/
+/* Statements                                                                     */
+/**********************************************************************************/
+
+void IRGen::visitScopeNode(ScopeNode *scope) {
+    scopes.push_back(std::map<std::string, VarInfo>());
+    for (auto decl : scope->getDeclarations())
+        decl->visit(this);
+    for (unsigned int i = 0; i < scope->getNumChildren(); i++) {
+        if (scope->getChild(i))
+            scope->getChild(i)->visit(this);
+    }
+    scopes.pop_back();
+}
+
+void IRGen::visitAssignStmtNode(AssignStmtNode *assign) {
+    ReferenceExprNode* target = assign->getTarget();
+    VarInfo &var = lookup(target->getIdent()->getName());
+    if (target->getIndex()) {
+        Value* index = genExpr(target->getIndex());
+        Value* val = genExpr(assign->getValue());
+        checkBounds(var, resolve(index), target);
+        Instruction* store = new Instruction(Instruction::StoreElem, Value::Void);
+        store->addOperand(var.addr);
+        store->addOperand(resolve(index));
+        store->addOperand(val);
+        emit(store, assign);
+        return;
+    }
+    Value* val = genExpr(assign->getValue());
+    if (var.kind == VarInfo::Global) {
+        Instruction* store = new Instruction(Instruction::Store, Value::Void);
+        store->addOperand(var.addr);
+        store->addOperand(val);
+        emit(store, assign);
+        return;
+    }
+    if (terminated()) {
+        curBlock = fn->createBlock("dead");
+        sealBlock(curBlock);
+    }
+    writeVariable(var.var, curBlock, val);
+}
+
+void IRGen::visitExprStmtNode(ExprStmtNode *expr) {
+    genExpr(expr->getExpr());
+}
+
+void IRGen::visitIfStmtNode(IfStmtNode *ifStmt) {
+    BasicBlock* thenBlock = fn->createBlock("then");
+    BasicBlock* elseBlock = ifStmt->getHasElse() ? fn->createBlock("else") : nullptr;
+    BasicBlock* joinBlock = fn->createBlock("endif");
+    genCond(ifStmt->getCondition(), thenBlock, elseBlock ? elseBlock : joinBlock);
+    sealBlock(thenBlock);
+
+    curBlock = thenBlock;
+    ifStmt->getThen()->visit(this);
+    if (!terminated())
+        branch(joinBlock, ifStmt);
+    if (elseBlock) {
+        sealBlock(elseBlock);
+        curBlock = elseBlock;
+        ifStmt->getElse()->visit(this);
+        if (!terminated())
+            branch(joinBlock, ifStmt);
+    }
+    sealBlock(joinBlock);
+    curBlock = joinBlock;
+}
+
+void IRGen::visitWhileStmtNode(WhileStmtNode *whileStmt) {
+    BasicBlock* condBlock = fn->createBlock("while");
+    BasicBlock* bodyBlock = fn->createBlock("body");
+    BasicBlock* exitBlock = fn->createBlock("endwhile");
+
+    branch(condBlock, whileStmt);
+    curBlock = condBlock;
+    genCond(whileStmt->getCondition(), bodyBlock, exitBlock);
+    sealBlock(bodyBlock);
+    sealBlock(exitBlock);
+
+    curBlock = bodyBlock;
+    whileStmt->getBody()->visit(this);
+    if (!terminated())
+        branch(condBlock, whileStmt);
+    // The back edge is known now
+    sealBlock(condBlock);
+    curBlock = exitBlock;
+}
+
+void IRGen::visitReturnStmtNode(ReturnStmtNode *ret) {
+    Value* val = ret->returnVoid() ? nullptr : genExpr(ret->getReturn());
+    Instruction* inst = new Instruction(Instruction::Ret, Value::Void);
+    if (val)
+        inst->addOperand(val);
+    emit(inst, ret);
+}
+
+/**********************************************************************************/
+/* Expressions                                                                    */
+/**********************************************************************************/
+
+void IRGen::visitBinaryExprNode(BinaryExprNode *bin) {
+    Instruction::Predicate pred;
+    ExprNode::Opcode op = bin->getOpcode();
+
+    if (op == ExprNode::And || op == ExprNode::Or) {
+        BasicBlock* trueBlock = fn->createBlock("true");
+        BasicBlock* falseBlock = fn->createBlock("false");
+        BasicBlock* joinBlock = fn->createBlock("join");
+        genCond(bin, trueBlock, falseBlock);
+        sealBlock(trueBlock);
+        sealBlock(falseBlock);
+        curBlock = trueBlock;
+        branch(joinBlock, bin);
+        curBlock = falseBlock;
+        branch(joinBlock, bin);
+        sealBlock(joinBlock);
+        curBlock = joinBlock;
+
+        Instruction* phi = new Instruction(Instruction::Phi, Value::Bool);
+        phi->addIncoming(module->getBool(true), trueBlock);
+        phi->addIncoming(module->getBool(false), falseBlock);
+        joinBlock->insertAfterPhis(phi);
+        value = phi;
+        return;
+    }
+
+    Value* left = genExpr(bin->getLeft());
+    Value* right = genExpr(bin->getRight());
+    Instruction* inst;
+    if (isComparison(op, pred)) {
+        inst = new Instruction(Instruction::Cmp, Value::Bool);
+        inst->setPredicate(pred);
+    }
+    else {
+        Instruction::Opcode opcode = Instruction::Add;
+        if (op == ExprNode::Subtraction)
+            opcode = Instruction::Sub;
+        else if (op == ExprNode::Multiplication)
+            opcode = Instruction::Mul;
+        else if (op == ExprNode::Division)
+            opcode = Instruction::Div;
+        inst = new Instruction(opcode, Value::Int);
+    }
+    inst->addOperand(resolve(left));
+    inst->addOperand(right);
+    value = emit(inst, bin);
+}
+
+void IRGen::visitUnaryExprNode(UnaryExprNode *unary) {
+    bool isNot = unary->getOpcode() == ExprNode::Not;
+    Instruction* inst = new Instruction(isNot ? Instruction::Not : Instruction::Neg,
+                                        isNot ? Value::Bool : Value::Int);
+    inst->addOperand(genExpr(unary->getOperand()));
+    value = emit(inst, unary);
+}
+
+void IRGen::visitBoolExprNode(BoolExprNode *boolExpr) {
+    boolExpr->getValue()->visit(this);
+}
+
+void IRGen::visitIntExprNode(IntExprNode *intExpr) {
+    intExpr->getValue()->visit(this);
+}
+
+void IRGen::visitIntConstantNode(IntConstantNode *intConst) {
+    value = module->getInt(intConst->getVal());
+}
+
+void IRGen::visitBoolConstantNode(BoolConstantNode *boolConst) {
+    value = module->getBool(boolConst->getVal() != 0);
+}
+
+void IRGen::visitReferenceExprNode(ReferenceExprNode *ref) {
+    VarInfo &var = lookup(ref->getIdent()->getName());
+    if (ref->getIndex()) {
+        Value* index = genExpr(ref->getIndex());
+        checkBounds(var, index, ref);
+        Instruction* load = new Instruction(Instruction::LoadElem, var.type);
+        load->addOperand(var.addr);
+        load->addOperand(index);
+        value = emit(load, ref);
+    }
+    else if (var.kind == VarInfo::Local) {
+        if (terminated()) {
+            curBlock = fn->createBlock("dead");
+            sealBlock(curBlock);
+        }
+        value = readVariable(var.var, curBlock);
+    }
+    else if (var.kind == VarInfo::Global) {
+        Instruction* load = new Instruction(Instruction::Load, var.type);
+        load->addOperand(var.addr);
+        value = emit(load, ref);
+    }
+    else {
+        // A whole array, passed by reference as an argument
+        value = var.addr;
+        arrayLen = var.len;
+    }
+}
+
+void IRGen::visitCallExprNode(CallExprNode *call) {
+    const std::string &name = call->getIdent()->getName();
+    std::vector<Value*> args;
+    for (auto arg : call->getArguments()) {
+        args.push_back(genExpr(arg->getExpr()));
+        if (boundsChecks && args.back()->getType() == Value::Ptr)
+            args.push_back(arrayLen);
+    }
+    Instruction* inst = new Instruction(Instruction::Call, retTypes[name]);
+    inst->setCallee(name, nullptr);
+    for (auto arg : args)
+        inst->addOperand(resolve(arg));
+    value = emit(inst, call);
+}
+
+} // namespace smallc
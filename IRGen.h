@@ -0,0 +1,118 @@
+//
+//  IRGen.h
+//  ECE467 Lab 3
+//
+//  Lowers a semantically checked ProgramNode to the SSA IR in IR.h.
+//  SSA form is built on the fly while lowering, following Braun et al.,
+//  "Simple and Efficient Construction of Static Single Assignment Form"
+//  (CC 2013): local scalars are tracked per block, phis are placed on
+//  demand and trivial phis are removed as soon as they are complete.
+//
+//  With bounds checks enabled every element access is preceded by a
+//  BoundsCheck, and each array parameter is followed by a hidden int
+//  parameter holding its length, which callers pass along.
+//
+
+#ifndef IRGen_h
+#define IRGen_h
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ASTNodes.h"
+#include "ASTVisitorBase.h"
+#include "IR.h"
+
+namespace smallc {
+
+class IRGen final : public ASTVisitorBase {
+private:
+    // What a name in scope refers to
+    class VarInfo {
+    public:
+        enum Kind { Local = 0, LocalArray, ParamArray, Global, GlobalArray };
+        Kind kind;
+        int var;            // SSA variable number, for Local
+        Value* addr;        // Storage for everything else
+        Value::Type type;   // Scalar or element type
+        Value* len;         // Array length, when bounds checking
+    };
+
+    Module* module;
+    Function* fn;                       // Function being lowered
+    BasicBlock* curBlock;               // Block being filled
+    Value* value;                       // Result of the last expression
+    Value* arrayLen;                    // Length of value, if it is a whole array
+    bool boundsChecks;
+    bool pruneFunctions;                // Lower only the functions in liveFunctions
+    std::set<std::string> liveFunctions;
+    std::vector<std::map<std::string, VarInfo> > scopes;
+    std::map<std::string, Value::Type> retTypes;    // Callee name -> return type
+
+    // SSA construction state, per function
+    std::vector<Value::Type> varTypes;
+    std::map<BasicBlock*, std::map<int, Value*> > currentDef;
+    std::map<BasicBlock*, std::map<int, Instruction*> > incompletePhis;
+    std::set<BasicBlock*> sealed;
+    std::set<Instruction*> phisUnderConstruction;
+    std::map<Value*, Value*> replacedPhis;  // Removed trivial phi -> replacement
+    std::vector<Instruction*> deadPhis;
+
+    void writeVariable(int var, BasicBlock* bb, Value* v);
+    Value* readVariable(int var, BasicBlock* bb);
+    Value* readVariableRecursive(int var, BasicBlock* bb);
+    Value* addPhiOperands(int var, Instruction* phi);
+    Value* tryRemoveTrivialPhi(Instruction* phi);
+    Value* resolve(Value* v);
+    void sealBlock(BasicBlock* bb);
+    void finishFunction();
+
+    Instruction* emit(Instruction* inst, ASTNode* node);
+    void branch(BasicBlock* target, ASTNode* node);
+    void condBranch(Value* cond, BasicBlock* ifTrue, BasicBlock* ifFalse, ASTNode* node);
+    bool terminated();
+    VarInfo& lookup(const std::string &name);
+    Value* genExpr(ExprNode* expr);
+    void genCond(ExprNode* expr, BasicBlock* ifTrue, BasicBlock* ifFalse);
+    void declareLocal(DeclNode* decl);
+    void checkBounds(VarInfo &var, Value* index, ASTNode* node);
+
+public:
+    IRGen();
+    ~IRGen();
+
+    // Hand the generated module to the caller
+    Module* releaseModule();
+
+    // Check array indices at run time
+    void setBoundsChecks(bool flag);
+    // Lower only these functions; the others are never called
+    void setLiveFunctions(const std::set<std::string> &names);
+
+    static Value::Type irType(TypeNode::TypeEnum type);
+
+    void visitProgramNode(ProgramNode *prg) override;
+    void visitFunctionDeclNode(FunctionDeclNode *func) override;
+    void visitScalarDeclNode(ScalarDeclNode *scalar) override;
+    void visitArrayDeclNode(ArrayDeclNode *array) override;
+    void visitScopeNode(ScopeNode *scope) override;
+    void visitAssignStmtNode(AssignStmtNode *assign) override;
+    void visitExprStmtNode(ExprStmtNode *expr) override;
+    void visitIfStmtNode(IfStmtNode *ifStmt) override;
+    void visitWhileStmtNode(WhileStmtNode *whileStmt) override;
+    void visitReturnStmtNode(ReturnStmtNode *ret) override;
+    void visitBinaryExprNode(BinaryExprNode *bin) override;
+    void visitUnaryExprNode(UnaryExprNode *unary) override;
+    void visitBoolExprNode(BoolExprNode *boolExpr) override;
+    void visitIntExprNode(IntExprNode *intExpr) override;
+    void visitIntConstantNode(IntConstantNode *intConst) override;
+    void visitBoolConstantNode(BoolConstantNode *boolConst) override;
+    void visitReferenceExprNode(ReferenceExprNode *ref) override;
+    void visitCallExprNode(CallExprNode *call) override;
+};
+
+} // namespace smallc
+
+#endif /* IRGen_h */
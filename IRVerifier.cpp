@@ -0,0 +1,102 @@
+//
+//  IRVerifier.cpp
+//  ECE467 Lab 3
+//
+//  Structural checks on the SSA IR.
+//
+
+#include <algorithm>
+#include <set>
+
+#include "IRVerifier.h"
+#include "Dominators.h"
+
+namespace smallc {
+
+bool verifyFunction(Function* fn, std::ostream &errs) {
+    bool ok = true;
+    auto fail = [&](BasicBlock* bb, const std::string &msg) {
+        errs << "verifier: @" << fn->getName() << " %" << bb->getName() << ": " << msg << "\n";
+        ok = false;
+    };
+
+    std::set<BasicBlock*> blocks(fn->getBlocks().begin(), fn->getBlocks().end());
+    std::set<Value*> defined(fn->getArgs().begin(), fn->getArgs().end());
+    for (auto bb : fn->getBlocks()) {
+        for (auto inst : bb->getInstructions())
+            defined.insert(inst);
+    }
+
+    DominatorTree dt(fn);
+    for (auto bb : fn->getBlocks()) {
+        if (!bb->getTerminator()) {
+            fail(bb, "block does not end in a terminator");
+            continue;
+        }
+
+        std::vector<BasicBlock*> preds = bb->getPredecessors();
+        std::sort(preds.begin(), preds.end());
+        bool seenNonPhi = false;
+        for (auto inst : bb->getInstructions()) {
+            std::string what = Instruction::opcodeName(inst->getOpcode());
+            if (inst->getParent() != bb)
+                fail(bb, what + " has a stale parent pointer");
+            if (inst->isTerminator() && inst != bb->getTerminator())
+                fail(bb, "terminator in the middle of the block");
+            for (unsigned int i = 0; i < inst->getNumBlockOperands(); i++) {
+                if (!blocks.count(inst->getBlockOperand(i)))
+                    fail(bb, what + " refers to a block outside the function");
+            }
+
+            if (inst->getOpcode() == Instruction::Phi) {
+                if (seenNonPhi)
+                    fail(bb, "phi after a non-phi instruction");
+                std::vector<BasicBlock*> incoming;
+                for (unsigned int i = 0; i < inst->getNumBlockOperands(); i++)
+                    incoming.push_back(inst->getBlockOperand(i));
+                std::sort(incoming.begin(), incoming.end());
+                if (incoming != preds)
+                    fail(bb, "phi incoming blocks do not match the predecessors");
+            }
+            else
+                seenNonPhi = true;
+
+            for (unsigned int i = 0; i < inst->getNumOperands(); i++) {
+                Value* op = inst->getOperand(i);
+                if (!op) {
+                    fail(bb, what + " has a null operand");
+                    continue;
+                }
+                const std::vector<Instruction*> &users = op->getUsers();
+                if (std::find(users.begin(), users.end(), inst) == users.end())
+                    fail(bb, what + " is missing from the use list of its operand");
+                if (op->getKind() == Value::ArgumentVal || op->getKind() == Value::InstructionVal) {
+                    if (!defined.count(op)) {
+                        fail(bb, what + " uses a value defined outside the function");
+                        continue;
+                    }
+                }
+                if (op->getKind() != Value::InstructionVal)
+                    continue;
+                Instruction* def = static_cast<Instruction*>(op);
+                if (inst->getOpcode() == Instruction::Phi) {
+                    BasicBlock* from = inst->getBlockOperand(i);
+                    if (!dt.dominates(def->getParent(), from))
+                        fail(bb, "phi operand does not dominate the incoming edge");
+                }
+                else if (!dt.dominates(def, inst))
+                    fail(bb, what + " operand does not dominate its use");
+            }
+        }
+    }
+    return ok;
+}
+
+bool verifyModule(Module* m, std::ostream &errs) {
+    bool ok = true;
+    for (auto fn : m->getFunctions())
+        ok &= verifyFunction(fn, errs);
+    return ok;
+}
+
+} // namespace smallc
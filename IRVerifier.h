@@ -0,0 +1,25 @@
+//
+//  IRVerifier.h
+//  ECE467 Lab 3
+//
+//  Structural checks on the SSA IR: well-formed blocks, phis matching
+//  predecessors, consistent use lists and definitions dominating uses.
+//  Problems are written to errs; the functions return false if any
+//  were found.
+//
+
+#ifndef IRVerifier_h
+#define IRVerifier_h
+
+#include <ostream>
+
+#include "IR.h"
+
+namespace smallc {
+
+bool verifyFunction(Function* fn, std::ostream &errs);
+bool verifyModule(Module* m, std::ostream &errs);
+
+} // namespace smallc
+
+#endif /* IRVerifier_h */
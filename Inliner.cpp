@@ -0,0 +1,268 @@
+//
+//  Inliner.cpp
+//  ECE467 Lab 3
+//
+//  Cost-driven function inlining.
+//
+
+#include <algorithm>
+#include <iterator>
+
+#include "Inliner.h"
+#include "Dominators.h"
+#include "LoopInfo.h"
+
+namespace smallc {
+
+Inliner::Inliner() : report(nullptr), threshold(25), sizeBudget(0), moduleSize(0), hottestCall(-1),
+                     numInlined(0), numCallSites(0), numDeleted(0) {}
+
+const char* Inliner::getName() const { return "inline"; }
+
+void Inliner::setReport(std::ostream* out) { report = out; }
+
+void Inliner::setThreshold(unsigned int cost) { threshold = cost; }
+
+void Inliner::printStatistics(std::ostream &out) {
+    out << "inline: " << numInlined << " of " << numCallSites << " call sites inlined, "
+        << numDeleted << " functions deleted\n";
+}
+
+// Instructions added by inlining, less the call and return that go away
+// and the argument copies the call needed
+unsigned int Inliner::callCost(Instruction* call) {
+    unsigned int size = call->getCalleeFunction()->getInstructionCount();
+    unsigned int saved = call->getNumOperands() + 2;
+    return size > saved ? size - saved : 0;
+}
+
+// Within a tenth of the most frequent call in the profile
+bool Inliner::isHot(long long count) {
+    return hottestCall > 0 && count * 10 >= hottestCall;
+}
+
+/**********************************************************************************/
+/* Inlining                                                                       */
+/**********************************************************************************/
+
+void Inliner::inlineCall(Instruction* call) {
+    BasicBlock* bb = call->getParent();
+    Function* caller = bb->getParent();
+    Function* callee = call->getCalleeFunction();
+
+    // Everything after the call continues in a new block
+    BasicBlock* cont = caller->createBlock(callee->getName() + ".cont");
+    cont->setProfileCount(bb->getProfileCount());
+    auto pos = std::find(bb->getInstructions().begin(), bb->getInstructions().end(), call);
+    std::vector<Instruction*> tail(std::next(pos), bb->getInstructions().end());
+    for (auto inst : tail) {
+        bb->remove(inst);
+        cont->append(inst);
+    }
+    for (auto succ : cont->getSuccessors()) {
+        for (auto phi : succ->getPhis())
+            phi->replaceIncomingBlock(bb, cont);
+    }
+
+    // Copy the callee's blocks; operands are filled in once every value has
+    // its copy, since phis refer to values defined further on
+    std::map<Value*, Value*> values;
+    std::map<BasicBlock*, BasicBlock*> blocks;
+    for (unsigned int i = 0; i < callee->getArgs().size(); i++)
+        values[callee->getArgs()[i]] = call->getOperand(i);
+    for (auto cb : callee->getBlocks())
+        blocks[cb] = caller->createBlock(callee->getName() + "." + cb->getName());
+
+    // The copy runs for this call's share of the callee's profile
+    long long calls = call->getProfileCount();
+    long long entries = callee->getEntry()->getProfileCount();
+    auto scaled = [&](long long count) -> long long {
+        if (count < 0 || calls < 0 || entries <= 0)
+            return -1;
+        return (long long)((double)count * calls / entries);
+    };
+    for (auto cb : callee->getBlocks())
+        blocks[cb]->setProfileCount(scaled(cb->getProfileCount()));
+
+    std::vector<std::pair<Instruction*, Instruction*> > copies;
+    std::vector<std::pair<Value*, BasicBlock*> > returns;
+    for (auto cb : callee->getBlocks()) {
+        for (auto inst : cb->getInstructions()) {
+            if (inst->getOpcode() == Instruction::Ret) {
+                Instruction* br = new Instruction(Instruction::Br, Value::Void);
+                br->addBlockOperand(cont);
+                br->setLocation(inst->getLocation());
+                blocks[cb]->append(br);
+                if (inst->getNumOperands() > 0)
+                    returns.push_back(std::make_pair(inst->getOperand(0), blocks[cb]));
+                continue;
+            }
+            Instruction* copy = new Instruction(inst->getOpcode(), inst->getType());
+            copy->setPredicate(inst->getPredicate());
+            copy->setCallee(inst->getCallee(), inst->getCalleeFunction());
+            copy->setAllocSize(inst->getAllocSize());
+            copy->setLocation(inst->getLocation());
+            copy->setProfileCount(scaled(inst->getProfileCount()));
+            // Arrays are allocated once per frame, wherever the call is
+            if (inst->getOpcode() == Instruction::Alloca)
+                caller->getEntry()->insertAfterPhis(copy);
+            else
+                blocks[cb]->append(copy);
+            values[inst] = copy;
+            copies.push_back(std::make_pair(inst, copy));
+        }
+    }
+    auto mapped = [&](Value* v) {
+        auto it = values.find(v);
+        return it == values.end() ? v : it->second;
+    };
+    for (auto &pair : copies) {
+        for (unsigned int i = 0; i < pair.first->getNumOperands(); i++)
+            pair.second->addOperand(mapped(pair.first->getOperand(i)));
+        for (unsigned int i = 0; i < pair.first->getNumBlockOperands(); i++)
+            pair.second->addBlockOperand(blocks[pair.first->getBlockOperand(i)]);
+    }
+
+    // The call's value is whatever the callee returned
+    if (call->getType() != Value::Void) {
+        Value* result;
+        if (returns.size() == 1)
+            result = mapped(returns[0].first);
+        else if (returns.empty())
+            result = caller->getParent()->getConstant(call->getType(), 0);
+        else {
+            Instruction* phi = new Instruction(Instruction::Phi, call->getType());
+            for (auto &ret : returns)
+                phi->addIncoming(mapped(ret.first), ret.second);
+            cont->insertAfterPhis(phi);
+            result = phi;
+        }
+        call->replaceAllUsesWith(result);
+    }
+    Instruction* br = new Instruction(Instruction::Br, Value::Void);
+    br->addBlockOperand(blocks[callee->getEntry()]);
+    br->setLocation(call->getLocation());
+    call->eraseFromParent();
+    bb->append(br);
+
+    // Lay the body out in place of the call
+    BasicBlock* last = bb;
+    for (auto cb : callee->getBlocks()) {
+        caller->moveBlockAfter(blocks[cb], last);
+        last = blocks[cb];
+    }
+    caller->moveBlockAfter(cont, last);
+    caller->recomputePredecessors();
+}
+
+bool Inliner::inlineCallsIn(Function* fn, std::set<Function*> &recursive) {
+    // Loop depth stands in for how often a call site runs, unless the
+    // profile says
+    std::vector<std::pair<Instruction*, unsigned int> > sites;
+    {
+        DominatorTree dt(fn);
+        LoopInfo li(fn, dt);
+        for (auto bb : fn->getBlocks()) {
+            Loop* loop = li.getLoopFor(bb);
+            unsigned int depth = loop ? loop->getDepth() : 0;
+            for (auto inst : bb->getInstructions()) {
+                Function* callee = inst->getOpcode() == Instruction::Call
+                    ? inst->getCalleeFunction() : nullptr;
+                if (callee && callee->getEntry())
+                    sites.push_back(std::make_pair(inst, depth));
+            }
+        }
+    }
+
+    bool changed = false;
+    for (auto &site : sites) {
+        Instruction* call = site.first;
+        Function* callee = call->getCalleeFunction();
+        unsigned int cost = callCost(call);
+        unsigned int allowed = threshold << std::min(site.second, 3u);
+        long long count = call->getProfileCount();
+        if (count >= 0)
+            allowed = isHot(count) ? threshold << 3 : threshold;
+        unsigned int size = callee->getInstructionCount();
+        numCallSites++;
+
+        const char* reason = nullptr;
+        if (callee == fn || recursive.count(callee))
+            reason = "recursive";
+        else if (count == 0)
+            reason = "never executed";
+        else if (cost > allowed)
+            reason = "too costly";
+        else if (moduleSize + size > sizeBudget)
+            reason = "module size budget exhausted";
+
+        if (report) {
+            *report << "inline: " << fn->getName() << " " << call->getLine() << ":"
+                    << call->getCol() << " -> " << callee->getName() << " (cost " << cost
+                    << ", threshold " << allowed << ", loop depth " << site.second;
+            if (count >= 0)
+                *report << ", count " << count;
+            *report << "): ";
+            if (reason)
+                *report << "not inlined, " << reason << "\n";
+            else
+                *report << "inlined\n";
+        }
+        if (reason)
+            continue;
+        inlineCall(call);
+        moduleSize += size;
+        numInlined++;
+        changed = true;
+    }
+    if (changed)
+        fn->removeUnreachableBlocks();
+    return changed;
+}
+
+// Once every call to a function is inlined it is dead weight
+bool Inliner::deleteUnreachable(Module* m) {
+    CallGraph graph(m);
+    std::set<std::string> live = graph.getReachableFrom("main");
+    if (live.empty())
+        return false;
+    std::vector<Function*> dead;
+    for (auto fn : m->getFunctions()) {
+        if (fn->getEntry() && !live.count(fn->getName()))
+            dead.push_back(fn);
+    }
+    for (auto fn : dead)
+        m->removeFunction(fn);
+    numDeleted += dead.size();
+    return !dead.empty();
+}
+
+bool Inliner::runOnModule(Module* m) {
+    // Allow the module to grow by half, and small ones a little more
+    moduleSize = m->getInstructionCount();
+    sizeBudget = moduleSize + moduleSize / 2 + 100;
+    for (auto fn : m->getFunctions()) {
+        for (auto bb : fn->getBlocks()) {
+            for (auto inst : bb->getInstructions()) {
+                if (inst->getOpcode() == Instruction::Call)
+                    hottestCall = std::max(hottestCall, inst->getProfileCount());
+            }
+        }
+    }
+
+    CallGraph graph(m);
+    std::set<Function*> recursive;
+    for (auto node : graph.getNodes()) {
+        if (graph.isRecursive(node))
+            recursive.insert(node->fn);
+    }
+    bool changed = false;
+    for (auto &scc : graph.getSCCs()) {
+        for (auto node : scc)
+            changed |= inlineCallsIn(node->fn, recursive);
+    }
+    changed |= deleteUnreachable(m);
+    return changed;
+}
+
+} // namespace smallc
@@ -0,0 +1,68 @@
+//
+//  Inliner.h
+//  ECE467 Lab 3
+//
+//  Function inlining. A call to a small non-recursive function is replaced
+//  by a copy of the callee's CFG: arguments become the actual values (an
+//  array argument is the caller's pointer, so the callee still writes the
+//  caller's array), returns branch to the code after the call and merge
+//  their values in a phi.
+//
+//  The cost of a call site is the callee's size less the instructions the
+//  call itself takes. It is inlined when the cost is within a threshold
+//  that grows with the loop depth of the call site, and while the module
+//  stays within its size budget. The call graph's components are
+//  processed bottom-up, so a caller sees its callees' final size; a
+//  function in a recursive component is never inlined. Functions main no
+//  longer reaches afterwards are deleted. Every decision can be reported
+//  for tuning.
+//
+//  With a profile, call counts replace the loop depth guess: a call site
+//  that never ran is left alone, and one within a tenth of the hottest
+//  call gets the threshold of the deepest loops.
+//
+
+#ifndef Inliner_h
+#define Inliner_h
+
+#include <map>
+#include <ostream>
+#include <set>
+#include <vector>
+
+#include "PassManager.h"
+#include "CallGraph.h"
+
+namespace smallc {
+
+class Inliner : public Pass {
+private:
+    std::ostream* report;           // Decision log, or nullptr
+    unsigned int threshold;         // Cost allowed at loop depth 0
+    unsigned int sizeBudget;        // Module instruction count not to exceed
+    unsigned int moduleSize;
+    long long hottestCall;          // Largest call count in the profile, -1 if none
+
+    unsigned int numInlined;
+    unsigned int numCallSites;
+    unsigned int numDeleted;
+
+    static unsigned int callCost(Instruction* call);
+    bool isHot(long long count);
+    void inlineCall(Instruction* call);
+    bool inlineCallsIn(Function* fn, std::set<Function*> &recursive);
+    bool deleteUnreachable(Module* m);
+
+public:
+    Inliner();
+    // Log every decision to out
+    void setReport(std::ostream* out);
+    void setThreshold(unsigned int cost);
+    const char* getName() const override;
+    bool runOnModule(Module* m) override;
+    void printStatistics(std::ostream &out) override;
+};
+
+} // namespace smallc
+
+#endif /* Inliner_h */
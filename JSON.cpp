@@ -0,0 +1,37 @@
+//
+//  JSON.cpp
+//  ECE467 Lab 3
+//
+//  Quoting strings for JSON.
+//
+
+#include "JSON.h"
+
+namespace smallc {
+
+void appendJSONString(std::string &out, const std::string &text) {
+    static const char digits[] = "0123456789abcdef";
+    out += '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        }
+        else if ((unsigned char)c < 0x20) {
+            out += "\\u00";
+            out += digits[(unsigned char)c >> 4];
+            out += digits[c & 0xf];
+        }
+        else
+            out += c;
+    }
+    out += '"';
+}
+
+std::string jsonString(const std::string &text) {
+    std::string quoted;
+    appendJSONString(quoted, text);
+    return quoted;
+}
+
+} // namespace smallc
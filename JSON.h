@@ -0,0 +1,24 @@
+//
+//  JSON.h
+//  ECE467 Lab 3
+//
+//  Quoting strings for the JSON the compiler writes: time reports, traces
+//  and --print-ast-json.
+//
+
+#ifndef JSON_h
+#define JSON_h
+
+#include <string>
+
+namespace smallc {
+
+// Appends text to out as a JSON string, quoted and escaped
+void appendJSONString(std::string &out, const std::string &text);
+
+// The text as a JSON string
+std::string jsonString(const std::string &text);
+
+} // namespace smallc
+
+#endif /* JSON_h */
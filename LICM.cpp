@@ -0,0 +1,134 @@
+//
+//  LICM.cpp
+//  ECE467 Lab 3
+//
+//  Loop-invariant code motion.
+//
+
+#include "LICM.h"
+
+namespace smallc {
+
+LICM::LICM() : numHoisted(0), numLoadsHoisted(0) {}
+
+const char* LICM::getName() const { return "licm"; }
+
+void LICM::printStatistics(std::ostream &out) {
+    out << "licm: " << numHoisted << " invariant instructions hoisted, "
+        << numLoadsHoisted << " of them loads\n";
+}
+
+LICM::LoopMemory LICM::summarize(Loop* loop) {
+    LoopMemory mem;
+    mem.hasCall = false;
+    mem.wildStore = false;
+    for (auto bb : loop->getBlocks()) {
+        for (auto inst : bb->getInstructions()) {
+            if (inst->getOpcode() == Instruction::Call)
+                mem.hasCall = true;
+            else if (inst->getOpcode() == Instruction::Store)
+                mem.stored.insert(inst->getOperand(0));
+            else if (inst->getOpcode() == Instruction::StoreElem ||
+                     inst->getOpcode() == Instruction::VecStore) {
+                if (isIdentifiedObject(inst->getOperand(0)))
+                    mem.stored.insert(inst->getOperand(0));
+                else
+                    mem.wildStore = true;
+            }
+        }
+    }
+    return mem;
+}
+
+bool LICM::isSafeToHoist(Instruction* inst, Loop* loop, LoopMemory &mem) {
+    for (unsigned int i = 0; i < inst->getNumOperands(); i++) {
+        if (!loop->isInvariant(inst->getOperand(i)))
+            return false;
+    }
+    switch (inst->getOpcode()) {
+        case Instruction::Add:
+        case Instruction::Sub:
+        case Instruction::Mul:
+        case Instruction::Neg:
+        case Instruction::Not:
+        case Instruction::Cmp:
+            return true;
+        case Instruction::Div: {
+            // The loop body may not run at all, so the division must not trap
+            Value* divisor = inst->getOperand(1);
+            if (divisor->getKind() != Value::ConstantVal)
+                return false;
+            int val = static_cast<Constant*>(divisor)->getVal();
+            return val != 0 && val != -1;
+        }
+        case Instruction::Load:
+            return !mem.hasCall && !mem.stored.count(inst->getOperand(0));
+        case Instruction::LoadElem: {
+            Value* base = inst->getOperand(0);
+            Value* index = inst->getOperand(1);
+            if (mem.hasCall || mem.wildStore || mem.stored.count(base))
+                return false;
+            if (!isIdentifiedObject(base) || index->getKind() != Value::ConstantVal)
+                return false;
+            int size = base->getKind() == Value::GlobalVal
+                ? static_cast<GlobalVariable*>(base)->getSize()
+                : static_cast<Instruction*>(base)->getAllocSize();
+            int idx = static_cast<Constant*>(index)->getVal();
+            return idx >= 0 && idx < size;
+        }
+        default:
+            return false;
+    }
+}
+
+bool LICM::hoistLoop(Loop* loop, BasicBlock* preheader, DominatorTree &dt) {
+    bool changed = false;
+    LoopMemory mem = summarize(loop);
+    long long entries = preheader->getProfileCount();
+    // Dominator order visits definitions before their uses, so chains of
+    // invariant computations move together
+    for (auto bb : dt.getPreOrder()) {
+        if (!loop->contains(bb))
+            continue;
+        // Hoisting from a block that runs less often than the loop is
+        // entered would make the code run more often, not less
+        if (entries >= 0 && bb->hasProfileCount() && bb->getProfileCount() < entries)
+            continue;
+        std::vector<Instruction*> insts(bb->getInstructions().begin(), bb->getInstructions().end());
+        for (auto inst : insts) {
+            if (!isSafeToHoist(inst, loop, mem))
+                continue;
+            bb->remove(inst);
+            preheader->insertBeforeTerminator(inst);
+            numHoisted++;
+            if (inst->mayReadMemory())
+                numLoadsHoisted++;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool LICM::runOnFunction(Function* fn) {
+    DominatorTree dt(fn);
+    LoopInfo li(fn, dt);
+    if (li.empty())
+        return false;
+
+    bool changed = false;
+    std::vector<Loop*> loops = li.getLoopsInnermostFirst();
+    for (auto loop : loops) {
+        if (!loop->getPreheader() && li.insertPreheader(loop))
+            changed = true;
+    }
+    if (changed)
+        dt.recalculate();
+    for (auto loop : loops) {
+        BasicBlock* preheader = loop->getPreheader();
+        if (preheader)
+            changed |= hoistLoop(loop, preheader, dt);
+    }
+    return changed;
+}
+
+} // namespace smallc
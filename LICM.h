@@ -0,0 +1,51 @@
+//
+//  LICM.h
+//  ECE467 Lab 3
+//
+//  Loop-invariant code motion. Pure instructions whose operands are all
+//  defined outside a loop are moved to the loop's preheader, innermost
+//  loops first so invariants climb out of whole loop nests. Loads are
+//  hoisted when nothing in the loop may write the location and the load
+//  cannot fault: global scalars, or constant in-bounds indices of a global
+//  or local array. A division is hoisted only when its divisor is a
+//  constant that cannot trap. With a profile, nothing is hoisted from a
+//  block that ran fewer times than the loop was entered.
+//
+
+#ifndef LICM_h
+#define LICM_h
+
+#include <set>
+
+#include "PassManager.h"
+#include "LoopInfo.h"
+
+namespace smallc {
+
+class LICM : public FunctionPass {
+private:
+    // What the loop may write
+    class LoopMemory {
+    public:
+        bool hasCall;
+        bool wildStore;                 // Store through an array parameter
+        std::set<Value*> stored;        // Globals and local arrays stored to
+    };
+
+    unsigned int numHoisted;
+    unsigned int numLoadsHoisted;
+
+    static LoopMemory summarize(Loop* loop);
+    static bool isSafeToHoist(Instruction* inst, Loop* loop, LoopMemory &mem);
+    bool hoistLoop(Loop* loop, BasicBlock* preheader, DominatorTree &dt);
+
+public:
+    LICM();
+    const char* getName() const override;
+    bool runOnFunction(Function* fn) override;
+    void printStatistics(std::ostream &out) override;
+};
+
+} // namespace smallc
+
+#endif /* LICM_h */
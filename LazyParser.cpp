@@ -0,0 +1,293 @@
+//
+//  LazyParser.cpp
+//  ECE467 Lab 3
+//
+//  Signature-only parsing with function bodies parsed on demand or in
+//  parallel.
+//
+
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "LazyParser.h"
+#include "Trace.h"
+#include "smallCLexer.h"
+#include "smallCParser.h"
+
+namespace smallc {
+
+// Keeps a body's syntax errors to print once every thread is done, in
+// the form ANTLR's console listener prints them
+class LazyParser::ErrorCollector : public antlr4::BaseErrorListener {
+public:
+    LazyBody* body;
+
+    void syntaxError(antlr4::Recognizer*, antlr4::Token*, size_t line, size_t charPositionInLine,
+                     const std::string &msg, std::exception_ptr) override {
+        body->errors += "line " + std::to_string(line) + ":" + std::to_string(charPositionInLine) +
+                        " " + msg + "\n";
+        body->numErrors++;
+    }
+};
+
+LazyParser::LazyParser(antlr4::CommonTokenStream* tokens_)
+    : tokens(tokens_), parser(nullptr), pos(0), syntaxErrors(0) {}
+
+LazyParser::~LazyParser() {
+    delete parser;
+}
+
+antlr4::Token* LazyParser::peek() {
+    return tokens->get(pos);
+}
+
+bool LazyParser::is(const std::string &text) {
+    return peek()->getType() != antlr4::Token::EOF && peek()->getText() == text;
+}
+
+bool LazyParser::accept(const std::string &text) {
+    if (!is(text))
+        return false;
+    pos++;
+    return true;
+}
+
+template <class Node>
+Node* LazyParser::locate(Node* node, antlr4::Token* token) {
+    node->setOffset(token->getStartIndex());
+    return node;
+}
+
+/**********************************************************************************/
+/* Declarations                                                                   */
+/**********************************************************************************/
+
+ProgramNode* LazyParser::parseSignatures() {
+    pos = 0;
+    bodies.clear();
+    ProgramNode* prg = locate(new ProgramNode(), peek());
+    if (accept("#include")) {
+        if (!accept("\"scio.h\""))
+            return nullptr;
+        prg->setIo(true);
+    }
+    while (peek()->getType() != antlr4::Token::EOF) {
+        DeclNode* decl = parseDecl();
+        if (!decl)
+            return nullptr;
+        prg->addChild(decl);
+    }
+    return prg;
+}
+
+// One of scalarDecl, arrDecl, fcnProto or fcnDecl
+DeclNode* LazyParser::parseDecl() {
+    antlr4::Token* start = peek();
+    PrimitiveTypeNode* type = parseType(true);
+    IdentifierNode* name = type ? parseName() : nullptr;
+    if (!name)
+        return nullptr;
+
+    if (accept("(")) {
+        FunctionDeclNode* func = locate(new FunctionDeclNode(), start);
+        func->setRetType(type);
+        func->setName(name);
+        if (!is(")")) {
+            do {
+                ParameterNode* param = parseParam();
+                if (!param)
+                    return nullptr;
+                func->addParameter(param);
+            } while (accept(","));
+        }
+        if (!accept(")"))
+            return nullptr;
+        if (accept(";")) {
+            func->setProto(true);
+            return func;
+        }
+        size_t bodyStart = pos, bodyStop;
+        if (!skipBody(bodyStop))
+            return nullptr;
+        func->setProto(false);
+        func->setLazyBody(this, bodyStart, bodyStop);
+        LazyBody body;
+        body.func = func;
+        body.start = bodyStart;
+        body.stop = bodyStop;
+        body.scope = nullptr;
+        body.numErrors = 0;
+        bodies.push_back(body);
+        return func;
+    }
+
+    if (type->getTypeEnum() == TypeNode::Void)
+        return nullptr;
+    if (accept("[")) {
+        int size;
+        if (!parseIntConst(size) || !accept("]") || !accept(";"))
+            return nullptr;
+        ArrayTypeNode* arrayType = locate(new ArrayTypeNode(type, size), start);
+        return locate(new ArrayDeclNode(arrayType, name), start);
+    }
+    if (!accept(";"))
+        return nullptr;
+    return locate(new ScalarDeclNode(type, name), start);
+}
+
+PrimitiveTypeNode* LazyParser::parseType(bool allowVoid) {
+    antlr4::Token* token = peek();
+    TypeNode::TypeEnum type;
+    if (accept("int"))
+        type = TypeNode::Int;
+    else if (accept("bool"))
+        type = TypeNode::Bool;
+    else if (allowVoid && accept("void"))
+        type = TypeNode::Void;
+    else
+        return nullptr;
+    return locate(new PrimitiveTypeNode(type), token);
+}
+
+IdentifierNode* LazyParser::parseName() {
+    antlr4::Token* token = peek();
+    if (token->getType() != smallCLexer::ID)
+        return nullptr;
+    pos++;
+    return locate(new IdentifierNode(token->getText()), token);
+}
+
+// intConst: INT | '-' INT
+bool LazyParser::parseIntConst(int &value) {
+    bool negative = accept("-");
+    antlr4::Token* token = peek();
+    if (token->getType() != smallCLexer::INT)
+        return false;
+    long long magnitude = std::strtoll(token->getText().c_str(), nullptr, 10);
+    if (magnitude > INT_MAX)
+        return false;
+    pos++;
+    value = negative ? -(int)magnitude : (int)magnitude;
+    return true;
+}
+
+// paramEntry: varType varName | varType arrName '[]'
+ParameterNode* LazyParser::parseParam() {
+    antlr4::Token* start = peek();
+    PrimitiveTypeNode* type = parseType(false);
+    IdentifierNode* name = type ? parseName() : nullptr;
+    if (!name)
+        return nullptr;
+    TypeNode* paramType = type;
+    if (accept("[]"))
+        paramType = locate(new ArrayTypeNode(type), start);
+    return locate(new ParameterNode(paramType, name), start);
+}
+
+/**********************************************************************************/
+/* Function Bodies                                                                */
+/**********************************************************************************/
+
+// Braces only appear as the delimiters of scopes, so the body ends at
+// the brace that balances its first
+bool LazyParser::skipBody(size_t &stop) {
+    if (!is("{"))
+        return false;
+    unsigned int depth = 0;
+    for (;;) {
+        antlr4::Token* token = peek();
+        if (token->getType() == antlr4::Token::EOF)
+            return false;
+        pos++;
+        if (token->getText() == "{")
+            depth++;
+        else if (token->getText() == "}" && --depth == 0)
+            break;
+    }
+    stop = pos - 1;
+    return true;
+}
+
+ScopeNode* LazyParser::parseBody(size_t start, size_t stop) {
+    if (!parser) {
+        parser = new smallCParser(tokens);
+        parser->setBuildParseTree(false);
+    }
+    size_t errors = parser->getNumberOfSyntaxErrors();
+    tokens->seek(start);
+    ScopeNode* body = parser->scope()->scope_;
+    errors = parser->getNumberOfSyntaxErrors() - errors;
+
+    // Balanced braces always close the scope; anything else was an error
+    // ANTLR recovered from
+    if (errors == 0 && tokens->index() != stop + 1)
+        errors = 1;
+    syntaxErrors += errors;
+    return body;
+}
+
+/**********************************************************************************/
+/* Parallel Parsing                                                               */
+/**********************************************************************************/
+
+void LazyParser::parseBodies(unsigned int threads, Trace* trace) {
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < threads && i < bodies.size(); i++)
+        workers.emplace_back(&LazyParser::parseBodiesOn, this, std::ref(next), trace);
+    parseBodiesOn(next, trace);
+    for (auto &worker : workers)
+        worker.join();
+
+    for (auto &body : bodies) {
+        if (body.func->isBodyParsed())
+            continue;
+        body.func->setBody(body.scope);
+        std::cerr << body.errors;
+        syntaxErrors += body.numErrors;
+    }
+}
+
+// The tokens of a body are copied into a stream of the thread's own, as a
+// token stream is not safe to share; the copies keep their lines and
+// columns. Parsers share the grammar's ATN and prediction cache, which
+// ANTLR locks.
+void LazyParser::parseBodiesOn(std::atomic<size_t> &next, Trace* trace) {
+    std::unique_ptr<smallCParser> worker;
+    ErrorCollector errors;
+    for (size_t i = next++; i < bodies.size(); i = next++) {
+        LazyBody &body = bodies[i];
+        if (body.func->isBodyParsed())
+            continue;
+        Trace::Span span(trace, body.func->getIdent()->getName(), "parse.body");
+        span.addArg("tokens", body.stop - body.start + 1);
+
+        std::vector<std::unique_ptr<antlr4::Token>> copies;
+        for (size_t t = body.start; t <= body.stop; t++)
+            copies.emplace_back(new antlr4::CommonToken(tokens->get(t)));
+        antlr4::ListTokenSource source(std::move(copies));
+        antlr4::CommonTokenStream stream(&source);
+        if (!worker) {
+            worker.reset(new smallCParser(&stream));
+            worker->setBuildParseTree(false);
+            worker->removeErrorListeners();
+            worker->addErrorListener(&errors);
+        }
+        else
+            worker->setTokenStream(&stream);
+
+        errors.body = &body;
+        body.scope = worker->scope()->scope_;
+        if (body.numErrors == 0 && stream.index() != body.stop - body.start + 1)
+            body.numErrors++;
+    }
+}
+
+size_t LazyParser::getNumSyntaxErrors() {
+    return syntaxErrors;
+}
+
+} // namespace smallc
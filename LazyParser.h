@@ -0,0 +1,102 @@
+//
+//  LazyParser.h
+//  ECE467 Lab 3
+//
+//  Signature-only parsing for --signatures. The global declarations and
+//  function signatures are read straight off the token stream, and every
+//  function body is skipped by matching its braces, recording only the
+//  range of tokens it spans. A body is parsed into its ScopeNode by the
+//  grammar's scope rule the first time FunctionDeclNode::getBody asks for
+//  it, so tools that only look at the program's interface never pay for
+//  parsing statements and expressions.
+//
+//  Only well-formed top-level declarations are recognized. At the first
+//  token that does not fit, parseSignatures gives up and the caller
+//  parses the whole program with ANTLR, which reports the syntax error.
+//  Syntax errors inside a body are found, and reported by ANTLR, when the
+//  body is parsed.
+//
+//  parseBodies parses every body up front on several threads instead,
+//  each thread with its own parser and its own copy of the tokens of the
+//  bodies it takes, so a large file parses in parallel. The bodies are
+//  set in their functions, which are already in the ProgramNode in
+//  source order, and syntax errors are printed in source order too.
+//
+//  The token stream must outlive the AST built from it, or at least
+//  until every body was parsed.
+//
+
+#ifndef LazyParser_h
+#define LazyParser_h
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "antlr4-runtime.h"
+#include "ASTNodes.h"
+
+class smallCParser;
+
+namespace smallc {
+
+class Trace;
+
+class LazyParser {
+private:
+    // A body not parsed yet, and what parsing it in parallel gave
+    class LazyBody {
+    public:
+        FunctionDeclNode* func;
+        size_t start;              // Tokens of its braces
+        size_t stop;
+        ScopeNode* scope;
+        std::string errors;        // As ANTLR prints them
+        size_t numErrors;
+    };
+    class ErrorCollector;
+
+
+    antlr4::CommonTokenStream* tokens;
+    smallCParser* parser;          // Parses bodies; made for the first one
+    size_t pos;                    // Next token of the signature scan
+    size_t syntaxErrors;           // In the bodies parsed so far
+    std::vector<LazyBody> bodies;
+
+    antlr4::Token* peek();
+    bool is(const std::string &text);
+    bool accept(const std::string &text);
+    template <class Node> Node* locate(Node* node, antlr4::Token* token);
+
+    // Each returns nullptr, or false, at a token it does not expect
+    DeclNode* parseDecl();
+    PrimitiveTypeNode* parseType(bool allowVoid);
+    IdentifierNode* parseName();
+    bool parseIntConst(int &value);
+    ParameterNode* parseParam();
+    bool skipBody(size_t &stop);
+
+    // Takes the next body until none are left
+    void parseBodiesOn(std::atomic<size_t> &next, Trace* trace);
+
+public:
+    LazyParser(antlr4::CommonTokenStream* tokens_);
+    ~LazyParser();
+
+    // Builds the program with every function body left unparsed, or
+    // returns nullptr if it is not well-formed
+    ProgramNode* parseSignatures();
+
+    // Parses the body whose braces are the tokens at start and stop
+    ScopeNode* parseBody(size_t start, size_t stop);
+
+    // Parses every body not parsed yet on the given number of threads
+    // and prints their syntax errors; spans go to trace if there is one
+    void parseBodies(unsigned int threads, Trace* trace);
+
+    size_t getNumSyntaxErrors();
+};
+
+} // namespace smallc
+
+#endif /* LazyParser_h */
@@ -0,0 +1,97 @@
+//
+//  LineTable.cpp
+//  ECE467 Lab 3
+//
+//  Line starts of the source, built on demand.
+//
+
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "LineTable.h"
+
+namespace smallc {
+
+namespace {
+
+LineTable* current = nullptr;
+
+} // namespace
+
+LineTable::LineTable(const std::string &text_) : text(&text_), lineStarts(), built() {}
+
+void LineTable::setCurrent(LineTable* table) {
+    current = table;
+}
+
+LineTable* LineTable::getCurrent() {
+    return current;
+}
+
+// Counts the characters of bytes, starting a line after every newline
+void LineTable::scan(const unsigned char* bytes, size_t size, uint32_t &offset) {
+    for (size_t i = 0; i < size; i++) {
+        if ((bytes[i] & 0xc0) == 0x80)
+            continue;
+        offset++;
+        if (bytes[i] == '\n')
+            lineStarts.push_back(offset);
+    }
+}
+
+// A block of 16 ASCII bytes is 16 characters, and its newlines are the
+// set bits of one comparison's mask; blocks with other bytes are counted
+// one byte at a time
+void LineTable::build() {
+    const unsigned char* bytes = (const unsigned char*)text->data();
+    size_t size = text->size();
+    uint32_t offset = 0;
+    size_t i = 0;
+    lineStarts.reserve(size / 32 + 1);
+    lineStarts.push_back(0);
+#ifdef __SSE2__
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= size; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(bytes + i));
+        if (_mm_movemask_epi8(block) != 0) {
+            scan(bytes + i, 16, offset);
+            continue;
+        }
+        unsigned int newlines = _mm_movemask_epi8(_mm_cmpeq_epi8(block, newline));
+        while (newlines) {
+            lineStarts.push_back(offset + __builtin_ctz(newlines) + 1);
+            newlines &= newlines - 1;
+        }
+        offset += 16;
+    }
+#endif
+    scan(bytes + i, size - i, offset);
+}
+
+std::pair<unsigned int, unsigned int> LineTable::getLocation(uint32_t offset) {
+    if (offset == NoOffset)
+        return std::make_pair(0u, 0u);
+    std::call_once(built, &LineTable::build, this);
+    auto next = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+    unsigned int line = next - lineStarts.begin();
+    return std::make_pair(line, offset - lineStarts[line - 1]);
+}
+
+uint32_t LineTable::getOffset(unsigned int line, unsigned int column) {
+    if (line == 0)
+        return NoOffset;
+    std::call_once(built, &LineTable::build, this);
+    if (line > lineStarts.size())
+        return NoOffset;
+    return lineStarts[line - 1] + column;
+}
+
+unsigned int LineTable::getNumLines() {
+    std::call_once(built, &LineTable::build, this);
+    return lineStarts.size();
+}
+
+} // namespace smallc
@@ -0,0 +1,56 @@
+//
+//  LineTable.h
+//  ECE467 Lab 3
+//
+//  Turns source offsets into lines and columns. AST nodes only keep the
+//  32-bit offset of their first character, as ANTLR's token start index,
+//  and ask the table of the input being compiled for the line and column
+//  when a diagnostic or a printer wants them.
+//
+//  The table is the offset at which every line starts. It is built on
+//  the first query, by a newline scan of the source 16 bytes at a time,
+//  so compiles that never ask for a location never build it. Offsets and
+//  columns count characters, not bytes, as ANTLR's do: UTF-8 continuation
+//  bytes are not counted.
+//
+
+#ifndef LineTable_h
+#define LineTable_h
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace smallc {
+
+class LineTable {
+private:
+    const std::string* text;
+    std::vector<uint32_t> lineStarts;   // Offset of the first character of every line
+    std::once_flag built;
+
+    void build();
+    void scan(const unsigned char* bytes, size_t size, uint32_t &offset);
+
+public:
+    static const uint32_t NoOffset = 0xffffffff;
+
+    // The text is not copied; it must outlive the table
+    explicit LineTable(const std::string &text_);
+
+    // Line from 1 and column from 0, like ANTLR's; <0,0> for NoOffset
+    std::pair<unsigned int, unsigned int> getLocation(uint32_t offset);
+    // NoOffset for line 0 or a line past the end
+    uint32_t getOffset(unsigned int line, unsigned int column);
+    unsigned int getNumLines();
+
+    // The table the AST nodes use, of the input being compiled
+    static void setCurrent(LineTable* table);
+    static LineTable* getCurrent();
+};
+
+} // namespace smallc
+
+#endif /* LineTable_h */
@@ -0,0 +1,230 @@
+//
+//  LoopInfo.cpp
+//  ECE467 Lab 3
+//
+//  Natural loop discovery and preheader insertion.
+//
+
+#include <algorithm>
+
+#include "LoopInfo.h"
+
+namespace smallc {
+
+/**********************************************************************************/
+/* The Loop Class                                                                 */
+/**********************************************************************************/
+
+Loop::Loop(BasicBlock* header_) : header(header_), parent(nullptr) {}
+
+BasicBlock* Loop::getHeader() { return header; }
+
+const std::set<BasicBlock*>& Loop::getBlocks() { return blocks; }
+
+const std::vector<BasicBlock*>& Loop::getLatches() { return latches; }
+
+BasicBlock* Loop::getLatch() {
+    return latches.size() == 1 ? latches[0] : nullptr;
+}
+
+Loop* Loop::getParent() { return parent; }
+
+const std::vector<Loop*>& Loop::getSubLoops() { return subLoops; }
+
+unsigned int Loop::getDepth() {
+    unsigned int depth = 1;
+    for (Loop* l = parent; l; l = l->parent)
+        depth++;
+    return depth;
+}
+
+bool Loop::contains(BasicBlock* bb) {
+    return blocks.count(bb) != 0;
+}
+
+bool Loop::contains(Value* v) {
+    if (v->getKind() != Value::InstructionVal)
+        return false;
+    return contains(static_cast<Instruction*>(v)->getParent());
+}
+
+bool Loop::isInvariant(Value* v) {
+    return !contains(v);
+}
+
+BasicBlock* Loop::getPreheader() {
+    BasicBlock* outside = nullptr;
+    for (auto pred : header->getPredecessors()) {
+        if (contains(pred))
+            continue;
+        if (outside)
+            return nullptr;
+        outside = pred;
+    }
+    if (!outside || outside->getSuccessors().size() != 1)
+        return nullptr;
+    return outside;
+}
+
+std::vector<BasicBlock*> Loop::getExitBlocks() {
+    std::vector<BasicBlock*> exits;
+    for (auto bb : blocks) {
+        for (auto succ : bb->getSuccessors()) {
+            if (!contains(succ) && std::find(exits.begin(), exits.end(), succ) == exits.end())
+                exits.push_back(succ);
+        }
+    }
+    return exits;
+}
+
+/**********************************************************************************/
+/* The LoopInfo Class                                                             */
+/**********************************************************************************/
+
+LoopInfo::LoopInfo(Function* fn_, DominatorTree &dt) : fn(fn_) {
+    for (auto header : dt.getPreOrder()) {
+        Loop* loop = nullptr;
+        std::vector<BasicBlock*> work;
+        for (auto pred : header->getPredecessors()) {
+            if (!dt.isReachable(pred) || !dt.dominates(header, pred))
+                continue;
+            if (!loop) {
+                loop = new Loop(header);
+                loop->blocks.insert(header);
+                loops.push_back(loop);
+            }
+            loop->latches.push_back(pred);
+            if (loop->blocks.insert(pred).second)
+                work.push_back(pred);
+        }
+        // Everything reaching a latch without passing the header
+        while (!work.empty()) {
+            BasicBlock* bb = work.back();
+            work.pop_back();
+            for (auto pred : bb->getPredecessors()) {
+                if (dt.isReachable(pred) && loop->blocks.insert(pred).second)
+                    work.push_back(pred);
+            }
+        }
+    }
+
+    // The smallest loop containing another's header is its parent
+    std::vector<Loop*> bySize = loops;
+    std::stable_sort(bySize.begin(), bySize.end(), [](Loop* a, Loop* b) {
+        return a->blocks.size() < b->blocks.size();
+    });
+    for (unsigned int i = 0; i < bySize.size(); i++) {
+        Loop* loop = bySize[i];
+        for (unsigned int j = i + 1; j < bySize.size(); j++) {
+            if (bySize[j]->contains(loop->header)) {
+                loop->parent = bySize[j];
+                bySize[j]->subLoops.push_back(loop);
+                break;
+            }
+        }
+        for (auto bb : loop->blocks) {
+            if (!innermost.count(bb))
+                innermost[bb] = loop;
+        }
+    }
+}
+
+LoopInfo::~LoopInfo() {
+    for (auto loop : loops)
+        delete loop;
+}
+
+const std::vector<Loop*>& LoopInfo::getLoops() { return loops; }
+
+std::vector<Loop*> LoopInfo::getLoopsInnermostFirst() {
+    std::vector<Loop*> order;
+    std::vector<std::pair<Loop*, bool> > work;
+    for (auto it = loops.rbegin(); it != loops.rend(); ++it) {
+        if (!(*it)->parent)
+            work.push_back(std::make_pair(*it, false));
+    }
+    // Postorder over the loop nest
+    while (!work.empty()) {
+        auto item = work.back();
+        work.pop_back();
+        if (item.second) {
+            order.push_back(item.first);
+            continue;
+        }
+        work.push_back(std::make_pair(item.first, true));
+        for (auto sub : item.first->subLoops)
+            work.push_back(std::make_pair(sub, false));
+    }
+    return order;
+}
+
+Loop* LoopInfo::getLoopFor(BasicBlock* bb) {
+    auto it = innermost.find(bb);
+    return it == innermost.end() ? nullptr : it->second;
+}
+
+bool LoopInfo::empty() {
+    return loops.empty();
+}
+
+BasicBlock* LoopInfo::insertPreheader(Loop* loop) {
+    BasicBlock* pre = loop->getPreheader();
+    if (pre)
+        return pre;
+    BasicBlock* header = loop->header;
+    std::vector<BasicBlock*> outside;
+    for (auto pred : header->getPredecessors()) {
+        if (!loop->contains(pred))
+            outside.push_back(pred);
+    }
+    if (outside.empty())
+        return nullptr;
+
+    pre = fn->createBlock("preheader");
+    long long entries = 0;
+    for (auto pred : outside) {
+        long long count = pred->getEdgeCount(header);
+        entries = count < 0 || entries < 0 ? -1 : entries + count;
+    }
+    pre->setProfileCount(entries);
+    Instruction* br = new Instruction(Instruction::Br, Value::Void);
+    br->addBlockOperand(header);
+    pre->append(br);
+
+    // Values entering from outside now arrive through the preheader
+    for (auto phi : header->getPhis()) {
+        if (outside.size() == 1) {
+            phi->replaceIncomingBlock(outside[0], pre);
+            continue;
+        }
+        Instruction* merge = new Instruction(Instruction::Phi, phi->getType());
+        for (auto pred : outside) {
+            merge->addIncoming(phi->getIncomingValueFor(pred), pred);
+            phi->removeIncoming(pred);
+        }
+        pre->insertAfterPhis(merge);
+        phi->addIncoming(merge, pre);
+    }
+    for (auto pred : outside) {
+        Instruction* term = pred->getTerminator();
+        for (unsigned int i = 0; i < term->getNumBlockOperands(); i++) {
+            if (term->getBlockOperand(i) == header)
+                term->setBlockOperand(i, pre);
+        }
+    }
+
+    // Lay the preheader out just above the header
+    std::vector<BasicBlock*> &blocks = fn->getBlocks();
+    auto pos = std::find(blocks.begin(), blocks.end(), header);
+    if (pos != blocks.begin())
+        fn->moveBlockAfter(pre, *(pos - 1));
+
+    for (Loop* l = loop->parent; l; l = l->parent)
+        l->blocks.insert(pre);
+    if (loop->parent)
+        innermost[pre] = loop->parent;
+    fn->recomputePredecessors();
+    return pre;
+}
+
+} // namespace smallc
@@ -0,0 +1,87 @@
+//
+//  LoopInfo.h
+//  ECE467 Lab 3
+//
+//  Natural loops of a Function. A loop is identified by its header, a
+//  block that dominates the source of one of its incoming edges (the back
+//  edges); its body is every block that reaches a back edge without going
+//  through the header. Loops with distinct headers are either disjoint or
+//  nested. In smallC every loop comes from a WhileStmtNode.
+//
+
+#ifndef LoopInfo_h
+#define LoopInfo_h
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "IR.h"
+#include "Dominators.h"
+
+namespace smallc {
+
+/**********************************************************************************/
+/* The Loop Class                                                                 */
+/**********************************************************************************/
+class Loop {
+private:
+    BasicBlock* header;
+    std::set<BasicBlock*> blocks;
+    std::vector<BasicBlock*> latches;   // Sources of the back edges
+    Loop* parent;
+    std::vector<Loop*> subLoops;
+
+    friend class LoopInfo;
+
+public:
+    explicit Loop(BasicBlock* header_);
+
+    BasicBlock* getHeader();
+    const std::set<BasicBlock*>& getBlocks();
+    const std::vector<BasicBlock*>& getLatches();
+    // The single latch, or nullptr
+    BasicBlock* getLatch();
+    Loop* getParent();
+    const std::vector<Loop*>& getSubLoops();
+    unsigned int getDepth();
+
+    bool contains(BasicBlock* bb);
+    // Is v computed inside the loop?
+    bool contains(Value* v);
+    bool isInvariant(Value* v);
+
+    // The only block outside the loop branching to the header, if it
+    // branches nowhere else
+    BasicBlock* getPreheader();
+    // Blocks outside the loop with a predecessor inside it
+    std::vector<BasicBlock*> getExitBlocks();
+};
+
+/**********************************************************************************/
+/* The LoopInfo Class                                                             */
+/**********************************************************************************/
+class LoopInfo {
+private:
+    Function* fn;
+    std::vector<Loop*> loops;                   // Owned
+    std::map<BasicBlock*, Loop*> innermost;
+
+public:
+    LoopInfo(Function* fn_, DominatorTree &dt);
+    ~LoopInfo();
+
+    const std::vector<Loop*>& getLoops();
+    // Inner loops come before the loops containing them
+    std::vector<Loop*> getLoopsInnermostFirst();
+    Loop* getLoopFor(BasicBlock* bb);
+    bool empty();
+
+    // Give the loop a preheader if it has none. The new block joins the
+    // enclosing loops; the dominator tree must be recalculated afterwards.
+    BasicBlock* insertPreheader(Loop* loop);
+};
+
+} // namespace smallc
+
+#endif /* LoopInfo_h */
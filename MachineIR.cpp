@@ -0,0 +1,172 @@
+//
+//  MachineIR.cpp
+//  ECE467 Lab 3
+//
+//  Machine-level representation used by the x86-64 backend.
+//
+
+#include "MachineIR.h"
+
+namespace smallc {
+
+const char* x86RegName(int reg, unsigned int bytes) {
+    static const char* names64[NumX86Regs] = {
+        "%rax", "%rcx", "%rdx", "%rbx", "%rsp", "%rbp", "%rsi", "%rdi",
+        "%r8", "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15"
+    };
+    static const char* names32[NumX86Regs] = {
+        "%eax", "%ecx", "%edx", "%ebx", "%esp", "%ebp", "%esi", "%edi",
+        "%r8d", "%r9d", "%r10d", "%r11d", "%r12d", "%r13d", "%r14d", "%r15d"
+    };
+    static const char* names8[NumX86Regs] = {
+        "%al", "%cl", "%dl", "%bl", "%spl", "%bpl", "%sil", "%dil",
+        "%r8b", "%r9b", "%r10b", "%r11b", "%r12b", "%r13b", "%r14b", "%r15b"
+    };
+    if (bytes == 8)
+        return names64[reg];
+    if (bytes == 1)
+        return names8[reg];
+    return names32[reg];
+}
+
+/**********************************************************************************/
+/* The MachineOperand Class                                                       */
+/**********************************************************************************/
+
+MachineOperand::MachineOperand() : kind(None), val(0) {}
+
+MachineOperand MachineOperand::vreg(int reg) {
+    MachineOperand op;
+    op.kind = VReg;
+    op.val = reg;
+    return op;
+}
+
+MachineOperand MachineOperand::imm(int value) {
+    MachineOperand op;
+    op.kind = Imm;
+    op.val = value;
+    return op;
+}
+
+MachineOperand MachineOperand::xreg(int reg) {
+    MachineOperand op;
+    op.kind = XReg;
+    op.val = reg;
+    return op;
+}
+
+bool MachineOperand::isVReg() const { return kind == VReg; }
+
+bool MachineOperand::isImm() const { return kind == Imm; }
+
+bool MachineOperand::isXReg() const { return kind == XReg; }
+
+bool MachineOperand::isNone() const { return kind == None; }
+
+/**********************************************************************************/
+/* The MachineInstr Class                                                         */
+/**********************************************************************************/
+
+MachineInstr::MachineInstr(Opcode op_)
+    : op(op_), cc(EQ), def(), uses(), sym(), frameIdx(-1), line(0), lanes(0) {
+    target[0] = -1;
+    target[1] = -1;
+}
+
+bool MachineInstr::isTerminator() const {
+    return op == Jmp || op == CmpBr || op == Ret;
+}
+
+MachineInstr::CondCode MachineInstr::invert(CondCode code) {
+    switch (code) {
+        case EQ: return NE;
+        case NE: return EQ;
+        case LT: return GE;
+        case LE: return GT;
+        case GT: return LE;
+        case GE: return LT;
+    }
+    return code;
+}
+
+/**********************************************************************************/
+/* The MachineBasicBlock Class                                                    */
+/**********************************************************************************/
+
+MachineBasicBlock::MachineBasicBlock(const std::string &label_) : label(label_), instrs() {}
+
+bool MachineBasicBlock::isTerminated() const {
+    return !instrs.empty() && instrs.back().isTerminator();
+}
+
+std::vector<int> MachineBasicBlock::getSuccessors() const {
+    std::vector<int> succs;
+    if (!isTerminated())
+        return succs;
+    const MachineInstr &term = instrs.back();
+    if (term.op == MachineInstr::Jmp)
+        succs.push_back(term.target[0]);
+    else if (term.op == MachineInstr::CmpBr) {
+        succs.push_back(term.target[0]);
+        if (term.target[1] != term.target[0])
+            succs.push_back(term.target[1]);
+    }
+    return succs;
+}
+
+/**********************************************************************************/
+/* The MachineLocation Class                                                      */
+/**********************************************************************************/
+
+MachineLocation::MachineLocation() : inReg(false), reg(-1), slot(-1) {}
+
+bool MachineLocation::operator == (const MachineLocation& other) const {
+    if (inReg != other.inReg)
+        return false;
+    return inReg ? reg == other.reg : slot == other.slot;
+}
+
+bool MachineLocation::operator != (const MachineLocation& other) const {
+    return !(*this == other);
+}
+
+/**********************************************************************************/
+/* The MachineFunction Class                                                      */
+/**********************************************************************************/
+
+MachineFunction::MachineFunction(const std::string &name_) : name(name_), numSpillSlots(0) {}
+
+int MachineFunction::newVReg(bool isPtr) {
+    vregIsPtr.push_back(isPtr);
+    return (int)vregIsPtr.size() - 1;
+}
+
+int MachineFunction::newBlock(const std::string &label) {
+    blocks.push_back(MachineBasicBlock(label));
+    return (int)blocks.size() - 1;
+}
+
+int MachineFunction::newFrameObject(int bytes) {
+    frameObjects.push_back(bytes);
+    return (int)frameObjects.size() - 1;
+}
+
+unsigned int MachineFunction::getNumVRegs() const {
+    return (unsigned int)vregIsPtr.size();
+}
+
+/**********************************************************************************/
+/* The MachineModule Class                                                        */
+/**********************************************************************************/
+
+MachineGlobal::MachineGlobal(const std::string &name_, int size_) : name(name_), size(size_) {}
+
+MachineModule::MachineModule() : globals(), functions(), profileKeys(), profileFile() {}
+
+MachineModule::~MachineModule() {
+    for (auto fn : functions)
+        delete fn;
+}
+
+} // namespace smallc
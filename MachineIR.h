@@ -0,0 +1,177 @@
+//
+//  MachineIR.h
+//  ECE467 Lab 3
+//
+//  Machine-level representation used by the x86-64 backend: a CFG of
+//  three-address instructions over an unbounded set of virtual registers.
+//  The register allocator maps each virtual register to a physical
+//  register or a stack slot, and the AsmPrinter turns the result into
+//  GNU assembler syntax.
+//
+
+#ifndef MachineIR_h
+#define MachineIR_h
+
+#include <string>
+#include <vector>
+
+namespace smallc {
+
+// x86-64 general purpose registers, in hardware encoding order
+enum X86Reg {
+    RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+    R8, R9, R10, R11, R12, R13, R14, R15,
+    NumX86Regs
+};
+
+// Register names for 64-bit, 32-bit and 8-bit accesses
+const char* x86RegName(int reg, unsigned int bytes);
+
+/**********************************************************************************/
+/* The MachineOperand Class                                                       */
+/**********************************************************************************/
+class MachineOperand {
+public:
+    enum Kind { None = 0, VReg, Imm, XReg };
+
+    Kind kind;
+    int val;    // Virtual register number, immediate value or vector register
+
+    MachineOperand();
+    static MachineOperand vreg(int reg);
+    static MachineOperand imm(int value);
+    // Vector values are given xmm/ymm registers by instruction selection
+    static MachineOperand xreg(int reg);
+    bool isVReg() const;
+    bool isImm() const;
+    bool isXReg() const;
+    bool isNone() const;
+};
+
+/**********************************************************************************/
+/* The MachineInstr Class                                                         */
+/**********************************************************************************/
+class MachineInstr {
+public:
+    enum Opcode {
+        Copy = 0,    // def = uses[0]
+        Add,         // def = uses[0] + uses[1]
+        Sub,         // def = uses[0] - uses[1]
+        Mul,         // def = uses[0] * uses[1]
+        Div,         // def = uses[0] / uses[1], truncating
+        Neg,         // def = -uses[0]
+        Not,         // def = uses[0] ^ 1
+        SetCC,       // def = uses[0] cc uses[1]
+        Jmp,         // goto target[0]
+        CmpBr,       // if (uses[0] cc uses[1]) goto target[0] else target[1]
+        Call,        // [def =] sym(uses...)
+        Ret,         // return [uses[0]]
+        LoadGlobal,  // def = sym
+        StoreGlobal, // sym = uses[0]
+        AddrGlobal,  // def = &sym
+        AddrFrame,   // def = &frame object frameIdx
+        LoadElem,    // def = uses[0][uses[1]]
+        StoreElem,   // uses[0][uses[1]] = uses[2]
+        BoundsCheck, // trap unless 0 <= uses[0] < uses[1]
+        ProfileInc,  // profile counter uses[0] += 1
+        VecLoad,     // def = uses[0][uses[1] .. uses[1] + lanes - 1]
+        VecStore,    // uses[0][uses[1] .. uses[1] + lanes - 1] = uses[2]
+        VecSplat,    // def = uses[0] in every lane
+        VecIndex,    // def = uses[0], uses[0] + 1, ...
+        VecAdd,      // def = uses[0] + uses[1], lane by lane
+        VecSub,      // def = uses[0] - uses[1]
+        VecMul,      // def = uses[0] * uses[1]
+        VecNeg,      // def = -uses[0]
+        VecEnd       // leave the vector unit, after code of lanes width
+    };
+
+    enum CondCode { EQ = 0, NE, LT, LE, GT, GE };
+
+    Opcode op;
+    CondCode cc;
+    MachineOperand def;                 // Defined register, or None
+    std::vector<MachineOperand> uses;   // Used operands
+    std::string sym;                    // Global or callee symbol
+    int target[2];                      // Branch targets (block indices)
+    int frameIdx;                       // Frame object for AddrFrame
+    unsigned int line;                  // Source line reported by BoundsCheck
+    unsigned int lanes;                 // Vector width: 4 (SSE2) or 8 (AVX2)
+
+    explicit MachineInstr(Opcode op_);
+    bool isTerminator() const;
+    static CondCode invert(CondCode code);
+};
+
+/**********************************************************************************/
+/* The MachineBasicBlock Class                                                    */
+/**********************************************************************************/
+class MachineBasicBlock {
+public:
+    std::string label;
+    std::vector<MachineInstr> instrs;
+
+    explicit MachineBasicBlock(const std::string &label_);
+    bool isTerminated() const;
+    std::vector<int> getSuccessors() const;
+};
+
+/**********************************************************************************/
+/* The MachineLocation Class                                                      */
+/**********************************************************************************/
+// Where the register allocator placed a virtual register
+class MachineLocation {
+public:
+    bool inReg;     // Physical register or stack slot?
+    int reg;        // X86Reg when inReg
+    int slot;       // Spill slot index otherwise
+
+    MachineLocation();
+    bool operator == (const MachineLocation& other) const;
+    bool operator != (const MachineLocation& other) const;
+};
+
+/**********************************************************************************/
+/* The MachineFunction Class                                                      */
+/**********************************************************************************/
+class MachineFunction {
+public:
+    std::string name;
+    std::vector<MachineBasicBlock> blocks;  // blocks[0] is the entry
+    std::vector<int> args;                  // vreg receiving each argument
+    std::vector<bool> vregIsPtr;            // 64-bit (pointer) vregs
+    std::vector<int> frameObjects;          // Local array sizes in bytes
+    std::vector<MachineLocation> locs;      // Filled by register allocation
+    int numSpillSlots;
+
+    explicit MachineFunction(const std::string &name_);
+    int newVReg(bool isPtr = false);
+    int newBlock(const std::string &label);
+    int newFrameObject(int bytes);
+    unsigned int getNumVRegs() const;
+};
+
+/**********************************************************************************/
+/* The MachineModule Class                                                        */
+/**********************************************************************************/
+class MachineGlobal {
+public:
+    std::string name;
+    int size;       // Size in bytes
+
+    MachineGlobal(const std::string &name_, int size_);
+};
+
+class MachineModule {
+public:
+    std::vector<MachineGlobal> globals;
+    std::vector<MachineFunction*> functions;
+    std::vector<std::string> profileKeys;   // Site of each profile counter
+    std::string profileFile;                // Where the program writes its counts
+
+    MachineModule();
+    ~MachineModule();
+};
+
+} // namespace smallc
+
+#endif /* MachineIR_h */
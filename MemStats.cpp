@@ -0,0 +1,184 @@
+//
+//  MemStats.cpp
+//  ECE467 Lab 3
+//
+//  Memory accounting by object type for --mem-stats.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <cxxabi.h>
+
+#include "MemStats.h"
+
+namespace smallc {
+
+namespace {
+
+// Every tracked object together, for the true peak of the whole
+std::atomic<long long> totalBytes(0);
+std::atomic<long long> totalPeakBytes(0);
+
+void raise(std::atomic<long long> &peak, long long value) {
+    long long old = peak.load(std::memory_order_relaxed);
+    while (value > old && !peak.compare_exchange_weak(old, value, std::memory_order_relaxed))
+        ;
+}
+
+void addTotal(long long bytes) {
+    raise(totalPeakBytes, totalBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+// Counters live until exit; they are only ever added to
+class Registry {
+public:
+    std::mutex lock;
+    std::vector<std::unique_ptr<MemStats::Counter>> counters;
+};
+
+Registry &registry() {
+    static Registry* reg = new Registry();
+    return *reg;
+}
+
+const char* groupName(MemStats::Group group) {
+    switch (group) {
+        case MemStats::Antlr:           return "ANTLR";
+        case MemStats::AST:             return "AST";
+        case MemStats::SymbolTables:    return "symbol tables";
+        case MemStats::Sema:            return "sema";
+        default:                        return "?";
+    }
+}
+
+} // namespace
+
+bool MemStats::enabled = false;
+
+/**********************************************************************************/
+/* The Counter Class                                                              */
+/**********************************************************************************/
+
+MemStats::Counter::Counter(Group group_, const std::string &name_)
+    : group(group_), name(name_), live(0), liveBytes(0), peak(0), peakBytes(0), allocations(0) {}
+
+void MemStats::Counter::add(long long bytes) {
+    raise(peak, live.fetch_add(1, std::memory_order_relaxed) + 1);
+    raise(peakBytes, liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    addTotal(bytes);
+}
+
+void MemStats::Counter::remove(long long bytes) {
+    live.fetch_sub(1, std::memory_order_relaxed);
+    liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    totalBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void MemStats::Counter::set(long long count, long long bytes) {
+    long long added = count - live.exchange(count, std::memory_order_relaxed);
+    if (added > 0)
+        allocations.fetch_add(added, std::memory_order_relaxed);
+    raise(peak, count);
+    addTotal(bytes - liveBytes.exchange(bytes, std::memory_order_relaxed));
+    raise(peakBytes, bytes);
+}
+
+/**********************************************************************************/
+/* The MemStats Class                                                             */
+/**********************************************************************************/
+
+MemStats::Counter &MemStats::getCounter(Group group, const std::string &name) {
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    for (auto &counter : reg.counters) {
+        if (counter->group == group && counter->name == name)
+            return *counter;
+    }
+    reg.counters.emplace_back(new Counter(group, name));
+    return *reg.counters.back();
+}
+
+std::string MemStats::typeName(const std::type_info &type) {
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    std::string name = status == 0 ? demangled : type.name();
+    std::free(demangled);
+    if (name.compare(0, 8, "smallc::") == 0)
+        name.erase(0, 8);
+    return name;
+}
+
+void MemStats::clear(Group group) {
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    for (auto &counter : reg.counters) {
+        if (counter->group == group)
+            counter->set(0, 0);
+    }
+}
+
+void* MemStats::allocate(Counter &counter, std::size_t size) {
+    void* ptr = ::operator new(size);
+    counter.add((long long)size);
+    return ptr;
+}
+
+void MemStats::deallocate(Counter &counter, void* ptr, std::size_t size) {
+    counter.remove((long long)size);
+    ::operator delete(ptr);
+}
+
+void MemStats::print(std::ostream &out) {
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    std::vector<Counter*> counters;
+    for (auto &counter : reg.counters) {
+        if (counter->allocations > 0)
+            counters.push_back(counter.get());
+    }
+    std::sort(counters.begin(), counters.end(), [](Counter* a, Counter* b) {
+        if (a->group != b->group)
+            return a->group < b->group;
+        return a->peakBytes > b->peakBytes;
+    });
+
+    char line[200];
+    out << "===-------------------------------------------------------------------===\n";
+    out << "                          Memory by object type\n";
+    out << "===-------------------------------------------------------------------===\n";
+    std::snprintf(line, sizeof(line), "  %-14s%-22s %10s %11s %10s %11s %11s\n",
+                  "Group", "Type", "Live", "Live KB", "Peak", "Peak KB", "Allocated");
+    out << line;
+    long long groupLive[NumGroups] = {}, groupPeak[NumGroups] = {};
+    for (auto counter : counters) {
+        std::snprintf(line, sizeof(line), "  %-14s%-22s %10lld %11.1f %10lld %11.1f %11lld\n",
+                      groupName(counter->group), counter->name.c_str(), counter->live.load(),
+                      counter->liveBytes / 1024.0, counter->peak.load(), counter->peakBytes / 1024.0,
+                      counter->allocations.load());
+        out << line;
+        groupLive[counter->group] += counter->liveBytes;
+        groupPeak[counter->group] += counter->peakBytes;
+    }
+
+    // Peaks of different types need not coincide, so a group's peak is
+    // an upper bound; the total's is exact
+    out << "\n";
+    std::snprintf(line, sizeof(line), "  %-14s%11s %11s\n", "Group", "Live KB", "Peak KB");
+    out << line;
+    for (int group = 0; group < NumGroups; group++) {
+        std::snprintf(line, sizeof(line), "  %-14s%11.1f %11.1f\n", groupName((Group)group),
+                      groupLive[group] / 1024.0, groupPeak[group] / 1024.0);
+        out << line;
+    }
+    std::snprintf(line, sizeof(line), "  %-14s%11.1f %11.1f\n", "Total",
+                  totalBytes / 1024.0, totalPeakBytes / 1024.0);
+    out << line;
+}
+
+} // namespace smallc
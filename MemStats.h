@@ -0,0 +1,158 @@
+//
+//  MemStats.h
+//  ECE467 Lab 3
+//
+//  Memory accounting by object type for --mem-stats. A counter per type
+//  tracks how many objects of it are live and how many bytes they take,
+//  and the peak of both, so a large compile can be traced to the
+//  structure its memory went to: ANTLR's tokens and parse tree, the AST,
+//  the symbol tables or the analyzer's errors.
+//
+//  Objects are counted in one of three ways:
+//
+//   - AST classes count their allocations with SMALLC_COUNT_NEW, which
+//     gives the class its own operator new and delete;
+//   - value types count their constructions and destructions by
+//     deriving from MemStats::Instance;
+//   - standard containers count their element nodes through
+//     MemStats::Allocator.
+//
+//  ANTLR's objects are not allocated by this code, so their counters are
+//  filled in by walking the token stream and parse tree.
+//
+//  Counting is off unless --mem-stats turns it on, before anything counted
+//  is allocated; until then new, delete and the constructors only test
+//  MemStats::enabled. Once on it stays on, and it is thread safe.
+//
+
+#ifndef MemStats_h
+#define MemStats_h
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+
+namespace smallc {
+
+class MemStats {
+public:
+    enum Group { Antlr, AST, SymbolTables, Sema, NumGroups };
+
+    class Counter {
+    public:
+        Group group;
+        std::string name;
+        std::atomic<long long> live;
+        std::atomic<long long> liveBytes;
+        std::atomic<long long> peak;
+        std::atomic<long long> peakBytes;
+        std::atomic<long long> allocations;
+
+        Counter(Group group_, const std::string &name_);
+
+        void add(long long bytes);
+        void remove(long long bytes);
+        // For objects counted all at once rather than as they come and go
+        void set(long long count, long long bytes);
+    };
+
+    // Set once, before lexing, and never cleared, so nothing is removed
+    // from a counter that was not added to it
+    static bool enabled;
+
+    template <class T, Group G> class Instance;
+    template <class T, class Named, Group G> class Allocator;
+
+    // The counter is created the first time it is asked for
+    static Counter &getCounter(Group group, const std::string &name);
+
+    template <class T, Group G>
+    static Counter &counterFor() {
+        static Counter &counter = getCounter(G, typeName(typeid(T)));
+        return counter;
+    }
+
+    // Readable name of a type, without the smallc namespace
+    static std::string typeName(const std::type_info &type);
+
+    // The objects of a group counted with Counter::set were freed
+    static void clear(Group group);
+
+    static void* allocate(Counter &counter, std::size_t size);
+    static void deallocate(Counter &counter, void* ptr, std::size_t size);
+
+    static void print(std::ostream &out);
+};
+
+// Counts the objects of T alive, for types copied around by value
+template <class T, MemStats::Group G>
+class MemStats::Instance {
+protected:
+    Instance() { if (enabled) counterFor<T, G>().add(sizeof(T)); }
+    Instance(const Instance &) { if (enabled) counterFor<T, G>().add(sizeof(T)); }
+    Instance &operator=(const Instance &) = default;
+    ~Instance() { if (enabled) counterFor<T, G>().remove(sizeof(T)); }
+};
+
+// Allocator for a standard container holding T, counted under the name
+// of Named. Containers rebind it to their node type, so it counts the
+// memory they really take.
+template <class T, class Named, MemStats::Group G>
+class MemStats::Allocator {
+public:
+    typedef T value_type;
+
+    template <class U>
+    class rebind {
+    public:
+        typedef Allocator<U, Named, G> other;
+    };
+
+    Allocator() {}
+    template <class U>
+    Allocator(const Allocator<U, Named, G> &) {}
+
+    T* allocate(std::size_t n) {
+        if (!enabled)
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        return static_cast<T*>(MemStats::allocate(counterFor<Named, G>(), n * sizeof(T)));
+    }
+    void deallocate(T* ptr, std::size_t n) {
+        if (!enabled)
+            ::operator delete(ptr);
+        else
+            MemStats::deallocate(counterFor<Named, G>(), ptr, n * sizeof(T));
+    }
+
+    template <class U>
+    bool operator==(const Allocator<U, Named, G> &) const { return true; }
+    template <class U>
+    bool operator!=(const Allocator<U, Named, G> &) const { return false; }
+};
+
+} // namespace smallc
+
+// Counts the objects of an AST class allocated with new. Put it first in
+// the class; classes derived from it without their own count as it.
+#define SMALLC_COUNT_NEW(Class)                                                        \
+public:                                                                                \
+    static void* operator new(std::size_t size) {                                      \
+        if (!smallc::MemStats::enabled)                                                \
+            return ::operator new(size);                                               \
+        return smallc::MemStats::allocate(                                             \
+            smallc::MemStats::counterFor<Class, smallc::MemStats::AST>(), size);       \
+    }                                                                                  \
+    static void operator delete(void* ptr, std::size_t size) {                         \
+        if (!smallc::MemStats::enabled)                                                \
+            ::operator delete(ptr);                                                    \
+        else                                                                           \
+            smallc::MemStats::deallocate(                                              \
+                smallc::MemStats::counterFor<Class, smallc::MemStats::AST>(),          \
+                ptr, size);                                                            \
+    }                                                                                  \
+private:
+
+#endif /* MemStats_h */
@@ -0,0 +1,181 @@
+//
+//  ParserProfile.cpp
+//  ECE467 Lab 3
+//
+//  Parser prediction profiling for --profile-parser.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+
+#include "ParserProfile.h"
+
+namespace smallc {
+
+ParserProfile::ParserProfile(antlr4::Parser* parser_) : parser(parser_), rules(), stack(), ruleLines() {
+    RuleStats stats;
+    stats.invocations = 0;
+    stats.active = 0;
+    stats.seconds = 0;
+    rules.assign(parser->getRuleNames().size(), stats);
+    parser->setProfile(true);
+    parser->addParseListener(this);
+}
+
+// A rule is defined where its name starts a line
+bool ParserProfile::readGrammar(const std::string &path) {
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    std::string line;
+    unsigned int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        size_t end = 0;
+        while (end < line.size() && (isalnum((unsigned char)line[end]) || line[end] == '_'))
+            end++;
+        if (end > 0 && isalpha((unsigned char)line[0]))
+            ruleLines.insert(std::make_pair(line.substr(0, end), lineNo));
+    }
+    return true;
+}
+
+std::string ParserProfile::ruleLine(size_t rule) {
+    auto it = ruleLines.find(parser->getRuleNames()[rule]);
+    if (it == ruleLines.end())
+        return "?";
+    return std::to_string(it->second);
+}
+
+std::string ParserProfile::decisionKind(size_t decision) {
+    antlr4::atn::DecisionState* state = parser->getATN().decisionToState[decision];
+    switch (state->getStateType()) {
+        case antlr4::atn::ATNState::STAR_LOOP_ENTRY: {
+            auto entry = dynamic_cast<antlr4::atn::StarLoopEntryState*>(state);
+            if (entry && entry->isPrecedenceDecision)
+                return "left recursion";
+            return "(...)* enter";
+        }
+        case antlr4::atn::ATNState::PLUS_LOOP_BACK:
+            return "(...)+ repeat";
+        case antlr4::atn::ATNState::STAR_BLOCK_START:
+            return "(...)* alts";
+        case antlr4::atn::ATNState::PLUS_BLOCK_START:
+            return "(...)+ alts";
+        case antlr4::atn::ATNState::BLOCK_START:
+            return "alternatives";
+        default:
+            return "other";
+    }
+}
+
+/**********************************************************************************/
+/* Rule Invocations                                                               */
+/**********************************************************************************/
+
+void ParserProfile::enterEveryRule(antlr4::ParserRuleContext* ctx) {
+    size_t rule = ctx->getRuleIndex();
+    if (rule >= rules.size())
+        return;
+    RuleStats &stats = rules[rule];
+    stats.invocations++;
+    if (stats.active++ == 0)
+        stats.start = std::chrono::steady_clock::now();
+    stack.push_back(rule);
+}
+
+// Time in a recursive rule counts once, for its outermost invocation
+void ParserProfile::exitEveryRule(antlr4::ParserRuleContext* ctx) {
+    if (stack.empty() || stack.back() != ctx->getRuleIndex())
+        return;
+    RuleStats &stats = rules[stack.back()];
+    stack.pop_back();
+    if (--stats.active == 0)
+        stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - stats.start).count();
+}
+
+void ParserProfile::visitTerminal(antlr4::tree::TerminalNode*) {}
+
+void ParserProfile::visitErrorNode(antlr4::tree::ErrorNode*) {}
+
+/**********************************************************************************/
+/* The Report                                                                     */
+/**********************************************************************************/
+
+void ParserProfile::print(std::ostream &out) {
+    auto sim = parser->getInterpreter<antlr4::atn::ProfilingATNSimulator>();
+    if (!sim) {
+        out << "parser profile: the parser did not run with the profiling simulator\n";
+        return;
+    }
+    auto decisions = sim->getDecisionInfo();
+    const std::vector<std::string> &ruleNames = parser->getRuleNames();
+
+    // Hottest decisions first
+    std::vector<size_t> order;
+    for (size_t i = 0; i < decisions.size(); i++) {
+        if (decisions[i].invocations > 0)
+            order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return decisions[a].timeInPrediction > decisions[b].timeInPrediction;
+    });
+
+    char line[240];
+    out << "===-------------------------------------------------------------------===\n";
+    out << "                 Parser prediction profile (" << parser->getGrammarFileName() << ")\n";
+    out << "===-------------------------------------------------------------------===\n";
+    std::snprintf(line, sizeof(line), "  %4s  %-14s %5s  %-15s %10s  %7s %5s  %9s %7s %5s  %5s %5s  %10s\n",
+                  "Dec", "Rule", "Line", "Kind", "Calls", "SLL avg", "max", "LL falls", "LL avg",
+                  "max", "Ambig", "Ctx", "Time (ms)");
+    out << line;
+    long long calls = 0, fallbacks = 0, nanos = 0;
+    std::vector<long long> rulePrediction(rules.size(), 0);
+    std::vector<long long> ruleFallbacks(rules.size(), 0);
+    for (auto i : order) {
+        const auto &info = decisions[i];
+        size_t rule = parser->getATN().decisionToState[i]->ruleIndex;
+        std::snprintf(line, sizeof(line),
+                      "  %4zu  %-14s %5s  %-15s %10lld  %7.2f %5lld  %9lld %7.2f %5lld  %5zu %5zu  %10.3f\n",
+                      i, ruleNames[rule].c_str(), ruleLine(rule).c_str(), decisionKind(i).c_str(),
+                      info.invocations, (double)info.SLL_TotalLook / info.invocations, info.SLL_MaxLook,
+                      info.LL_Fallback, info.LL_Fallback ? (double)info.LL_TotalLook / info.LL_Fallback : 0.0,
+                      info.LL_MaxLook, info.ambiguities.size(), info.contextSensitivities.size(),
+                      info.timeInPrediction / 1e6);
+        out << line;
+        calls += info.invocations;
+        fallbacks += info.LL_Fallback;
+        nanos += info.timeInPrediction;
+        if (rule < rules.size()) {
+            rulePrediction[rule] += info.timeInPrediction;
+            ruleFallbacks[rule] += info.LL_Fallback;
+        }
+    }
+    std::snprintf(line, sizeof(line), "  %4s  %-14s %5s  %-15s %10lld  %7s %5s  %9lld %7s %5s  %5s %5s  %10.3f\n",
+                  "", "Total", "", "", calls, "", "", fallbacks, "", "", "", "", nanos / 1e6);
+    out << line;
+
+    // Rules by time spent in them, parsing and predicting
+    std::vector<size_t> byTime;
+    for (size_t i = 0; i < rules.size(); i++) {
+        if (rules[i].invocations > 0)
+            byTime.push_back(i);
+    }
+    std::sort(byTime.begin(), byTime.end(), [&](size_t a, size_t b) {
+        return rules[a].seconds > rules[b].seconds;
+    });
+    out << "\n";
+    std::snprintf(line, sizeof(line), "  %-14s %5s  %12s  %10s  %15s  %9s\n",
+                  "Rule", "Line", "Invocations", "Time (ms)", "Predicting (ms)", "LL falls");
+    out << line;
+    for (auto i : byTime) {
+        std::snprintf(line, sizeof(line), "  %-14s %5s  %12llu  %10.3f  %15.3f  %9lld\n",
+                      ruleNames[i].c_str(), ruleLine(i).c_str(), rules[i].invocations,
+                      rules[i].seconds * 1000.0, rulePrediction[i] / 1e6, ruleFallbacks[i]);
+        out << line;
+    }
+}
+
+} // namespace smallc
@@ -0,0 +1,68 @@
+//
+//  ParserProfile.h
+//  ECE467 Lab 3
+//
+//  Profile of the parser's adaptive prediction for --profile-parser.
+//  The parser runs with ANTLR's profiling ATN simulator, which records
+//  for every decision (each point in the grammar where the parser picks
+//  between alternatives or decides whether to loop again) how often it
+//  was made, how many tokens of lookahead it took, whether SLL
+//  prediction settled it or it fell back to full-context LL prediction,
+//  and the time spent predicting. Listening to the parse adds how often
+//  each rule was entered and the time spent in it.
+//
+//  Decisions and rules are reported with the line of their rule in the
+//  grammar, read from smallC.g4 when it can be found, so the report
+//  points at the alternatives worth restructuring.
+//
+
+#ifndef ParserProfile_h
+#define ParserProfile_h
+
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "antlr4-runtime.h"
+
+namespace smallc {
+
+class ParserProfile : public antlr4::tree::ParseTreeListener {
+private:
+    class RuleStats {
+    public:
+        unsigned long long invocations;
+        unsigned int active;            // Invocations on the rule stack
+        double seconds;                 // Outermost invocations only
+        std::chrono::steady_clock::time_point start;
+    };
+
+    antlr4::Parser* parser;
+    std::vector<RuleStats> rules;
+    std::vector<size_t> stack;          // Rules entered and not yet exited
+    std::map<std::string, unsigned int> ruleLines;
+
+    std::string ruleLine(size_t rule);
+    std::string decisionKind(size_t decision);
+
+public:
+    // Switches the parser to the profiling simulator; call before parsing
+    ParserProfile(antlr4::Parser* parser_);
+
+    // Finds the line of every rule in the grammar; returns false if the
+    // file cannot be read
+    bool readGrammar(const std::string &path);
+
+    void enterEveryRule(antlr4::ParserRuleContext* ctx) override;
+    void exitEveryRule(antlr4::ParserRuleContext* ctx) override;
+    void visitTerminal(antlr4::tree::TerminalNode* node) override;
+    void visitErrorNode(antlr4::tree::ErrorNode* node) override;
+
+    void print(std::ostream &out);
+};
+
+} // namespace smallc
+
+#endif /* ParserProfile_h */
@@ -0,0 +1,118 @@
+//
+//  PassManager.cpp
+//  ECE467 Lab 3
+//
+//  Runs a pipeline of IR passes over a Module.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+#include "PassManager.h"
+#include "IRVerifier.h"
+
+namespace smallc {
+
+/**********************************************************************************/
+/* The Pass Classes                                                               */
+/**********************************************************************************/
+
+Pass::~Pass() {}
+
+void Pass::printStatistics(std::ostream &) {}
+
+bool FunctionPass::runOnModule(Module* m) {
+    bool changed = false;
+    for (auto fn : m->getFunctions()) {
+        if (fn->getEntry())
+            changed |= runOnFunction(fn);
+    }
+    return changed;
+}
+
+/**********************************************************************************/
+/* The PassManager Class                                                          */
+/**********************************************************************************/
+
+PassManager::PassManager() : passes(), verifyEach(false), printStats(false), dumpAfter(nullptr),
+                             timeReport(nullptr) {}
+
+PassManager::~PassManager() {
+    for (auto &rec : passes)
+        delete rec.pass;
+}
+
+void PassManager::add(Pass* pass) {
+    PassRecord rec;
+    rec.pass = pass;
+    rec.seconds = 0;
+    rec.instsBefore = 0;
+    rec.instsAfter = 0;
+    rec.changed = false;
+    passes.push_back(rec);
+}
+
+void PassManager::setVerifyEach(bool flag) { verifyEach = flag; }
+
+void PassManager::setPrintStatistics(bool flag) { printStats = flag; }
+
+void PassManager::setDumpAfterEach(std::ostream* out) { dumpAfter = out; }
+
+void PassManager::setTimeReport(TimeReport* report) { timeReport = report; }
+
+bool PassManager::run(Module* m) {
+    if (verifyEach && !verifyModule(m, std::cerr)) {
+        std::cerr << "IR verification failed before any pass\n";
+        return false;
+    }
+    for (auto &rec : passes) {
+        rec.instsBefore = m->getInstructionCount();
+        auto start = std::chrono::steady_clock::now();
+        {
+            TimeReport::Timer timer(timeReport, rec.pass->getName());
+            rec.changed = rec.pass->runOnModule(m);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        rec.seconds = std::chrono::duration<double>(stop - start).count();
+        rec.instsAfter = m->getInstructionCount();
+
+        if (printStats)
+            rec.pass->printStatistics(std::cerr);
+        if (dumpAfter) {
+            *dumpAfter << "; *** IR after " << rec.pass->getName() << " ***\n";
+            m->print(*dumpAfter);
+        }
+        if (verifyEach && !verifyModule(m, std::cerr)) {
+            std::cerr << "IR verification failed after " << rec.pass->getName() << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+void PassManager::printTimings(std::ostream &out) {
+    double total = 0;
+    for (const auto &rec : passes)
+        total += rec.seconds;
+
+    char line[160];
+    out << "===-------------------------------------------------------------------===\n";
+    out << "                        Pass execution timing report\n";
+    out << "===-------------------------------------------------------------------===\n";
+    std::snprintf(line, sizeof(line), "  %10s  %6s  %8s  %8s  %s\n",
+                  "Wall (ms)", "%", "Insts", "Delta", "Pass");
+    out << line;
+    for (const auto &rec : passes) {
+        std::snprintf(line, sizeof(line), "  %10.3f  %5.1f%%  %8u  %+8d  %s%s\n",
+                      rec.seconds * 1000.0, total > 0 ? 100.0 * rec.seconds / total : 0.0,
+                      rec.instsAfter, (int)rec.instsAfter - (int)rec.instsBefore,
+                      rec.pass->getName(), rec.changed ? "" : " (no change)");
+        out << line;
+    }
+    std::snprintf(line, sizeof(line), "  %10.3f  %5.1f%%  %8s  %8s  %s\n",
+                  total * 1000.0, 100.0, "", "", "Total");
+    out << line;
+}
+
+} // namespace smallc
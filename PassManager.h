@@ -0,0 +1,80 @@
+//
+//  PassManager.h
+//  ECE467 Lab 3
+//
+//  Runs a pipeline of IR passes over a Module, timing each pass and
+//  optionally verifying the IR after it.
+//
+
+#ifndef PassManager_h
+#define PassManager_h
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "IR.h"
+#include "TimeReport.h"
+
+namespace smallc {
+
+/**********************************************************************************/
+/* The Pass Classes                                                               */
+/**********************************************************************************/
+class Pass {
+public:
+    virtual ~Pass();
+    virtual const char* getName() const = 0;
+    // Returns true if the module changed
+    virtual bool runOnModule(Module* m) = 0;
+    // Print anything worth reporting after the pass ran
+    virtual void printStatistics(std::ostream &out);
+};
+
+class FunctionPass : public Pass {
+public:
+    // Runs runOnFunction on every function with a body
+    bool runOnModule(Module* m) override;
+    virtual bool runOnFunction(Function* fn) = 0;
+};
+
+/**********************************************************************************/
+/* The PassManager Class                                                          */
+/**********************************************************************************/
+class PassManager {
+private:
+    class PassRecord {
+    public:
+        Pass* pass;
+        double seconds;         // Wall time spent in the pass
+        unsigned int instsBefore;
+        unsigned int instsAfter;
+        bool changed;
+    };
+
+    std::vector<PassRecord> passes;
+    bool verifyEach;            // Run the verifier after every pass
+    bool printStats;            // Let each pass report its statistics
+    std::ostream* dumpAfter;    // Dump the IR after every pass, if set
+    TimeReport* timeReport;     // Time every pass as a phase, if set
+
+public:
+    PassManager();
+    ~PassManager();
+
+    // The manager takes ownership of the pass
+    void add(Pass* pass);
+    void setVerifyEach(bool flag);
+    void setPrintStatistics(bool flag);
+    void setDumpAfterEach(std::ostream* out);
+    void setTimeReport(TimeReport* report);
+
+    // Returns false if verification failed
+    bool run(Module* m);
+
+    void printTimings(std::ostream &out);
+};
+
+} // namespace smallc
+
+#endif /* PassManager_h */
@@ -0,0 +1,108 @@
+//
+//  PerfCounters.cpp
+//  ECE467 Lab 3
+//
+//  Hardware performance counters through perf_event_open.
+//
+
+#include <cerrno>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "PerfCounters.h"
+
+namespace smallc {
+
+PerfCounters::PerfCounters() : leader(-1), numOpen(0), error() {
+    for (int i = 0; i < NumEvents; i++) {
+        fds[i] = -1;
+        order[i] = Cycles;
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int i = 0; i < NumEvents; i++) {
+        if (fds[i] >= 0)
+            close(fds[i]);
+    }
+}
+
+const char* PerfCounters::getEventName(Event event) {
+    switch (event) {
+        case Cycles:        return "cycles";
+        case Instructions:  return "instructions";
+        case CacheMisses:   return "cache misses";
+        case BranchMisses:  return "branch misses";
+        default:            return "?";
+    }
+}
+
+bool PerfCounters::open() {
+    static const unsigned long long configs[NumEvents] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    int firstErrno = 0;
+    for (int i = 0; i < NumEvents; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.disabled = leader < 0;     // The group starts when the leader is enabled
+        attr.exclude_kernel = 1;        // Allowed at perf_event_paranoid 2
+        attr.exclude_hv = 1;
+        int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+        if (fd < 0) {
+            if (firstErrno == 0)
+                firstErrno = errno;
+            continue;
+        }
+        fds[i] = fd;
+        if (leader < 0)
+            leader = fd;
+        order[numOpen++] = (Event)i;
+    }
+    if (numOpen == 0) {
+        error = std::string("perf_event_open: ") + strerror(firstErrno);
+        if (firstErrno == EACCES || firstErrno == EPERM)
+            error += " (see /proc/sys/kernel/perf_event_paranoid)";
+        else if (firstErrno == ENOENT || firstErrno == EOPNOTSUPP)
+            error += " (no hardware counters, as in most virtual machines)";
+        return false;
+    }
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+const std::string &PerfCounters::getError() const { return error; }
+
+bool PerfCounters::isOpen(Event event) const { return fds[event] >= 0; }
+
+// When more counters are asked for than the PMU has, the kernel time
+// slices them; counts are scaled up to the whole time enabled
+void PerfCounters::read(Reading &reading) {
+    for (int i = 0; i < NumEvents; i++)
+        reading.values[i] = -1;
+    if (leader < 0)
+        return;
+    unsigned long long buf[3 + NumEvents];
+    if (::read(leader, buf, sizeof(buf)) < (ssize_t)(3 * sizeof(buf[0])))
+        return;
+    unsigned long long nr = buf[0], enabled = buf[1], running = buf[2];
+    for (unsigned long long i = 0; i < nr && i < numOpen; i++) {
+        double value = (double)buf[3 + i];
+        if (running > 0 && running < enabled)
+            value = value * enabled / running;
+        reading.values[order[i]] = (long long)value;
+    }
+}
+
+} // namespace smallc
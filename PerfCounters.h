@@ -0,0 +1,57 @@
+//
+//  PerfCounters.h
+//  ECE467 Lab 3
+//
+//  Hardware performance counters for --perf-counters, read through
+//  Linux's perf_event_open. The counters are opened once for the whole
+//  process, user space only, as one group so they are always scheduled
+//  together and their values line up; a phase's counts are the
+//  difference between readings at its start and end.
+//
+//  Counters the CPU or the kernel do not offer are left out. If none can
+//  be opened (no PMU in a virtual machine, perf_event_paranoid too
+//  strict, a seccomp filter), open() fails with the reason and the
+//  compile goes on without them.
+//
+
+#ifndef PerfCounters_h
+#define PerfCounters_h
+
+#include <string>
+
+namespace smallc {
+
+class PerfCounters {
+public:
+    enum Event { Cycles, Instructions, CacheMisses, BranchMisses, NumEvents };
+
+    // Counts since the counters were opened; -1 for a counter not open
+    class Reading {
+    public:
+        long long values[NumEvents];
+    };
+
+private:
+    int fds[NumEvents];         // -1 if the event could not be opened
+    int leader;                 // Group leader's fd
+    Event order[NumEvents];     // Events in the order the group reports them
+    unsigned int numOpen;
+    std::string error;
+
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    // Returns false if no counter could be opened; getError says why
+    bool open();
+    const std::string &getError() const;
+    bool isOpen(Event event) const;
+
+    void read(Reading &reading);
+
+    static const char* getEventName(Event event);
+};
+
+} // namespace smallc
+
+#endif /* PerfCounters_h */
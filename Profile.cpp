@@ -0,0 +1,190 @@
+//
+//  Profile.cpp
+//  ECE467 Lab 3
+//
+//  Profile instrumentation and annotation.
+//
+
+#include <fstream>
+#include <sstream>
+
+#include "Profile.h"
+
+namespace smallc {
+
+/**********************************************************************************/
+/* The ProfileSite Class                                                          */
+/**********************************************************************************/
+
+std::vector<ProfileSite> ProfileSite::collect(Function* fn) {
+    static const char* kindNames[] = { "block", "branch", "call" };
+    std::vector<ProfileSite> sites;
+    std::map<std::string, unsigned int> seen;
+    auto add = [&](Kind kind, BasicBlock* bb, Instruction* inst,
+                   std::pair<unsigned int, unsigned int> loc) {
+        std::ostringstream key;
+        key << fn->getName() << " " << kindNames[kind] << " " << loc.first << " " << loc.second;
+        unsigned int ordinal = seen[key.str()]++;
+        key << " " << ordinal;
+        ProfileSite site;
+        site.kind = kind;
+        site.block = bb;
+        site.inst = inst;
+        site.key = key.str();
+        sites.push_back(site);
+    };
+
+    for (auto bb : fn->getBlocks()) {
+        // A block is known by its first instruction with a source position
+        std::pair<unsigned int, unsigned int> loc(0, 0);
+        for (auto inst : bb->getInstructions()) {
+            if (inst->getLine() != 0) {
+                loc = inst->getLocation();
+                break;
+            }
+        }
+        add(Block, bb, nullptr, loc);
+        for (auto inst : bb->getInstructions()) {
+            if (inst->getOpcode() == Instruction::Call)
+                add(Call, bb, inst, inst->getLocation());
+            // A branch with both edges to one block has nothing to count
+            else if (inst->getOpcode() == Instruction::CondBr &&
+                     inst->getBlockOperand(0) != inst->getBlockOperand(1))
+                add(Branch, bb, inst, inst->getLocation());
+        }
+    }
+    return sites;
+}
+
+/**********************************************************************************/
+/* The ProfileData Class                                                          */
+/**********************************************************************************/
+
+ProfileData::ProfileData() : counts() {}
+
+// Each line is a key followed by a count; lines starting with '#' are
+// comments
+bool ProfileData::read(const std::string &file, std::ostream &errs) {
+    std::ifstream in(file);
+    if (!in) {
+        errs << "error: cannot read profile " << file << "\n";
+        return false;
+    }
+    std::string line;
+    unsigned int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        if (line.empty() || line[0] == '#')
+            continue;
+        size_t space = line.find_last_of(' ');
+        long long count = -1;
+        if (space != std::string::npos) {
+            std::istringstream num(line.substr(space + 1));
+            num >> count;
+        }
+        if (count < 0) {
+            errs << "warning: " << file << ":" << lineNo << ": malformed profile record ignored\n";
+            continue;
+        }
+        counts[line.substr(0, space)] += count;
+    }
+    return true;
+}
+
+long long ProfileData::lookup(const std::string &key) const {
+    auto it = counts.find(key);
+    return it == counts.end() ? -1 : it->second;
+}
+
+bool ProfileData::empty() const { return counts.empty(); }
+
+/**********************************************************************************/
+/* The ProfileInstrument Class                                                    */
+/**********************************************************************************/
+
+ProfileInstrument::ProfileInstrument() : numSites(0) {}
+
+const char* ProfileInstrument::getName() const { return "pgo-instr"; }
+
+void ProfileInstrument::printStatistics(std::ostream &out) {
+    out << "pgo-instr: " << numSites << " profile counters added\n";
+}
+
+// br's true target is reached through a new block holding the counter
+void ProfileInstrument::splitTrueEdge(Instruction* br, Instruction* counter) {
+    BasicBlock* bb = br->getParent();
+    BasicBlock* target = br->getBlockOperand(0);
+    Function* fn = bb->getParent();
+    BasicBlock* edge = fn->createBlock(bb->getName() + ".taken");
+    edge->append(counter);
+    Instruction* jump = new Instruction(Instruction::Br, Value::Void);
+    jump->addBlockOperand(target);
+    jump->setLocation(br->getLocation());
+    edge->append(jump);
+    br->setBlockOperand(0, edge);
+    for (auto phi : target->getPhis())
+        phi->replaceIncomingBlock(bb, edge);
+    fn->moveBlockAfter(edge, bb);
+}
+
+bool ProfileInstrument::runOnModule(Module* m) {
+    for (auto fn : m->getFunctions()) {
+        if (!fn->getEntry())
+            continue;
+        // Number every site before the edge splits add blocks
+        std::vector<ProfileSite> sites = ProfileSite::collect(fn);
+        for (auto &site : sites) {
+            Instruction* counter = new Instruction(Instruction::ProfileCount, Value::Void);
+            counter->addOperand(m->getInt((int)m->addProfileCounter(site.key)));
+            switch (site.kind) {
+                case ProfileSite::Block:
+                    site.block->insertAfterPhis(counter);
+                    break;
+                case ProfileSite::Call:
+                    counter->setLocation(site.inst->getLocation());
+                    site.block->insertBefore(site.inst, counter);
+                    break;
+                case ProfileSite::Branch:
+                    counter->setLocation(site.inst->getLocation());
+                    splitTrueEdge(site.inst, counter);
+                    break;
+            }
+        }
+        fn->recomputePredecessors();
+        numSites += sites.size();
+    }
+    return numSites > 0;
+}
+
+/**********************************************************************************/
+/* The ProfileAnnotate Class                                                      */
+/**********************************************************************************/
+
+ProfileAnnotate::ProfileAnnotate(const ProfileData &profile_)
+    : profile(profile_), numSites(0), numFound(0) {}
+
+const char* ProfileAnnotate::getName() const { return "pgo-use"; }
+
+void ProfileAnnotate::printStatistics(std::ostream &out) {
+    out << "pgo-use: " << numFound << " of " << numSites << " sites found in the profile\n";
+}
+
+bool ProfileAnnotate::runOnModule(Module* m) {
+    for (auto fn : m->getFunctions()) {
+        if (!fn->getEntry())
+            continue;
+        for (auto &site : ProfileSite::collect(fn)) {
+            long long count = profile.lookup(site.key);
+            numSites++;
+            if (count >= 0)
+                numFound++;
+            if (site.kind == ProfileSite::Block)
+                site.block->setProfileCount(count);
+            else
+                site.inst->setProfileCount(count);
+        }
+    }
+    return false;
+}
+
+} // namespace smallc
@@ -0,0 +1,101 @@
+//
+//  Profile.h
+//  ECE467 Lab 3
+//
+//  Profile-guided optimization. A program compiled with
+//  --profile-generate counts how often each basic block runs, how often
+//  each conditional branch is taken and how often each call is made, and
+//  appends the counts to a profile file when it exits. Compiling again
+//  with --profile-use reads the file back and attaches the counts to the
+//  IR, where the inliner, block layout and the loop passes consult them.
+//
+//  A counter is identified by a key: the function name, the kind of site
+//  (block, branch or call), the source line and column of the site and
+//  its ordinal among sites of that kind at the same position. Both passes
+//  run on the IR just as IRGen produced it and enumerate the sites the
+//  same way, so the keys match as long as the source does. Sites missing
+//  from the profile keep an unknown count.
+//
+
+#ifndef Profile_h
+#define Profile_h
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "PassManager.h"
+
+namespace smallc {
+
+/**********************************************************************************/
+/* The ProfileSite Class                                                          */
+/**********************************************************************************/
+class ProfileSite {
+public:
+    enum Kind { Block = 0, Branch, Call };
+
+    Kind kind;
+    BasicBlock* block;
+    Instruction* inst;      // The CondBr or Call; nullptr for blocks
+    std::string key;
+
+    // Every site of fn, in the order both passes number them
+    static std::vector<ProfileSite> collect(Function* fn);
+};
+
+/**********************************************************************************/
+/* The ProfileData Class                                                          */
+/**********************************************************************************/
+// Counts read from a profile file; repeated keys (several runs) add up
+class ProfileData {
+private:
+    std::map<std::string, long long> counts;
+
+public:
+    ProfileData();
+    // Returns false if the file cannot be read
+    bool read(const std::string &file, std::ostream &errs);
+    // -1 if the key is not in the profile
+    long long lookup(const std::string &key) const;
+    bool empty() const;
+};
+
+/**********************************************************************************/
+/* The ProfileInstrument Class                                                    */
+/**********************************************************************************/
+// Adds a counter to every site. A branch is counted on its true edge,
+// which is split so the counter runs only when the branch is taken.
+class ProfileInstrument : public Pass {
+private:
+    unsigned int numSites;
+
+    static void splitTrueEdge(Instruction* br, Instruction* counter);
+
+public:
+    ProfileInstrument();
+    const char* getName() const override;
+    bool runOnModule(Module* m) override;
+    void printStatistics(std::ostream &out) override;
+};
+
+/**********************************************************************************/
+/* The ProfileAnnotate Class                                                      */
+/**********************************************************************************/
+class ProfileAnnotate : public Pass {
+private:
+    const ProfileData &profile;
+    unsigned int numSites;
+    unsigned int numFound;
+
+public:
+    explicit ProfileAnnotate(const ProfileData &profile_);
+    const char* getName() const override;
+    bool runOnModule(Module* m) override;
+    void printStatistics(std::ostream &out) override;
+};
+
+} // namespace smallc
+
+#endif /* Profile_h */
@@ -0,0 +1,214 @@
+//
+//  RegAlloc.cpp
+//  ECE467 Lab 3
+//
+//  Linear-scan register allocation over a MachineFunction.
+//
+
+#include <algorithm>
+
+#include "RegAlloc.h"
+
+namespace smallc {
+
+LiveInterval::LiveInterval() : vreg(-1), start(-1), end(-1), crossesCall(false) {}
+
+LinearScan::LinearScan(MachineFunction* fn_) : fn(fn_) {}
+
+// RAX and RDX are needed by division and returns, R10 and R11 are used by
+// the AsmPrinter to reload spilled operands; none of them is allocatable.
+const std::vector<int>& LinearScan::callerSavedRegs() {
+    static const std::vector<int> regs = { RCX, RSI, RDI, R8, R9 };
+    return regs;
+}
+
+const std::vector<int>& LinearScan::calleeSavedRegs() {
+    static const std::vector<int> regs = { RBX, R12, R13, R14, R15 };
+    return regs;
+}
+
+static void extend(LiveInterval &li, int pos) {
+    if (li.start < 0 || pos < li.start)
+        li.start = pos;
+    if (pos > li.end)
+        li.end = pos;
+}
+
+// Instruction k of the linearized function sits at position 2k+2;
+// position 0 is the function entry where the arguments are defined.
+// The prologue moves all arguments at once, so each one stays live until
+// position 1, even if it is never used, and no two share a register.
+void LinearScan::computeIntervals() {
+    unsigned int numRegs = fn->getNumVRegs();
+    unsigned int numBlocks = (unsigned int)fn->blocks.size();
+    intervals.assign(numRegs, LiveInterval());
+    for (unsigned int v = 0; v < numRegs; v++)
+        intervals[v].vreg = (int)v;
+    callPositions.clear();
+
+    std::vector<int> blockStart(numBlocks), blockEnd(numBlocks);
+    std::vector<std::vector<bool> > use(numBlocks), def(numBlocks);
+    int pos = 2;
+    for (unsigned int b = 0; b < numBlocks; b++) {
+        blockStart[b] = pos;
+        use[b].assign(numRegs, false);
+        def[b].assign(numRegs, false);
+        for (const auto &mi : fn->blocks[b].instrs) {
+            for (const auto &u : mi.uses) {
+                if (u.isVReg() && !def[b][u.val])
+                    use[b][u.val] = true;
+            }
+            if (mi.def.isVReg())
+                def[b][mi.def.val] = true;
+            pos += 2;
+        }
+        blockEnd[b] = pos - 2 < blockStart[b] ? blockStart[b] : pos - 2;
+    }
+
+    // Backward dataflow for live-in / live-out sets
+    std::vector<std::vector<bool> > liveIn(numBlocks, std::vector<bool>(numRegs, false));
+    std::vector<std::vector<bool> > liveOut(numBlocks, std::vector<bool>(numRegs, false));
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int b = (int)numBlocks - 1; b >= 0; b--) {
+            for (int s : fn->blocks[b].getSuccessors()) {
+                for (unsigned int v = 0; v < numRegs; v++) {
+                    if (liveIn[s][v] && !liveOut[b][v]) {
+                        liveOut[b][v] = true;
+                        changed = true;
+                    }
+                }
+            }
+            for (unsigned int v = 0; v < numRegs; v++) {
+                bool in = use[b][v] || (liveOut[b][v] && !def[b][v]);
+                if (in && !liveIn[b][v]) {
+                    liveIn[b][v] = true;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    for (int a : fn->args) {
+        extend(intervals[a], 0);
+        extend(intervals[a], 1);
+    }
+    pos = 2;
+    for (unsigned int b = 0; b < numBlocks; b++) {
+        for (unsigned int v = 0; v < numRegs; v++) {
+            if (liveIn[b][v])
+                extend(intervals[v], blockStart[b]);
+            if (liveOut[b][v])
+                extend(intervals[v], blockEnd[b]);
+        }
+        for (const auto &mi : fn->blocks[b].instrs) {
+            for (const auto &u : mi.uses) {
+                if (u.isVReg())
+                    extend(intervals[u.val], pos);
+            }
+            if (mi.def.isVReg())
+                extend(intervals[mi.def.val], pos);
+            if (mi.op == MachineInstr::Call)
+                callPositions.push_back(pos);
+            pos += 2;
+        }
+    }
+
+    for (auto &li : intervals) {
+        if (li.start < 0)
+            continue;
+        auto it = std::upper_bound(callPositions.begin(), callPositions.end(), li.start);
+        li.crossesCall = (it != callPositions.end() && *it < li.end);
+    }
+}
+
+void LinearScan::spill(int vreg) {
+    fn->locs[vreg].inReg = false;
+    fn->locs[vreg].reg = -1;
+    fn->locs[vreg].slot = fn->numSpillSlots++;
+}
+
+void LinearScan::allocate() {
+    std::vector<int> order;
+    for (const auto &li : intervals) {
+        if (li.start >= 0)
+            order.push_back(li.vreg);
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        if (intervals[a].start != intervals[b].start)
+            return intervals[a].start < intervals[b].start;
+        return a < b;
+    });
+
+    std::vector<bool> regFree(NumX86Regs, false);
+    for (int r : callerSavedRegs())
+        regFree[r] = true;
+    for (int r : calleeSavedRegs())
+        regFree[r] = true;
+
+    // Active intervals, kept sorted by increasing end point
+    std::vector<int> active;
+    for (int v : order) {
+        LiveInterval &cur = intervals[v];
+
+        // Expire intervals that ended at or before this one starts
+        unsigned int keep = 0;
+        for (int a : active) {
+            if (intervals[a].end <= cur.start)
+                regFree[fn->locs[a].reg] = true;
+            else
+                active[keep++] = a;
+        }
+        active.resize(keep);
+
+        std::vector<int> pool;
+        if (!cur.crossesCall)
+            pool = callerSavedRegs();
+        pool.insert(pool.end(), calleeSavedRegs().begin(), calleeSavedRegs().end());
+
+        int reg = -1;
+        for (int r : pool) {
+            if (regFree[r]) {
+                reg = r;
+                break;
+            }
+        }
+
+        if (reg < 0) {
+            // Steal from the active interval that ends last, if it ends after us
+            int victim = -1;
+            for (int i = (int)active.size() - 1; i >= 0; i--) {
+                int r = fn->locs[active[i]].reg;
+                if (std::find(pool.begin(), pool.end(), r) != pool.end()) {
+                    victim = i;
+                    break;
+                }
+            }
+            if (victim < 0 || intervals[active[victim]].end <= cur.end) {
+                spill(v);
+                continue;
+            }
+            reg = fn->locs[active[victim]].reg;
+            spill(active[victim]);
+            active.erase(active.begin() + victim);
+        }
+
+        regFree[reg] = false;
+        fn->locs[v].inReg = true;
+        fn->locs[v].reg = reg;
+        auto it = std::upper_bound(active.begin(), active.end(), v, [this](int a, int b) {
+            return intervals[a].end < intervals[b].end;
+        });
+        active.insert(it, v);
+    }
+}
+
+void LinearScan::run() {
+    fn->locs.assign(fn->getNumVRegs(), MachineLocation());
+    fn->numSpillSlots = 0;
+    computeIntervals();
+    allocate();
+}
+
+} // namespace smallc
@@ -0,0 +1,53 @@
+//
+//  RegAlloc.h
+//  ECE467 Lab 3
+//
+//  Linear-scan register allocation (Poletto & Sarkar) over a
+//  MachineFunction. Each virtual register gets one live interval spanning
+//  every position at which it is live; intervals that cross a call are
+//  restricted to callee-saved registers.
+//
+
+#ifndef RegAlloc_h
+#define RegAlloc_h
+
+#include <vector>
+
+#include "MachineIR.h"
+
+namespace smallc {
+
+class LiveInterval {
+public:
+    int vreg;
+    int start;          // First position the vreg is live
+    int end;            // Last position the vreg is live
+    bool crossesCall;   // Is the vreg live across a call?
+
+    LiveInterval();
+};
+
+class LinearScan {
+private:
+    MachineFunction* fn;
+    std::vector<LiveInterval> intervals;    // Indexed by vreg
+    std::vector<int> callPositions;         // Positions of Call instructions
+
+    void computeIntervals();
+    void allocate();
+    void spill(int vreg);
+
+public:
+    explicit LinearScan(MachineFunction* fn_);
+
+    // Fill in fn->locs and fn->numSpillSlots
+    void run();
+
+    // Registers handed out by the allocator; the rest are scratch
+    static const std::vector<int>& callerSavedRegs();
+    static const std::vector<int>& calleeSavedRegs();
+};
+
+} // namespace smallc
+
+#endif /* RegAlloc_h */
@@ -0,0 +1,272 @@
+//
+//  SCCP.cpp
+//  ECE467 Lab 3
+//
+//  Sparse conditional constant propagation.
+//
+
+#include <climits>
+#include <cstdint>
+
+#include "SCCP.h"
+
+namespace smallc {
+
+SCCP::SCCP() : module(nullptr), numFolded(0), numBranches(0), numBlocks(0) {}
+
+const char* SCCP::getName() const { return "sccp"; }
+
+bool SCCP::runOnModule(Module* m) {
+    module = m;
+    return FunctionPass::runOnModule(m);
+}
+
+void SCCP::printStatistics(std::ostream &out) {
+    out << "sccp: " << numFolded << " values folded to constants, "
+        << numBranches << " branches folded, "
+        << numBlocks << " unreachable blocks removed\n";
+}
+
+// Arithmetic wraps at 32 bits like the generated code
+static int wrap(int64_t v) {
+    return (int)(int32_t)(uint32_t)(uint64_t)v;
+}
+
+bool SCCP::foldBinary(Instruction::Opcode op, Instruction::Predicate pred,
+                      int lhs, int rhs, int &result) {
+    switch (op) {
+        case Instruction::Add: result = wrap((int64_t)lhs + rhs); return true;
+        case Instruction::Sub: result = wrap((int64_t)lhs - rhs); return true;
+        case Instruction::Mul: result = wrap((int64_t)lhs * rhs); return true;
+        case Instruction::Div:
+            // Leave the trap to run time
+            if (rhs == 0 || (lhs == INT_MIN && rhs == -1))
+                return false;
+            result = lhs / rhs;     // C++ truncates toward zero, like idiv
+            return true;
+        case Instruction::Cmp:
+            switch (pred) {
+                case Instruction::EQ: result = lhs == rhs; break;
+                case Instruction::NE: result = lhs != rhs; break;
+                case Instruction::LT: result = lhs < rhs; break;
+                case Instruction::LE: result = lhs <= rhs; break;
+                case Instruction::GT: result = lhs > rhs; break;
+                case Instruction::GE: result = lhs >= rhs; break;
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**********************************************************************************/
+/* Solver                                                                         */
+/**********************************************************************************/
+
+SCCP::LatticeVal SCCP::getValue(Value* v) {
+    if (v->getKind() == Value::ConstantVal)
+        return LatticeVal(LatticeVal::Const, static_cast<Constant*>(v)->getVal());
+    if (v->getKind() != Value::InstructionVal)
+        return LatticeVal(LatticeVal::Overdefined, 0);
+    return lattice[v];
+}
+
+void SCCP::update(Instruction* inst, LatticeVal val) {
+    LatticeVal &old = lattice[inst];
+    if (old.state == val.state && (val.state != LatticeVal::Const || old.val == val.val))
+        return;
+    // Values only move down the lattice
+    if (old.state == LatticeVal::Const && val.state == LatticeVal::Const)
+        val.state = LatticeVal::Overdefined;
+    if (old.state == LatticeVal::Overdefined)
+        return;
+    old = val;
+    for (auto user : inst->getUsers()) {
+        if (executableBlocks.count(user->getParent()))
+            instWork.push_back(user);
+    }
+}
+
+void SCCP::markEdge(BasicBlock* from, BasicBlock* to) {
+    if (!executableEdges.insert(std::make_pair(from, to)).second)
+        return;
+    if (executableBlocks.insert(to).second)
+        blockWork.push_back(to);
+    else {
+        // A new edge into a visited block only changes its phis
+        for (auto phi : to->getPhis())
+            instWork.push_back(phi);
+    }
+}
+
+SCCP::LatticeVal SCCP::fold(Instruction* inst) {
+    LatticeVal over(LatticeVal::Overdefined, 0);
+    switch (inst->getOpcode()) {
+        case Instruction::Neg:
+        case Instruction::Not: {
+            LatticeVal op = getValue(inst->getOperand(0));
+            if (op.state != LatticeVal::Const)
+                return op;
+            int result = inst->getOpcode() == Instruction::Neg ? wrap(-(int64_t)op.val) : !op.val;
+            return LatticeVal(LatticeVal::Const, result);
+        }
+        case Instruction::Add:
+        case Instruction::Sub:
+        case Instruction::Mul:
+        case Instruction::Div:
+        case Instruction::Cmp: {
+            LatticeVal lhs = getValue(inst->getOperand(0));
+            LatticeVal rhs = getValue(inst->getOperand(1));
+            // x * 0 is 0 whatever x is
+            if (inst->getOpcode() == Instruction::Mul &&
+                ((lhs.state == LatticeVal::Const && lhs.val == 0) ||
+                 (rhs.state == LatticeVal::Const && rhs.val == 0)))
+                return LatticeVal(LatticeVal::Const, 0);
+            if (lhs.state == LatticeVal::Overdefined || rhs.state == LatticeVal::Overdefined)
+                return over;
+            if (lhs.state == LatticeVal::Undefined || rhs.state == LatticeVal::Undefined)
+                return LatticeVal();
+            int result;
+            if (!foldBinary(inst->getOpcode(), inst->getPredicate(), lhs.val, rhs.val, result))
+                return over;
+            return LatticeVal(LatticeVal::Const, result);
+        }
+        default:
+            return over;
+    }
+}
+
+void SCCP::visit(Instruction* inst) {
+    BasicBlock* bb = inst->getParent();
+    switch (inst->getOpcode()) {
+        case Instruction::Phi: {
+            LatticeVal result;
+            for (unsigned int i = 0; i < inst->getNumOperands(); i++) {
+                if (!executableEdges.count(std::make_pair(inst->getBlockOperand(i), bb)))
+                    continue;
+                LatticeVal in = getValue(inst->getOperand(i));
+                if (in.state == LatticeVal::Undefined)
+                    continue;
+                if (in.state == LatticeVal::Overdefined ||
+                    (result.state == LatticeVal::Const && result.val != in.val)) {
+                    result = LatticeVal(LatticeVal::Overdefined, 0);
+                    break;
+                }
+                result = in;
+            }
+            update(inst, result);
+            break;
+        }
+        case Instruction::Br:
+            markEdge(bb, inst->getBlockOperand(0));
+            break;
+        case Instruction::CondBr: {
+            LatticeVal cond = getValue(inst->getOperand(0));
+            if (cond.state == LatticeVal::Undefined)
+                break;
+            if (cond.state == LatticeVal::Overdefined || cond.val)
+                markEdge(bb, inst->getBlockOperand(0));
+            if (cond.state == LatticeVal::Overdefined || !cond.val)
+                markEdge(bb, inst->getBlockOperand(1));
+            break;
+        }
+        case Instruction::Ret:
+        case Instruction::Store:
+        case Instruction::StoreElem:
+        case Instruction::Alloca:
+            break;
+        default:
+            if (inst->getType() != Value::Void)
+                update(inst, fold(inst));
+            break;
+    }
+}
+
+void SCCP::solve(Function* fn) {
+    executableBlocks.insert(fn->getEntry());
+    blockWork.push_back(fn->getEntry());
+    while (!blockWork.empty() || !instWork.empty()) {
+        while (!instWork.empty()) {
+            Instruction* inst = instWork.back();
+            instWork.pop_back();
+            visit(inst);
+        }
+        if (!blockWork.empty()) {
+            BasicBlock* bb = blockWork.back();
+            blockWork.pop_back();
+            for (auto inst : bb->getInstructions())
+                visit(inst);
+        }
+    }
+}
+
+/**********************************************************************************/
+/* Rewriting                                                                      */
+/**********************************************************************************/
+
+bool SCCP::rewrite(Function* fn) {
+    bool changed = false;
+    for (auto bb : fn->getBlocks()) {
+        if (!executableBlocks.count(bb))
+            continue;
+
+        std::vector<Instruction*> folded;
+        for (auto inst : bb->getInstructions()) {
+            if (inst->getType() == Value::Void || inst->getOpcode() == Instruction::Call)
+                continue;
+            LatticeVal val = lattice[inst];
+            if (val.state == LatticeVal::Const)
+                folded.push_back(inst);
+        }
+        for (auto inst : folded) {
+            inst->replaceAllUsesWith(module->getConstant(inst->getType(), lattice[inst].val));
+            inst->eraseFromParent();
+            numFolded++;
+            changed = true;
+        }
+
+        // Turn branches with a single executable edge into jumps
+        Instruction* term = bb->getTerminator();
+        if (term->getOpcode() != Instruction::CondBr)
+            continue;
+        BasicBlock* ifTrue = term->getBlockOperand(0);
+        BasicBlock* ifFalse = term->getBlockOperand(1);
+        bool takeTrue = executableEdges.count(std::make_pair(bb, ifTrue)) != 0;
+        bool takeFalse = executableEdges.count(std::make_pair(bb, ifFalse)) != 0;
+        if (takeTrue == takeFalse)
+            continue;
+        BasicBlock* taken = takeTrue ? ifTrue : ifFalse;
+        BasicBlock* dead = takeTrue ? ifFalse : ifTrue;
+        if (dead != taken) {
+            for (auto phi : dead->getPhis())
+                phi->removeIncoming(bb);
+        }
+        Instruction* br = new Instruction(Instruction::Br, Value::Void);
+        br->addBlockOperand(taken);
+        br->setLocation(term->getLocation());
+        bb->insertBefore(term, br);
+        term->eraseFromParent();
+        numBranches++;
+        changed = true;
+    }
+
+    unsigned int removed = fn->removeUnreachableBlocks();
+    fn->recomputePredecessors();
+    numBlocks += removed;
+    return changed || removed > 0;
+}
+
+bool SCCP::runOnFunction(Function* fn) {
+    fn->recomputePredecessors();
+    solve(fn);
+    bool changed = rewrite(fn);
+
+    lattice.clear();
+    executableEdges.clear();
+    executableBlocks.clear();
+    blockWork.clear();
+    instWork.clear();
+    return changed;
+}
+
+} // namespace smallc
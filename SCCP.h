@@ -0,0 +1,70 @@
+//
+//  SCCP.h
+//  ECE467 Lab 3
+//
+//  Sparse conditional constant propagation (Wegman and Zadeck, "Constant
+//  Propagation with Conditional Branches", TOPLAS 1991). Values are
+//  evaluated optimistically over the edges found executable so far, so
+//  constants flow through phis and branches on constant conditions are
+//  folded. Blocks that never become executable are deleted.
+//
+
+#ifndef SCCP_h
+#define SCCP_h
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "PassManager.h"
+
+namespace smallc {
+
+class SCCP : public FunctionPass {
+private:
+    // Lattice: Undefined (no value seen yet) > Constant > Overdefined
+    class LatticeVal {
+    public:
+        enum State { Undefined = 0, Const, Overdefined };
+        State state;
+        int val;
+        LatticeVal() : state(Undefined), val(0) {}
+        LatticeVal(State state_, int val_) : state(state_), val(val_) {}
+    };
+
+    Module* module;
+    std::map<Value*, LatticeVal> lattice;
+    std::set<std::pair<BasicBlock*, BasicBlock*> > executableEdges;
+    std::set<BasicBlock*> executableBlocks;
+    std::vector<BasicBlock*> blockWork;
+    std::vector<Instruction*> instWork;
+
+    unsigned int numFolded;
+    unsigned int numBranches;
+    unsigned int numBlocks;
+
+    LatticeVal getValue(Value* v);
+    void update(Instruction* inst, LatticeVal val);
+    void markEdge(BasicBlock* from, BasicBlock* to);
+    void visit(Instruction* inst);
+    LatticeVal fold(Instruction* inst);
+    void solve(Function* fn);
+    bool rewrite(Function* fn);
+
+public:
+    SCCP();
+    const char* getName() const override;
+    bool runOnModule(Module* m) override;
+    bool runOnFunction(Function* fn) override;
+    void printStatistics(std::ostream &out) override;
+
+    // Fold an operation on constants; returns false if it cannot be folded
+    // (division by zero or overflow, which must trap at run time)
+    static bool foldBinary(Instruction::Opcode op, Instruction::Predicate pred,
+                           int lhs, int rhs, int &result);
+};
+
+} // namespace smallc
+
+#endif /* SCCP_h */
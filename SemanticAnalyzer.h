@@ -18,9 +18,10 @@ using namespace std;
 
 #include "ASTNodes.h"
 #include "ASTVisitorBase.h"
+#include "MemStats.h"
 
 namespace smallc {
-class SemaError {
+class SemaError : private MemStats::Instance<SemaError, MemStats::Sema> {
 public:
     // List of error types
     enum ErrorEnum{
@@ -60,6 +61,10 @@ private:
 public:
     // Constructor
     SemanticAnalyzer ();
+
+    // Destructor; virtual, as TracingSemanticAnalyzer is deleted through
+    // a SemanticAnalyzer pointer
+    virtual ~SemanticAnalyzer () = default;
     
     // Print all the error messages at once
     void printErrorMsgs ();
@@ -0,0 +1,166 @@
+//
+//  StrengthReduce.cpp
+//  ECE467 Lab 3
+//
+//  Induction variable strength reduction.
+//
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <vector>
+
+#include "StrengthReduce.h"
+#include "SCCP.h"
+
+namespace smallc {
+
+StrengthReduce::StrengthReduce() : module(nullptr), numReduced(0) {}
+
+const char* StrengthReduce::getName() const { return "strength-reduce"; }
+
+bool StrengthReduce::runOnModule(Module* m) {
+    module = m;
+    return FunctionPass::runOnModule(m);
+}
+
+void StrengthReduce::printStatistics(std::ostream &out) {
+    out << "strength-reduce: " << numReduced << " induction variable multiplications reduced\n";
+}
+
+// Compute lhs op rhs at the end of bb, folding constants and the
+// identities x * 0 and x * 1 that IVs counting from 0 by 1 produce
+Value* StrengthReduce::emitBinary(Instruction::Opcode op, Value* lhs, Value* rhs, BasicBlock* bb) {
+    bool lhsConst = lhs->getKind() == Value::ConstantVal;
+    bool rhsConst = rhs->getKind() == Value::ConstantVal;
+    if (lhsConst && rhsConst) {
+        int result;
+        if (SCCP::foldBinary(op, Instruction::EQ, static_cast<Constant*>(lhs)->getVal(),
+                             static_cast<Constant*>(rhs)->getVal(), result))
+            return module->getInt(result);
+    }
+    if (op == Instruction::Mul && (lhsConst || rhsConst)) {
+        int c = static_cast<Constant*>(lhsConst ? lhs : rhs)->getVal();
+        if (c == 0)
+            return module->getInt(0);
+        if (c == 1)
+            return lhsConst ? rhs : lhs;
+    }
+    Instruction* inst = new Instruction(op, Value::Int);
+    inst->addOperand(lhs);
+    inst->addOperand(rhs);
+    bb->insertBeforeTerminator(inst);
+    return inst;
+}
+
+bool StrengthReduce::findInductionVar(Loop* loop, BasicBlock* preheader, Instruction* phi,
+                                      InductionVar &iv) {
+    BasicBlock* latch = loop->getLatch();
+    if (phi->getType() != Value::Int || phi->getNumOperands() != 2)
+        return false;
+    Value* next = phi->getIncomingValueFor(latch);
+    iv.init = phi->getIncomingValueFor(preheader);
+    if (!next || !iv.init || !loop->contains(next))
+        return false;
+    iv.phi = phi;
+    iv.next = static_cast<Instruction*>(next);
+
+    // next = phi + step, step + phi or phi - constant; anything else, such
+    // as a call that may have no operands, is not an induction variable
+    if ((iv.next->getOpcode() != Instruction::Add && iv.next->getOpcode() != Instruction::Sub) ||
+        iv.next->getNumOperands() != 2)
+        return false;
+    Value* lhs = iv.next->getOperand(0);
+    Value* rhs = iv.next->getOperand(1);
+    if (iv.next->getOpcode() == Instruction::Add) {
+        if (lhs == phi && loop->isInvariant(rhs))
+            iv.step = rhs;
+        else if (rhs == phi && loop->isInvariant(lhs))
+            iv.step = lhs;
+        else
+            return false;
+        return true;
+    }
+    if (iv.next->getOpcode() == Instruction::Sub && lhs == phi &&
+        rhs->getKind() == Value::ConstantVal) {
+        iv.step = module->getInt(-static_cast<Constant*>(rhs)->getVal());
+        return true;
+    }
+    return false;
+}
+
+bool StrengthReduce::reduceLoop(Loop* loop, BasicBlock* preheader) {
+    BasicBlock* header = loop->getHeader();
+    BasicBlock* latch = loop->getLatch();
+    if (!latch)
+        return false;
+
+    bool changed = false;
+    for (auto phi : header->getPhis()) {
+        InductionVar iv;
+        if (!findInductionVar(loop, preheader, phi, iv))
+            continue;
+
+        // One derived variable per distinct factor
+        std::map<Value*, std::pair<Instruction*, Instruction*> > derived;
+        std::vector<Instruction*> users;
+        for (auto user : phi->getUsers())
+            users.push_back(user);
+        for (auto user : iv.next->getUsers())
+            users.push_back(user);
+        std::set<Instruction*> seen;
+        users.erase(std::remove_if(users.begin(), users.end(), [&](Instruction* user) {
+            return !seen.insert(user).second;
+        }), users.end());
+        for (auto user : users) {
+            if (user->getOpcode() != Instruction::Mul || !user->getParent() || !loop->contains(user))
+                continue;
+            Value* lhs = user->getOperand(0);
+            Value* rhs = user->getOperand(1);
+            Value* base = (lhs == phi || lhs == iv.next) ? lhs : rhs;
+            Value* factor = base == lhs ? rhs : lhs;
+            if ((base != phi && base != iv.next) || !loop->isInvariant(factor))
+                continue;
+
+            auto found = derived.find(factor);
+            if (found == derived.end()) {
+                // j = phi(init * c, j + step * c), updated right after i
+                Value* init = emitBinary(Instruction::Mul, iv.init, factor, preheader);
+                Value* step = emitBinary(Instruction::Mul, iv.step, factor, preheader);
+                Instruction* j = new Instruction(Instruction::Phi, Value::Int);
+                header->insertAfterPhis(j);
+                Instruction* jNext = new Instruction(Instruction::Add, Value::Int);
+                jNext->addOperand(j);
+                jNext->addOperand(step);
+                jNext->setLocation(iv.next->getLocation());
+                BasicBlock* nextBlock = iv.next->getParent();
+                auto pos = std::find(nextBlock->getInstructions().begin(),
+                                     nextBlock->getInstructions().end(), iv.next);
+                nextBlock->insertBefore(*std::next(pos), jNext);
+                j->addIncoming(init, preheader);
+                j->addIncoming(jNext, latch);
+                found = derived.insert(std::make_pair(factor, std::make_pair(j, jNext))).first;
+            }
+            user->replaceAllUsesWith(base == phi ? found->second.first : found->second.second);
+            user->eraseFromParent();
+            numReduced++;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool StrengthReduce::runOnFunction(Function* fn) {
+    DominatorTree dt(fn);
+    LoopInfo li(fn, dt);
+    bool changed = false;
+    for (auto loop : li.getLoopsInnermostFirst()) {
+        BasicBlock* preheader = loop->getPreheader();
+        // A loop the profile never saw run is not worth the extra code
+        if (preheader && loop->getHeader()->getProfileCount() != 0)
+            changed |= reduceLoop(loop, preheader);
+    }
+    return changed;
+}
+
+} // namespace smallc
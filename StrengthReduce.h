@@ -0,0 +1,53 @@
+//
+//  StrengthReduce.h
+//  ECE467 Lab 3
+//
+//  Induction variable strength reduction. A basic induction variable is a
+//  loop header phi i = phi(init, i + step) with a loop-invariant step. A
+//  multiplication i * c by a loop-invariant c is replaced by a new
+//  induction variable j = phi(init * c, j + step * c), so the loop body
+//  adds instead of multiplies. Run after LICM, which leaves the invariant
+//  operands in the preheader. Loops a profile shows never ran are left
+//  alone.
+//
+
+#ifndef StrengthReduce_h
+#define StrengthReduce_h
+
+#include <map>
+#include <utility>
+
+#include "PassManager.h"
+#include "LoopInfo.h"
+
+namespace smallc {
+
+class StrengthReduce : public FunctionPass {
+private:
+    // A basic induction variable: phi = phi(init, next), next = phi + step
+    class InductionVar {
+    public:
+        Instruction* phi;
+        Instruction* next;
+        Value* init;
+        Value* step;
+    };
+
+    Module* module;
+    unsigned int numReduced;
+
+    Value* emitBinary(Instruction::Opcode op, Value* lhs, Value* rhs, BasicBlock* bb);
+    bool findInductionVar(Loop* loop, BasicBlock* preheader, Instruction* phi, InductionVar &iv);
+    bool reduceLoop(Loop* loop, BasicBlock* preheader);
+
+public:
+    StrengthReduce();
+    const char* getName() const override;
+    bool runOnModule(Module* m) override;
+    bool runOnFunction(Function* fn) override;
+    void printStatistics(std::ostream &out) override;
+};
+
+} // namespace smallc
+
+#endif /* StrengthReduce_h */
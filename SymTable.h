@@ -14,6 +14,8 @@
 #define SYMTABLE_H
 
 #include "ASTNodes.h"
+#include "MemStats.h"
+#include <functional>
 #include <map>
 #include <string>
 
@@ -48,7 +50,8 @@ public:
 template<class T>
 class SymTable {
 private;
-    std::map<std::string, T> table;
+    std::map<std::string, T, std::less<std::string>,
+             MemStats::Allocator<std::pair<const std::string, T>, T, MemStats::SymbolTables>> table;
 public:
     bool contains(const std::string &name);
     
@@ -0,0 +1,138 @@
+//
+//  TailRecursion.cpp
+//  ECE467 Lab 3
+//
+//  Self tail calls to loops.
+//
+
+#include <algorithm>
+#include <iterator>
+
+#include "TailRecursion.h"
+
+namespace smallc {
+
+TailRecursion::TailRecursion() : numCalls(0), numFunctions(0) {}
+
+const char* TailRecursion::getName() const { return "tailrec"; }
+
+void TailRecursion::printStatistics(std::ostream &out) {
+    out << "tailrec: " << numCalls << " self tail calls turned into loops in "
+        << numFunctions << " functions\n";
+}
+
+// Is call to fn followed by returning its value, either directly or by
+// branching to a block that only returns?
+bool TailRecursion::isTailCall(Instruction* call, Function* fn) {
+    if (call->getOpcode() != Instruction::Call || call->getCalleeFunction() != fn)
+        return false;
+    BasicBlock* bb = call->getParent();
+    auto pos = std::find(bb->getInstructions().begin(), bb->getInstructions().end(), call);
+    Instruction* next = *std::next(pos);
+    if (next->getOpcode() == Instruction::Br && call->getType() == Value::Void) {
+        BasicBlock* target = next->getBlockOperand(0);
+        next = target->getInstructions().front();
+    }
+    if (next->getOpcode() != Instruction::Ret)
+        return false;
+    if (call->getType() == Value::Void)
+        return next->getNumOperands() == 0;
+    return next->getNumOperands() == 1 && next->getOperand(0) == call && call->getNumUses() == 1;
+}
+
+std::vector<Instruction*> TailRecursion::findTailCalls(Function* fn) {
+    std::vector<Instruction*> calls;
+    for (auto bb : fn->getBlocks()) {
+        for (auto inst : bb->getInstructions()) {
+            if (!isTailCall(inst, fn))
+                continue;
+            // The frame's own arrays must not outlive the iteration
+            bool passesLocal = false;
+            for (unsigned int i = 0; i < inst->getNumOperands(); i++) {
+                Value* arg = inst->getOperand(i);
+                if (arg->getType() == Value::Ptr && arg->getKind() != Value::ArgumentVal &&
+                    arg->getKind() != Value::GlobalVal)
+                    passesLocal = true;
+            }
+            if (!passesLocal)
+                calls.push_back(inst);
+        }
+    }
+    return calls;
+}
+
+bool TailRecursion::runOnFunction(Function* fn) {
+    BasicBlock* entry = fn->getEntry();
+    if (!entry->getPredecessors().empty())
+        return false;
+    std::vector<Instruction*> calls = findTailCalls(fn);
+    if (calls.empty())
+        return false;
+
+    // Everything but the allocas moves to a header the tail calls jump to
+    BasicBlock* header = fn->createBlock("tailrecurse");
+    header->setProfileCount(entry->getProfileCount());
+    fn->moveBlockAfter(header, entry);
+    std::vector<Instruction*> insts(entry->getInstructions().begin(), entry->getInstructions().end());
+    for (auto inst : insts) {
+        if (inst->getOpcode() == Instruction::Alloca)
+            continue;
+        entry->remove(inst);
+        header->append(inst);
+    }
+    Instruction* br = new Instruction(Instruction::Br, Value::Void);
+    br->addBlockOperand(header);
+    entry->append(br);
+    for (auto succ : header->getSuccessors()) {
+        for (auto phi : succ->getPhis())
+            phi->replaceIncomingBlock(entry, header);
+    }
+
+    std::vector<Instruction*> phis;
+    for (auto arg : fn->getArgs()) {
+        Instruction* phi = new Instruction(Instruction::Phi, arg->getType());
+        header->insertAfterPhis(phi);
+        arg->replaceAllUsesWith(phi);
+        phi->addIncoming(arg, entry);
+        phis.push_back(phi);
+    }
+
+    for (auto call : calls) {
+        BasicBlock* bb = call->getParent();
+        for (unsigned int i = 0; i < phis.size(); i++)
+            phis[i]->addIncoming(call->getOperand(i), bb);
+        // Drop the call and whatever followed it
+        while (bb->getInstructions().back() != call)
+            bb->getInstructions().back()->eraseFromParent();
+        call->eraseFromParent();
+        Instruction* jump = new Instruction(Instruction::Br, Value::Void);
+        jump->addBlockOperand(header);
+        bb->append(jump);
+    }
+    fn->recomputePredecessors();
+    fn->removeUnreachableBlocks();
+
+    // An argument passed along unchanged needs no phi
+    for (auto phi : phis) {
+        Value* same = nullptr;
+        bool trivial = true;
+        for (unsigned int i = 0; i < phi->getNumOperands(); i++) {
+            Value* v = phi->getOperand(i);
+            if (v == phi || v == same)
+                continue;
+            if (same)
+                trivial = false;
+            same = v;
+        }
+        if (trivial && same) {
+            phi->replaceAllUsesWith(same);
+            phi->eraseFromParent();
+        }
+    }
+
+    numCalls += calls.size();
+    numFunctions++;
+    return true;
+}
+
+} // namespace smallc
@@ -0,0 +1,43 @@
+//
+//  TailRecursion.h
+//  ECE467 Lab 3
+//
+//  Self tail call elimination. A call of a function to itself whose value
+//  is returned right away, as in "return f(n - 1, acc);", needs nothing
+//  from the current frame afterwards, so it is turned into a jump back to
+//  the top of the function. The entry block is split: allocas stay in
+//  the entry, everything else moves to a loop header where each argument
+//  becomes a phi of the incoming argument and the values passed by the
+//  tail calls. Recursion of this form then runs in constant stack space.
+//
+//  A call passing one of the function's own local arrays is left alone:
+//  as a loop, the next iteration would reuse that array as its own.
+//
+
+#ifndef TailRecursion_h
+#define TailRecursion_h
+
+#include <vector>
+
+#include "PassManager.h"
+
+namespace smallc {
+
+class TailRecursion : public FunctionPass {
+private:
+    unsigned int numCalls;
+    unsigned int numFunctions;
+
+    static bool isTailCall(Instruction* call, Function* fn);
+    static std::vector<Instruction*> findTailCalls(Function* fn);
+
+public:
+    TailRecursion();
+    const char* getName() const override;
+    bool runOnFunction(Function* fn) override;
+    void printStatistics(std::ostream &out) override;
+};
+
+} // namespace smallc
+
+#endif /* TailRecursion_h */
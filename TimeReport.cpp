@@ -0,0 +1,220 @@
+//
+//  TimeReport.cpp
+//  ECE467 Lab 3
+//
+//  Phase timing for --time-report.
+//
+
+#include <algorithm>
+#include <cstdio>
+
+#include <sys/resource.h>
+
+#include "JSON.h"
+#include "TimeReport.h"
+
+namespace smallc {
+
+/**********************************************************************************/
+/* The Timer Class                                                                */
+/**********************************************************************************/
+
+TimeReport::Timer::Timer(TimeReport* report_, const std::string &name) : report(report_) {
+    if (report)
+        report->begin(name);
+}
+
+TimeReport::Timer::~Timer() {
+    if (report)
+        report->end();
+}
+
+/**********************************************************************************/
+/* The TimeReport Class                                                           */
+/**********************************************************************************/
+
+TimeReport::TimeReport() : phases(), open(), trace(nullptr), perf(nullptr) {}
+
+void TimeReport::setTrace(Trace* trace_) { trace = trace_; }
+
+void TimeReport::setPerfCounters(PerfCounters* perf_) { perf = perf_; }
+
+double TimeReport::cpuSeconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+long TimeReport::peakRSS() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;     // KB on Linux
+}
+
+void TimeReport::begin(const std::string &name) {
+    Phase phase;
+    phase.name = name;
+    phase.depth = (unsigned int)open.size();
+    phase.wall = 0;
+    phase.cpu = 0;
+    phase.peakRSS = 0;
+    for (int i = 0; i < PerfCounters::NumEvents; i++)
+        phase.counters[i] = -1;
+    if (perf)
+        perf->read(phase.countersStart);
+    phase.cpuStart = cpuSeconds();
+    phase.wallStart = std::chrono::steady_clock::now();
+    open.push_back((unsigned int)phases.size());
+    phases.push_back(phase);
+}
+
+void TimeReport::end() {
+    auto stop = std::chrono::steady_clock::now();
+    PerfCounters::Reading counters;
+    if (perf)
+        perf->read(counters);
+    Phase &phase = phases[open.back()];
+    open.pop_back();
+    phase.wall = std::chrono::duration<double>(stop - phase.wallStart).count();
+    phase.cpu = cpuSeconds() - phase.cpuStart;
+    phase.peakRSS = peakRSS();
+    if (perf) {
+        for (int i = 0; i < PerfCounters::NumEvents; i++) {
+            if (counters.values[i] >= 0 && phase.countersStart.values[i] >= 0)
+                phase.counters[i] = counters.values[i] - phase.countersStart.values[i];
+        }
+    }
+    if (trace)
+        trace->addSpan(phase.name, "phase", phase.wallStart, stop,
+                       std::vector<std::pair<std::string, long long>>());
+}
+
+double TimeReport::getWall(const std::string &name) {
+    double wall = 0;
+    for (const auto &phase : phases) {
+        if (phase.depth == 0 && phase.name == name)
+            wall += phase.wall;
+    }
+    return wall;
+}
+
+void TimeReport::printText(std::ostream &out) {
+    double wall = 0, cpu = 0;
+    long rss = 0;
+    for (const auto &phase : phases) {
+        if (phase.depth == 0) {
+            wall += phase.wall;
+            cpu += phase.cpu;
+        }
+        rss = std::max(rss, phase.peakRSS);
+    }
+
+    char line[200];
+    out << "===-------------------------------------------------------------------===\n";
+    out << "                       Compilation phase timing report\n";
+    out << "===-------------------------------------------------------------------===\n";
+    std::snprintf(line, sizeof(line), "  %10s  %6s  %10s  %13s  %s\n",
+                  "Wall (ms)", "%", "CPU (ms)", "Peak RSS (KB)", "Phase");
+    out << line;
+    for (const auto &phase : phases) {
+        std::snprintf(line, sizeof(line), "  %10.3f  %5.1f%%  %10.3f  %13ld  %*s%s\n",
+                      phase.wall * 1000.0, wall > 0 ? 100.0 * phase.wall / wall : 0.0,
+                      phase.cpu * 1000.0, phase.peakRSS, 2 * phase.depth, "",
+                      phase.name.c_str());
+        out << line;
+    }
+    std::snprintf(line, sizeof(line), "  %10.3f  %5.1f%%  %10.3f  %13ld  %s\n",
+                  wall * 1000.0, 100.0, cpu * 1000.0, rss, "Total");
+    out << line;
+    if (perf) {
+        out << "\n";
+        printCounters(out);
+    }
+}
+
+static std::string counterText(long long value, double scale, const char* format) {
+    if (value < 0)
+        return "-";
+    char text[32];
+    std::snprintf(text, sizeof(text), format, value / scale);
+    return text;
+}
+
+void TimeReport::printCounters(std::ostream &out) {
+    char line[200];
+    out << "===-------------------------------------------------------------------===\n";
+    out << "                   Hardware counters by phase (user space)\n";
+    out << "===-------------------------------------------------------------------===\n";
+    std::snprintf(line, sizeof(line), "  %11s  %11s  %5s  %12s  %13s  %s\n",
+                  "Cycles (M)", "Insts (M)", "IPC", "Cache misses", "Branch misses", "Phase");
+    out << line;
+    for (const auto &phase : phases) {
+        const long long* c = phase.counters;
+        std::string ipc = "-";
+        if (c[PerfCounters::Cycles] > 0 && c[PerfCounters::Instructions] >= 0)
+            ipc = counterText(c[PerfCounters::Instructions], (double)c[PerfCounters::Cycles], "%.2f");
+        std::snprintf(line, sizeof(line), "  %11s  %11s  %5s  %12s  %13s  %*s%s\n",
+                      counterText(c[PerfCounters::Cycles], 1e6, "%.3f").c_str(),
+                      counterText(c[PerfCounters::Instructions], 1e6, "%.3f").c_str(), ipc.c_str(),
+                      counterText(c[PerfCounters::CacheMisses], 1, "%.0f").c_str(),
+                      counterText(c[PerfCounters::BranchMisses], 1, "%.0f").c_str(),
+                      2 * phase.depth, "", phase.name.c_str());
+        out << line;
+    }
+}
+
+// Phase i and the phases nested in it; i ends past them
+void TimeReport::printJSONPhase(std::ostream &out, unsigned int &i, const std::string &indent) {
+    const Phase &phase = phases[i++];
+    char nums[160];
+    std::snprintf(nums, sizeof(nums), "\"wall_ms\": %.3f, \"cpu_ms\": %.3f, \"peak_rss_kb\": %ld",
+                  phase.wall * 1000.0, phase.cpu * 1000.0, phase.peakRSS);
+    out << indent << "{\"name\": " << jsonString(phase.name) << ", " << nums;
+    if (perf) {
+        static const char* keys[PerfCounters::NumEvents] = {
+            "cycles", "instructions", "cache_misses", "branch_misses"
+        };
+        for (int e = 0; e < PerfCounters::NumEvents; e++) {
+            if (phase.counters[e] >= 0)
+                out << ", \"" << keys[e] << "\": " << phase.counters[e];
+        }
+    }
+    if (i < phases.size() && phases[i].depth > phase.depth) {
+        out << ", \"phases\": [\n";
+        bool first = true;
+        while (i < phases.size() && phases[i].depth > phase.depth) {
+            if (!first)
+                out << ",\n";
+            printJSONPhase(out, i, indent + "  ");
+            first = false;
+        }
+        out << "\n" << indent << "]";
+    }
+    out << "}";
+}
+
+void TimeReport::printJSON(std::ostream &out) {
+    double wall = 0, cpu = 0;
+    long rss = 0;
+    for (const auto &phase : phases) {
+        if (phase.depth == 0) {
+            wall += phase.wall;
+            cpu += phase.cpu;
+        }
+        rss = std::max(rss, phase.peakRSS);
+    }
+    char nums[160];
+    std::snprintf(nums, sizeof(nums), "\"wall_ms\": %.3f, \"cpu_ms\": %.3f, \"peak_rss_kb\": %ld",
+                  wall * 1000.0, cpu * 1000.0, rss);
+    out << "{\n  " << nums << ",\n  \"phases\": [\n";
+    unsigned int i = 0;
+    while (i < phases.size()) {
+        if (i > 0)
+            out << ",\n";
+        printJSONPhase(out, i, "    ");
+    }
+    out << "\n  ]\n}\n";
+}
+
+} // namespace smallc
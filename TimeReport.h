@@ -0,0 +1,91 @@
+//
+//  TimeReport.h
+//  ECE467 Lab 3
+//
+//  Phase timing for --time-report. The driver wraps each phase of a
+//  compile (reading the input, lexing, parsing, semantic analysis, ...)
+//  in a Timer, and phases started while another is running nest inside
+//  it, so the visitor passes of a phase and the IR passes of the
+//  optimizer show up under the phase that ran them. Each phase records
+//  its wall time, the CPU time of the process and the peak resident set
+//  size when it ended.
+//
+//  The report prints as a text table or as JSON for tools tracking
+//  compile times across builds. Given a Trace, every phase is also
+//  recorded in it as a span. Given hardware performance counters, every
+//  phase also records the cycles, instructions, cache misses and branch
+//  misses it took.
+//
+
+#ifndef TimeReport_h
+#define TimeReport_h
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "PerfCounters.h"
+#include "Trace.h"
+
+namespace smallc {
+
+class TimeReport {
+public:
+    // Times the enclosing scope; does nothing without a report
+    class Timer {
+    private:
+        TimeReport* report;
+
+    public:
+        Timer(TimeReport* report_, const std::string &name);
+        ~Timer();
+    };
+
+private:
+    class Phase {
+    public:
+        std::string name;
+        unsigned int depth;         // Nesting level, 0 for top-level phases
+        double wall;                // Seconds
+        double cpu;                 // Seconds, user and system
+        long peakRSS;               // KB, high-water mark when the phase ended
+        long long counters[PerfCounters::NumEvents];   // -1 if not counted
+        std::chrono::steady_clock::time_point wallStart;
+        double cpuStart;
+        PerfCounters::Reading countersStart;
+    };
+
+    std::vector<Phase> phases;      // In start order
+    std::vector<unsigned int> open; // Indices of the running phases, innermost last
+    Trace* trace;                   // Records the phases as spans too, if set
+    PerfCounters* perf;             // Counts events in the phases, if set
+
+    void printJSONPhase(std::ostream &out, unsigned int &i, const std::string &indent);
+
+public:
+    TimeReport();
+
+    void setTrace(Trace* trace_);
+    void setPerfCounters(PerfCounters* perf_);
+
+    void begin(const std::string &name);
+    void end();
+
+    // Total wall time of the top-level phases with the given name
+    double getWall(const std::string &name);
+
+    // Includes the counters table when counting
+    void printText(std::ostream &out);
+    void printCounters(std::ostream &out);
+    void printJSON(std::ostream &out);
+
+    // CPU time used by the process so far, in seconds
+    static double cpuSeconds();
+    // Peak resident set size of the process so far, in KB
+    static long peakRSS();
+};
+
+} // namespace smallc
+
+#endif /* TimeReport_h */
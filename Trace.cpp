@@ -0,0 +1,103 @@
+//
+//  Trace.cpp
+//  ECE467 Lab 3
+//
+//  Chrome trace event output for --trace.
+//
+
+#include <cstdio>
+
+#include "JSON.h"
+#include "Trace.h"
+
+namespace smallc {
+
+/**********************************************************************************/
+/* The Span Class                                                                 */
+/**********************************************************************************/
+
+Trace::Span::Span(Trace* trace_, const std::string &name_, const char* category_)
+    : trace(trace_), name(), category(category_), args(), start() {
+    if (trace) {
+        name = name_;
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+Trace::Span::~Span() {
+    if (trace)
+        trace->addSpan(name, category, start, std::chrono::steady_clock::now(), args);
+}
+
+void Trace::Span::addArg(const std::string &key, long long value) {
+    if (trace)
+        args.push_back(std::make_pair(key, value));
+}
+
+/**********************************************************************************/
+/* The Trace Class                                                                */
+/**********************************************************************************/
+
+// The thread that creates the trace is the main thread, track 1
+Trace::Trace() : epoch(std::chrono::steady_clock::now()), lock(), events(), threads() {
+    threads[std::this_thread::get_id()] = 1;
+}
+
+unsigned int Trace::threadNumber() {
+    auto it = threads.find(std::this_thread::get_id());
+    if (it != threads.end())
+        return it->second;
+    unsigned int number = (unsigned int)threads.size() + 1;
+    threads[std::this_thread::get_id()] = number;
+    return number;
+}
+
+void Trace::addSpan(const std::string &name, const char* category, TimePoint start, TimePoint stop,
+                    const std::vector<std::pair<std::string, long long>> &args) {
+    Event event;
+    event.name = name;
+    event.category = category;
+    event.args = args;
+    event.start = std::chrono::duration<double, std::micro>(start - epoch).count();
+    event.duration = std::chrono::duration<double, std::micro>(stop - start).count();
+
+    std::lock_guard<std::mutex> guard(lock);
+    event.thread = threadNumber();
+    events.push_back(event);
+}
+
+void Trace::print(std::ostream &out) {
+    std::lock_guard<std::mutex> guard(lock);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+    // Name the tracks
+    out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, "
+        << "\"args\": {\"name\": \"A3Sema\"}}";
+    for (const auto &thread : threads) {
+        unsigned int number = thread.second;
+        out << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << number
+            << ", \"args\": {\"name\": \""
+            << (number == 1 ? std::string("main") : "worker " + std::to_string(number - 1))
+            << "\"}}";
+    }
+
+    for (const auto &event : events) {
+        char times[80];
+        std::snprintf(times, sizeof(times), "\"ts\": %.3f, \"dur\": %.3f", event.start, event.duration);
+        out << ",\n{\"name\": " << jsonString(event.name) << ", \"cat\": \"" << event.category
+            << "\", \"ph\": \"X\", " << times << ", \"pid\": 1, \"tid\": " << event.thread;
+        if (!event.args.empty()) {
+            out << ", \"args\": {";
+            for (unsigned int i = 0; i < event.args.size(); i++) {
+                if (i > 0)
+                    out << ", ";
+                out << jsonString(event.args[i].first) << ": " << event.args[i].second;
+            }
+            out << "}";
+        }
+        out << "}";
+    }
+    out << "\n]}\n";
+}
+
+} // namespace smallc
@@ -0,0 +1,79 @@
+//
+//  Trace.h
+//  ECE467 Lab 3
+//
+//  Event trace for --trace, written in the Chrome trace event format so
+//  it opens in chrome://tracing and the Perfetto UI. Work is recorded as
+//  spans, each a name, a category and the interval it ran for, on the
+//  track of the thread that ran it. Every thread that records a span gets
+//  its own track, numbered in the order the threads first show up, so
+//  work split across threads lines up side by side.
+//
+//  Spans may be recorded from any thread.
+//
+
+#ifndef Trace_h
+#define Trace_h
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace smallc {
+
+class Trace {
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    // Records the enclosing scope as a span; does nothing without a trace
+    class Span {
+    private:
+        Trace* trace;
+        std::string name;
+        const char* category;
+        std::vector<std::pair<std::string, long long>> args;
+        TimePoint start;
+
+    public:
+        Span(Trace* trace_, const std::string &name_, const char* category_);
+        ~Span();
+
+        // Shown with the span when it is selected
+        void addArg(const std::string &key, long long value);
+    };
+
+private:
+    class Event {
+    public:
+        std::string name;
+        const char* category;
+        std::vector<std::pair<std::string, long long>> args;
+        double start;               // Microseconds since the trace began
+        double duration;            // Microseconds
+        unsigned int thread;
+    };
+
+    TimePoint epoch;
+    std::mutex lock;                // Guards everything below
+    std::vector<Event> events;
+    std::map<std::thread::id, unsigned int> threads;
+
+    unsigned int threadNumber();    // Caller holds the lock
+
+public:
+    Trace();
+
+    void addSpan(const std::string &name, const char* category, TimePoint start, TimePoint stop,
+                 const std::vector<std::pair<std::string, long long>> &args);
+
+    void print(std::ostream &out);
+};
+
+} // namespace smallc
+
+#endif /* Trace_h */
@@ -0,0 +1,48 @@
+//
+//  TracingSemanticAnalyzer.cpp
+//  ECE467 Lab 3
+//
+//  Semantic analysis with a trace span per top-level declaration.
+//
+
+#include "TracingSemanticAnalyzer.h"
+
+namespace smallc {
+
+TracingSemanticAnalyzer::TracingSemanticAnalyzer(Trace* trace_)
+    : SemanticAnalyzer(), trace(trace_), inFunction(false) {}
+
+void TracingSemanticAnalyzer::visitFunctionDeclNode(FunctionDeclNode *func) {
+    Trace::Span span(trace, func->getIdent()->getName(),
+                     func->getProto() ? "sema.proto" : "sema.function");
+    span.addArg("line", func->getLine());
+    span.addArg("params", func->getNumParameters());
+    inFunction = true;
+    SemanticAnalyzer::visitFunctionDeclNode(func);
+    inFunction = false;
+}
+
+// Locals are checked as part of their function's span. DeclNode::isGlobal
+// is left to the analyzer to work out, so locals are told apart here by
+// whether a function is being checked.
+void TracingSemanticAnalyzer::visitScalarDeclNode(ScalarDeclNode *scalar) {
+    if (inFunction) {
+        SemanticAnalyzer::visitScalarDeclNode(scalar);
+        return;
+    }
+    Trace::Span span(trace, scalar->getIdent()->getName(), "sema.global");
+    span.addArg("line", scalar->getLine());
+    SemanticAnalyzer::visitScalarDeclNode(scalar);
+}
+
+void TracingSemanticAnalyzer::visitArrayDeclNode(ArrayDeclNode *array) {
+    if (inFunction) {
+        SemanticAnalyzer::visitArrayDeclNode(array);
+        return;
+    }
+    Trace::Span span(trace, array->getIdent()->getName(), "sema.global");
+    span.addArg("line", array->getLine());
+    SemanticAnalyzer::visitArrayDeclNode(array);
+}
+
+} // namespace smallc
@@ -0,0 +1,36 @@
+//
+//  TracingSemanticAnalyzer.h
+//  ECE467 Lab 3
+//
+//  SemanticAnalyzer that records a trace span for every top-level
+//  declaration it checks, so a trace of a large input shows which
+//  functions and globals the analysis spent its time on. Each visit is
+//  passed on to SemanticAnalyzer unchanged; since the analyzer reaches
+//  declarations through virtual visit calls, every declaration it checks
+//  goes through here.
+//
+
+#ifndef TracingSemanticAnalyzer_h
+#define TracingSemanticAnalyzer_h
+
+#include "SemanticAnalyzer.h"
+#include "Trace.h"
+
+namespace smallc {
+
+class TracingSemanticAnalyzer : public SemanticAnalyzer {
+private:
+    Trace* trace;
+    bool inFunction;            // Declarations seen now are locals
+
+public:
+    TracingSemanticAnalyzer(Trace* trace_);
+
+    void visitFunctionDeclNode(FunctionDeclNode *func) override;
+    void visitScalarDeclNode(ScalarDeclNode *scalar) override;
+    void visitArrayDeclNode(ArrayDeclNode *array) override;
+};
+
+} // namespace smallc
+
+#endif /* TracingSemanticAnalyzer_h */
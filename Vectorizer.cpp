@@ -0,0 +1,394 @@
+//
+//  Vectorizer.cpp
+//  ECE467 Lab 3
+//
+//  Loop vectorization with SSE2 and AVX2 code paths.
+//
+
+#include "Vectorizer.h"
+#include "Dominators.h"
+
+namespace smallc {
+
+Vectorizer::Vectorizer() : numLoops(0) {}
+
+const char* Vectorizer::getName() const { return "vectorize"; }
+
+void Vectorizer::printStatistics(std::ostream &out) {
+    out << "vectorize: " << numLoops << " loops vectorized\n";
+}
+
+// Array parameters may be any array; distinct globals and allocas are not
+bool Vectorizer::mayAlias(Value* a, Value* b) {
+    if (a == b)
+        return true;
+    return !(isIdentifiedObject(a) && isIdentifiedObject(b));
+}
+
+/**********************************************************************************/
+/* Analysis                                                                       */
+/**********************************************************************************/
+
+// The header is "iv = phi(init, iv + 1); if (iv < bound) body else exit"
+// and the body branches straight back
+bool Vectorizer::analyzeBounds(LoopPlan &plan) {
+    Loop* loop = plan.loop;
+    BasicBlock* header = loop->getHeader();
+    plan.preheader = loop->getPreheader();
+    plan.body = loop->getLatch();
+    if (!plan.preheader || !plan.body || plan.body == header || loop->getBlocks().size() != 2)
+        return false;
+    Instruction* term = header->getTerminator();
+    if (term->getOpcode() != Instruction::CondBr || term->getBlockOperand(0) != plan.body ||
+        plan.body->getTerminator()->getOpcode() != Instruction::Br)
+        return false;
+    plan.exit = term->getBlockOperand(1);
+
+    std::vector<Instruction*> phis = header->getPhis();
+    if (phis.size() != 1 || header->getInstructions().size() != 3)
+        return false;
+    plan.iv = phis[0];
+    Value* cond = term->getOperand(0);
+    if (cond->getKind() != Value::InstructionVal)
+        return false;
+    Instruction* cmp = static_cast<Instruction*>(cond);
+    if (cmp->getOpcode() != Instruction::Cmp || cmp->getNumUses() != 1)
+        return false;
+    Instruction::Predicate pred = cmp->getPredicate();
+    if (cmp->getOperand(0) == plan.iv)
+        plan.bound = cmp->getOperand(1);
+    else if (cmp->getOperand(1) == plan.iv) {
+        plan.bound = cmp->getOperand(0);
+        pred = Instruction::swapPredicate(pred);
+    }
+    else
+        return false;
+    if ((pred != Instruction::LT && pred != Instruction::LE) || !loop->isInvariant(plan.bound))
+        return false;
+    plan.inclusive = pred == Instruction::LE;
+
+    plan.init = plan.iv->getIncomingValueFor(plan.preheader);
+    Value* next = plan.iv->getIncomingValueFor(plan.body);
+    if (next->getKind() != Value::InstructionVal)
+        return false;
+    plan.next = static_cast<Instruction*>(next);
+    if (plan.next->getOpcode() != Instruction::Add || plan.next->getParent() != plan.body)
+        return false;
+    if (plan.next->getOperand(0) != plan.iv && plan.next->getOperand(1) != plan.iv)
+        return false;
+    Value* step = plan.next->getOperand(0) == plan.iv ? plan.next->getOperand(1)
+                                                     : plan.next->getOperand(0);
+    return step->getKind() == Value::ConstantVal && static_cast<Constant*>(step)->getVal() == 1;
+}
+
+// Is every instruction of the body something a lane can do on its own?
+bool Vectorizer::analyzeBody(LoopPlan &plan) {
+    Loop* loop = plan.loop;
+    std::set<Value*> splats;
+    bool usesIndex = false;
+    std::vector<Instruction*> stores;
+    std::vector<Instruction*> loads;
+
+    auto laneOperand = [&](Value* v) {
+        if (v == plan.iv) {
+            usesIndex = true;
+            return true;
+        }
+        if (v->getKind() == Value::InstructionVal && plan.lanes.count(static_cast<Instruction*>(v)))
+            return true;
+        if (v->getType() == Value::Int && loop->isInvariant(v)) {
+            splats.insert(v);
+            return true;
+        }
+        return false;
+    };
+    // iv + c, used only to index loads
+    auto offsetOf = [&](Instruction* inst, int &offset) {
+        Instruction::Opcode op = inst->getOpcode();
+        if (op != Instruction::Add && op != Instruction::Sub)
+            return false;
+        Value* other;
+        if (inst->getOperand(0) == plan.iv)
+            other = inst->getOperand(1);
+        else if (op == Instruction::Add && inst->getOperand(1) == plan.iv)
+            other = inst->getOperand(0);
+        else
+            return false;
+        if (other->getKind() != Value::ConstantVal)
+            return false;
+        for (auto user : inst->getUsers()) {
+            if (user == plan.iv)
+                continue;
+            if (user->getOpcode() != Instruction::LoadElem || user->getOperand(1) != inst)
+                return false;
+        }
+        offset = static_cast<Constant*>(other)->getVal();
+        if (op == Instruction::Sub)
+            offset = -offset;
+        return true;
+    };
+
+    for (auto inst : plan.body->getInstructions()) {
+        if (inst->isTerminator())
+            continue;
+        int offset;
+        if ((inst == plan.next || inst->getType() == Value::Int) && offsetOf(inst, offset)) {
+            plan.offsets[inst] = offset;
+            continue;
+        }
+        if (inst == plan.next)
+            return false;
+        switch (inst->getOpcode()) {
+            case Instruction::Add:
+            case Instruction::Sub:
+            case Instruction::Mul:
+                if (inst->getType() != Value::Int || !laneOperand(inst->getOperand(0)) ||
+                    !laneOperand(inst->getOperand(1)))
+                    return false;
+                plan.lanes.insert(inst);
+                break;
+            case Instruction::Neg:
+                if (inst->getType() != Value::Int || !laneOperand(inst->getOperand(0)))
+                    return false;
+                plan.lanes.insert(inst);
+                break;
+            case Instruction::LoadElem: {
+                Value* index = inst->getOperand(1);
+                bool offsetIndex = index->getKind() == Value::InstructionVal &&
+                    plan.offsets.count(static_cast<Instruction*>(index));
+                if (inst->getType() != Value::Int || !loop->isInvariant(inst->getOperand(0)) ||
+                    (index != plan.iv && !offsetIndex))
+                    return false;
+                plan.lanes.insert(inst);
+                if (offsetIndex && plan.offsets[static_cast<Instruction*>(index)] != 0)
+                    loads.push_back(inst);
+                break;
+            }
+            case Instruction::StoreElem:
+                if (!loop->isInvariant(inst->getOperand(0)) || inst->getOperand(1) != plan.iv ||
+                    inst->getOperand(2)->getType() != Value::Int || !laneOperand(inst->getOperand(2)))
+                    return false;
+                stores.push_back(inst);
+                break;
+            default:
+                return false;
+        }
+    }
+    if (stores.empty())
+        return false;
+
+    // Element i + c of an array the loop writes may be written by another
+    // iteration of the same vector
+    for (auto load : loads) {
+        for (auto store : stores) {
+            if (mayAlias(load->getOperand(0), store->getOperand(0)))
+                return false;
+        }
+    }
+    return plan.lanes.size() + splats.size() + (usesIndex ? 1 : 0) <= MaxVectorValues;
+}
+
+/**********************************************************************************/
+/* Transformation                                                                 */
+/**********************************************************************************/
+
+std::pair<BasicBlock*, BasicBlock*> Vectorizer::emitVectorLoop(LoopPlan &plan, unsigned int width,
+                                                               Value* trip, BasicBlock* done,
+                                                               Instruction* start, BasicBlock* after) {
+    Function* fn = plan.body->getParent();
+    Module* m = fn->getParent();
+    std::string prefix = "vec" + std::to_string(width);
+    BasicBlock* check = fn->createBlock(prefix + ".check");
+    BasicBlock* body = fn->createBlock(prefix + ".body");
+
+    // The vector loop covers the first trip / width * width iterations
+    auto emit = [](BasicBlock* bb, Instruction::Opcode op, Value::Type type, Value* a, Value* b) {
+        Instruction* inst = new Instruction(op, type);
+        inst->addOperand(a);
+        if (b)
+            inst->addOperand(b);
+        bb->append(inst);
+        return inst;
+    };
+    Instruction* count = emit(check, Instruction::Div, Value::Int, trip, m->getInt(width));
+    Instruction* covered = emit(check, Instruction::Mul, Value::Int, count, m->getInt(width));
+    Instruction* end = emit(check, Instruction::Add, Value::Int, plan.init, covered);
+    Instruction* enough = emit(check, Instruction::Cmp, Value::Bool, trip, m->getInt(width));
+    enough->setPredicate(Instruction::GE);
+    Instruction* test = emit(check, Instruction::CondBr, Value::Void, enough, nullptr);
+    test->addBlockOperand(body);
+    test->addBlockOperand(done);
+    start->addIncoming(plan.init, check);
+
+    Instruction* vi = new Instruction(Instruction::Phi, Value::Int);
+    body->append(vi);
+    vi->addIncoming(plan.init, check);
+
+    std::map<Value*, Value*> vectors;
+    std::map<Value*, Value*> indices;
+    auto vectorOf = [&](Value* v) -> Value* {
+        auto it = vectors.find(v);
+        if (it != vectors.end())
+            return it->second;
+        Instruction* vec = v == plan.iv
+            ? emit(body, Instruction::VecIndex, Value::Vec, vi, nullptr)
+            : emit(body, Instruction::Splat, Value::Vec, v, nullptr);
+        vec->setLanes(width);
+        vectors[v] = vec;
+        return vec;
+    };
+    auto indexOf = [&](Value* index) -> Value* {
+        if (index == plan.iv)
+            return vi;
+        auto it = indices.find(index);
+        if (it != indices.end())
+            return it->second;
+        Instruction* offset = emit(body, Instruction::Add, Value::Int, vi,
+                                   m->getInt(plan.offsets[static_cast<Instruction*>(index)]));
+        indices[index] = offset;
+        return offset;
+    };
+
+    for (auto inst : plan.body->getInstructions()) {
+        if (inst->isTerminator() || plan.offsets.count(inst))
+            continue;
+        Instruction* vec;
+        switch (inst->getOpcode()) {
+            case Instruction::LoadElem: {
+                Value* index = indexOf(inst->getOperand(1));
+                vec = emit(body, Instruction::VecLoad, Value::Vec, inst->getOperand(0), index);
+                vectors[inst] = vec;
+                break;
+            }
+            case Instruction::StoreElem: {
+                Value* val = vectorOf(inst->getOperand(2));
+                vec = emit(body, Instruction::VecStore, Value::Void, inst->getOperand(0), vi);
+                vec->addOperand(val);
+                break;
+            }
+            case Instruction::Neg:
+                vec = emit(body, Instruction::Neg, Value::Vec, vectorOf(inst->getOperand(0)), nullptr);
+                vectors[inst] = vec;
+                break;
+            default: {
+                Value* lhs = vectorOf(inst->getOperand(0));
+                Value* rhs = vectorOf(inst->getOperand(1));
+                vec = emit(body, inst->getOpcode(), Value::Vec, lhs, rhs);
+                vectors[inst] = vec;
+                break;
+            }
+        }
+        vec->setLanes(width);
+        vec->setLocation(inst->getLocation());
+    }
+
+    Instruction* vnext = emit(body, Instruction::Add, Value::Int, vi, m->getInt(width));
+    Instruction* more = emit(body, Instruction::Cmp, Value::Bool, vnext, end);
+    more->setPredicate(Instruction::LT);
+    Instruction* latch = emit(body, Instruction::CondBr, Value::Void, more, nullptr);
+    latch->addBlockOperand(body);
+    vi->addIncoming(vnext, body);
+
+    // Leave the vector unit clean for the scalar code that follows
+    BasicBlock* exit = fn->createBlock(prefix + ".exit");
+    latch->addBlockOperand(exit);
+    Instruction* vecEnd = new Instruction(Instruction::VecEnd, Value::Void);
+    vecEnd->setLanes(width);
+    exit->append(vecEnd);
+    Instruction* br = new Instruction(Instruction::Br, Value::Void);
+    br->addBlockOperand(done);
+    exit->append(br);
+    start->addIncoming(end, exit);
+
+    fn->moveBlockAfter(check, after);
+    fn->moveBlockAfter(body, check);
+    fn->moveBlockAfter(exit, body);
+    return std::make_pair(check, exit);
+}
+
+// preheader: if the loop runs at all, pick the widest vector loop the CPU
+// has; after it, or if the trip count is too small for a single vector,
+// the scalar loop runs on. The trip count is only taken once init is known
+// to be below the bound: bound - init may wrap around otherwise, and a
+// difference too large for an int wraps to a negative count, which no
+// vector loop takes.
+void Vectorizer::vectorize(LoopPlan &plan) {
+    Function* fn = plan.body->getParent();
+    Module* m = fn->getParent();
+    BasicBlock* pre = plan.preheader;
+    BasicBlock* header = plan.loop->getHeader();
+
+    pre->getTerminator()->eraseFromParent();
+    Instruction* runs = new Instruction(Instruction::Cmp, Value::Bool);
+    runs->addOperand(plan.init);
+    runs->addOperand(plan.bound);
+    runs->setPredicate(plan.inclusive ? Instruction::LE : Instruction::LT);
+    pre->append(runs);
+
+    BasicBlock* entry = fn->createBlock("vec.entry");
+    Instruction* trip = new Instruction(Instruction::Sub, Value::Int);
+    trip->addOperand(plan.bound);
+    trip->addOperand(plan.init);
+    entry->append(trip);
+    if (plan.inclusive) {
+        Instruction* plusOne = new Instruction(Instruction::Add, Value::Int);
+        plusOne->addOperand(trip);
+        plusOne->addOperand(m->getInt(1));
+        entry->append(plusOne);
+        trip = plusOne;
+    }
+    Instruction* avx2 = new Instruction(Instruction::HasAVX2, Value::Bool);
+    entry->append(avx2);
+
+    BasicBlock* done = fn->createBlock("vec.done");
+    Instruction* start = new Instruction(Instruction::Phi, Value::Int);
+    done->append(start);
+    Instruction* br = new Instruction(Instruction::Br, Value::Void);
+    br->addBlockOperand(header);
+    done->append(br);
+
+    Instruction* test = new Instruction(Instruction::CondBr, Value::Void);
+    test->addOperand(runs);
+    test->addBlockOperand(entry);
+    test->addBlockOperand(done);
+    pre->append(test);
+    start->addIncoming(plan.init, pre);
+    fn->moveBlockAfter(entry, pre);
+
+    std::pair<BasicBlock*, BasicBlock*> wide = emitVectorLoop(plan, 8, trip, done, start, entry);
+    std::pair<BasicBlock*, BasicBlock*> narrow =
+        emitVectorLoop(plan, 4, trip, done, start, wide.second);
+    Instruction* dispatch = new Instruction(Instruction::CondBr, Value::Void);
+    dispatch->addOperand(avx2);
+    dispatch->addBlockOperand(wide.first);
+    dispatch->addBlockOperand(narrow.first);
+    entry->append(dispatch);
+
+    // The scalar loop now starts where the vector loop stopped
+    plan.iv->removeIncoming(pre);
+    plan.iv->addIncoming(start, done);
+
+    fn->moveBlockAfter(done, narrow.second);
+    fn->recomputePredecessors();
+}
+
+bool Vectorizer::runOnFunction(Function* fn) {
+    DominatorTree dt(fn);
+    LoopInfo li(fn, dt);
+    std::vector<LoopPlan> plans;
+    for (auto loop : li.getLoopsInnermostFirst()) {
+        // Not worth the code for a loop the profile never saw run
+        if (!loop->getSubLoops().empty() || loop->getHeader()->getProfileCount() == 0)
+            continue;
+        LoopPlan plan;
+        plan.loop = loop;
+        if (analyzeBounds(plan) && analyzeBody(plan))
+            plans.push_back(plan);
+    }
+    for (auto &plan : plans)
+        vectorize(plan);
+    numLoops += plans.size();
+    return !plans.empty();
+}
+
+} // namespace smallc
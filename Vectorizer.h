@@ -0,0 +1,80 @@
+//
+//  Vectorizer.h
+//  ECE467 Lab 3
+//
+//  Loop vectorization of element-wise array loops such as
+//
+//      while (i < n) { c[i] = a[i] + b[i] * k; i = i + 1; }
+//
+//  A loop qualifies when it is a single body block counting an induction
+//  variable i up by one to a loop-invariant bound, and the body only
+//  loads and stores int array elements and combines them with add, sub,
+//  mul and negation. Stores must be to element i; loads may be from
+//  i + c for a constant c when no store in the loop can write the array
+//  loaded from. Every iteration then touches its own elements, so
+//  consecutive iterations can run side by side, one per vector lane.
+//  Values used by the body that the loop does not compute are broadcast
+//  to every lane, and i itself becomes the vector i, i + 1, ...
+//
+//  Two vector loops are generated, 8 lanes for AVX2 and 4 for SSE2, and
+//  the program picks one at run time by what the CPU supports. Either
+//  handles as many whole vectors as the trip count allows and leaves the
+//  rest to the original loop, which runs on as the remainder loop.
+//
+
+#ifndef Vectorizer_h
+#define Vectorizer_h
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "PassManager.h"
+#include "LoopInfo.h"
+
+namespace smallc {
+
+class Vectorizer : public FunctionPass {
+private:
+    // What analysis found out about a loop that can be vectorized
+    class LoopPlan {
+    public:
+        Loop* loop;
+        BasicBlock* preheader;
+        BasicBlock* body;
+        BasicBlock* exit;
+        Instruction* iv;                // The induction variable phi
+        Instruction* next;              // iv + 1
+        Value* init;                    // iv on entry
+        Value* bound;                   // Loop runs while iv < bound (or <=)
+        bool inclusive;                 // iv <= bound
+        std::set<Instruction*> lanes;   // Body values computed per lane
+        std::map<Instruction*, int> offsets;    // Load indices iv + c
+    };
+
+    unsigned int numLoops;
+
+    static bool analyzeBounds(LoopPlan &plan);
+    static bool analyzeBody(LoopPlan &plan);
+    static bool mayAlias(Value* a, Value* b);
+    // Lays the loop's blocks out after the given block; returns the first
+    // and the last of them
+    std::pair<BasicBlock*, BasicBlock*> emitVectorLoop(LoopPlan &plan, unsigned int width,
+                                                       Value* trip, BasicBlock* done,
+                                                       Instruction* start, BasicBlock* after);
+    void vectorize(LoopPlan &plan);
+
+public:
+    // Vector registers the backend can give a vector loop body
+    static const unsigned int MaxVectorValues = 14;
+
+    Vectorizer();
+    const char* getName() const override;
+    bool runOnFunction(Function* fn) override;
+    void printStatistics(std::ostream &out) override;
+};
+
+} // namespace smallc
+
+#endif /* Vectorizer_h */
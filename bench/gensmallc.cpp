@@ -0,0 +1,442 @@
+//
+//  gensmallc.cpp
+//  ECE467 Lab 3
+//
+//  Generates synthetic smallC programs for benchmarking the front end.
+//  Programs follow smallC.g4 and, unless errors are asked for, pass
+//  semantic analysis: every name is declared before it is used, every
+//  operand, argument, condition and return value has the right type, and
+//  functions only call functions defined above them.
+//
+//  With an error density above zero, that fraction of the statements is
+//  replaced by one with a semantic error (an undefined name, a type
+//  mismatch, a call with the wrong number of arguments, a condition that
+//  is not bool, a return of the wrong type) and that fraction of the
+//  local declarations redefines a name. Syntax errors are never made, so
+//  every phase of the front end still runs over the whole program.
+//
+//  The same options and seed always give the same program, on any
+//  platform, so benchmark inputs stay fixed across commits.
+//
+//  Usage: gensmallc [options] > program.sc
+//    --seed <n>           random seed (default 1)
+//    --globals <n>        global scalars and arrays (default 10)
+//    --functions <n>      functions besides main (default 20)
+//    --stmts <n>          statements per scope (default 8)
+//    --depth <n>          how deep if and while statements nest (default 3)
+//    --expr-len <n>       operands in the longest expression (default 6)
+//    --args <n>           most parameters a function takes (default 4)
+//    --error-density <f>  fraction of statements with an error (default 0)
+//
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+class ProgramGenerator {
+public:
+    class Options {
+    public:
+        unsigned int seed;
+        unsigned int globals;
+        unsigned int functions;
+        unsigned int stmts;
+        unsigned int depth;
+        unsigned int exprLen;
+        unsigned int args;
+        double errorDensity;
+    };
+
+private:
+    enum Type { Void, Int, Bool };
+
+    class Var {
+    public:
+        std::string name;
+        Type type;
+        bool isArray;
+    };
+
+    class Func {
+    public:
+        std::string name;
+        Type retType;
+        std::vector<Var> params;
+    };
+
+    Options opts;
+    std::mt19937 rng;
+    std::ostream &out;
+    std::vector<std::vector<Var>> scopes;   // Visible variables, globals first
+    std::vector<Func> funcs;                // Callable functions
+    Type retType;                           // Of the function being generated
+    unsigned int numNames;
+    unsigned int numErrors;
+
+    // std::uniform_int_distribution differs between standard libraries;
+    // the raw mt19937 sequence does not
+    unsigned int below(unsigned int n) { return n == 0 ? 0 : rng() % n; }
+    bool chance(double p) { return (rng() % 1000000) < p * 1000000; }
+    std::string newName(const char* prefix) { return prefix + std::to_string(numNames++); }
+
+    static const char* typeName(Type type) {
+        return type == Int ? "int" : type == Bool ? "bool" : "void";
+    }
+
+    bool pickVar(Type type, bool isArray, Var &var) {
+        std::vector<const Var*> candidates;
+        for (const auto &scope : scopes) {
+            for (const auto &v : scope) {
+                if (v.type == type && v.isArray == isArray)
+                    candidates.push_back(&v);
+            }
+        }
+        if (candidates.empty())
+            return false;
+        var = *candidates[below((unsigned int)candidates.size())];
+        return true;
+    }
+
+    void indent(unsigned int level) {
+        for (unsigned int i = 0; i < level; i++)
+            out << "    ";
+    }
+
+    /******************************************************************************/
+    /* Expressions                                                                */
+    /******************************************************************************/
+
+    // A var, constant or array element of the given type (intExpr operand)
+    std::string operand(Type type, unsigned int nesting) {
+        Var var;
+        unsigned int pick = below(4);
+        if (pick == 0 && nesting < 2 && pickVar(type, true, var))
+            return var.name + "[" + intExpr(2, nesting + 1) + "]";
+        if (pick <= 2 && pickVar(type, false, var))
+            return var.name;
+        if (type == Bool)
+            return below(2) ? "true" : "false";
+        // Constant indices stay in bounds of the smallest array
+        return std::to_string(nesting > 0 ? below(4) : below(1000));
+    }
+
+    // An intExpr of up to len operands
+    std::string intExpr(unsigned int len, unsigned int nesting) {
+        static const char* ops[] = { " + ", " - ", " * ", " / " };
+        unsigned int n = 1 + below(len);
+        std::string expr = operand(Int, nesting);
+        for (unsigned int i = 1; i < n; i++) {
+            expr += ops[below(4)];
+            if (n - i > 1 && below(4) == 0) {
+                expr += "(" + operand(Int, nesting) + ops[below(2)] + operand(Int, nesting) + ")";
+                i++;
+            }
+            else
+                expr += operand(Int, nesting);
+        }
+        return expr;
+    }
+
+    // A call to a function returning the given type, if there is one
+    bool call(Type type, unsigned int nesting, std::string &expr) {
+        std::vector<const Func*> candidates;
+        for (const auto &f : funcs) {
+            if (f.retType == type)
+                candidates.push_back(&f);
+        }
+        if (candidates.empty())
+            return false;
+        const Func &f = *candidates[below((unsigned int)candidates.size())];
+        expr = f.name + "(";
+        for (unsigned int i = 0; i < f.params.size(); i++) {
+            const Var &param = f.params[i];
+            std::string arg;
+            Var var;
+            if (param.isArray) {
+                if (!pickVar(param.type, true, var))
+                    return false;
+                arg = var.name;
+            }
+            else
+                arg = expression(param.type, nesting + 1);
+            expr += (i > 0 ? ", " : "") + arg;
+        }
+        expr += ")";
+        return true;
+    }
+
+    // An expr of the given type
+    std::string expression(Type type, unsigned int nesting) {
+        std::string expr;
+        unsigned int len = nesting > 0 ? 2 : opts.exprLen;
+        unsigned int pick = below(8);
+        if (pick == 0 && nesting < 2 && call(type, nesting, expr))
+            return expr;
+        if (type == Int) {
+            if (pick == 1)
+                return "-(" + intExpr(len, nesting) + ")";
+            return intExpr(len, nesting);
+        }
+        static const char* cmps[] = { " < ", " <= ", " > ", " >= ", " == ", " != " };
+        if (pick == 2 && nesting < 2)
+            return "!(" + expression(Bool, nesting + 1) + ")";
+        if (pick == 3 && nesting < 2)
+            return "(" + expression(Bool, nesting + 1) + (below(2) ? ") && (" : ") || (") +
+                   expression(Bool, nesting + 1) + ")";
+        if (pick == 4)
+            return operand(Bool, nesting);
+        return intExpr((len + 1) / 2, nesting) + cmps[below(6)] + intExpr((len + 1) / 2, nesting);
+    }
+
+    /******************************************************************************/
+    /* Statements                                                                 */
+    /******************************************************************************/
+
+    void errorStmt(unsigned int level) {
+        numErrors++;
+        indent(level);
+        std::string expr;
+        switch (below(5)) {
+            case 0:
+                out << newName("undef") << " = " << intExpr(opts.exprLen, 0) << ";\n";
+                return;
+            case 1: {
+                Var var;
+                if (pickVar(Int, false, var)) {
+                    out << var.name << " = " << expression(Bool, 0) << ";\n";
+                    return;
+                }
+                out << newName("undef") << " = 1;\n";
+                return;
+            }
+            case 2:
+                if (call(Int, 0, expr) || call(Bool, 0, expr) || call(Void, 0, expr)) {
+                    expr.insert(expr.size() - 1, expr[expr.size() - 2] == '(' ? "1" : ", 1");
+                    out << expr << ";\n";
+                    return;
+                }
+                out << newName("undef") << "();\n";
+                return;
+            case 3:
+                out << "while (" << intExpr(opts.exprLen, 0) << ") {\n";
+                indent(level);
+                out << "}\n";
+                return;
+            default:
+                if (retType == Bool)
+                    out << "return " << intExpr(opts.exprLen, 0) << ";\n";
+                else
+                    out << "return " << expression(Bool, 0) << ";\n";
+                return;
+        }
+    }
+
+    void stmt(unsigned int level, unsigned int depth) {
+        if (chance(opts.errorDensity)) {
+            errorStmt(level);
+            return;
+        }
+        std::string expr;
+        Var var;
+        unsigned int pick = below(10);
+        if (pick < 2 && depth < opts.depth) {
+            indent(level);
+            out << "if (" << expression(Bool, 0) << ")\n";
+            scope(level, depth + 1);
+            if (below(2)) {
+                indent(level);
+                out << "else\n";
+                scope(level, depth + 1);
+            }
+            return;
+        }
+        if (pick == 2 && depth < opts.depth) {
+            indent(level);
+            out << "while (" << expression(Bool, 0) << ")\n";
+            scope(level, depth + 1);
+            return;
+        }
+        if (pick == 3 && call(Void, 0, expr)) {
+            indent(level);
+            out << expr << ";\n";
+            return;
+        }
+        Type type = below(4) == 0 ? Bool : Int;
+        bool isArray = below(3) == 0;
+        if (!pickVar(type, isArray, var)) {
+            type = Int;
+            isArray = false;
+            if (!pickVar(type, isArray, var)) {
+                indent(level);
+                out << "writeInt(" << intExpr(opts.exprLen, 0) << ");\n";
+                return;
+            }
+        }
+        indent(level);
+        out << var.name;
+        if (isArray)
+            out << "[" << intExpr(2, 1) << "]";
+        out << " = " << expression(type, 0) << ";\n";
+    }
+
+    void decl(unsigned int level, bool global) {
+        Var var;
+        var.type = below(3) == 0 ? Bool : Int;
+        var.isArray = below(4) == 0;
+        if (!global && !scopes.back().empty() && chance(opts.errorDensity)) {
+            numErrors++;
+            var = scopes.back()[below((unsigned int)scopes.back().size())];
+        }
+        else
+            var.name = newName(global ? "g" : "v");
+        indent(level);
+        out << typeName(var.type) << " " << var.name;
+        if (var.isArray)
+            out << "[" << 16 + below(49) << "]";
+        out << ";\n";
+        scopes.back().push_back(var);
+    }
+
+    // A braced scope: declarations, then statements
+    void scope(unsigned int level, unsigned int depth) {
+        indent(level);
+        out << "{\n";
+        scopes.push_back(std::vector<Var>());
+        unsigned int numDecls = below(4);
+        for (unsigned int i = 0; i < numDecls; i++)
+            decl(level + 1, false);
+        unsigned int numStmts = 1 + below(opts.stmts);
+        for (unsigned int i = 0; i < numStmts; i++)
+            stmt(level + 1, depth);
+        scopes.pop_back();
+        indent(level);
+        out << "}\n";
+    }
+
+    void function(const std::string &name, unsigned int maxParams) {
+        Func f;
+        f.name = name;
+        f.retType = (Type)below(3);
+        unsigned int numParams = below(maxParams + 1);
+        for (unsigned int i = 0; i < numParams; i++) {
+            Var param;
+            param.name = newName("p");
+            param.type = below(3) == 0 ? Bool : Int;
+            param.isArray = below(4) == 0;
+            f.params.push_back(param);
+        }
+
+        out << "\n" << typeName(f.retType) << " " << f.name << "(";
+        for (unsigned int i = 0; i < f.params.size(); i++) {
+            out << (i > 0 ? ", " : "") << typeName(f.params[i].type) << " " << f.params[i].name;
+            if (f.params[i].isArray)
+                out << "[]";
+        }
+        out << ") {\n";
+
+        retType = f.retType;
+        scopes.push_back(f.params);
+        scopes.push_back(std::vector<Var>());
+        unsigned int numDecls = below(5);
+        for (unsigned int i = 0; i < numDecls; i++)
+            decl(1, false);
+        unsigned int numStmts = 1 + below(opts.stmts);
+        for (unsigned int i = 0; i < numStmts; i++)
+            stmt(1, 0);
+        if (retType != Void) {
+            indent(1);
+            out << "return " << expression(retType, 0) << ";\n";
+        }
+        scopes.pop_back();
+        scopes.pop_back();
+        out << "}\n";
+        funcs.push_back(f);
+    }
+
+public:
+    ProgramGenerator(const Options &opts_, std::ostream &out_)
+        : opts(opts_), rng(opts_.seed), out(out_), scopes(), funcs(), retType(Void),
+          numNames(0), numErrors(0) {}
+
+    unsigned int getNumErrors() const { return numErrors; }
+
+    void generate() {
+        out << "#include \"scio.h\"\n";
+        out << "// Generated by gensmallc --seed " << opts.seed << " --globals " << opts.globals
+            << " --functions " << opts.functions << " --stmts " << opts.stmts << " --depth "
+            << opts.depth << " --expr-len " << opts.exprLen << " --args " << opts.args
+            << " --error-density " << opts.errorDensity << "\n\n";
+        scopes.push_back(std::vector<Var>());
+        for (unsigned int i = 0; i < opts.globals; i++)
+            decl(0, true);
+        for (unsigned int i = 0; i < opts.functions; i++)
+            function(newName("f"), opts.args);
+
+        // main has to be int main() with no parameters
+        out << "\nint main() {\n";
+        retType = Int;
+        scopes.push_back(std::vector<Var>());
+        unsigned int numStmts = 1 + below(opts.stmts);
+        for (unsigned int i = 0; i < numStmts; i++)
+            stmt(1, 0);
+        scopes.pop_back();
+        out << "    return 0;\n}\n";
+    }
+};
+
+void usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [--seed n] [--globals n] [--functions n] [--stmts n]\n"
+              << "       [--depth n] [--expr-len n] [--args n] [--error-density f]\n";
+}
+
+} // namespace
+
+int main(int argc, const char* argv[]) {
+    ProgramGenerator::Options opts;
+    opts.seed = 1;
+    opts.globals = 10;
+    opts.functions = 20;
+    opts.stmts = 8;
+    opts.depth = 3;
+    opts.exprLen = 6;
+    opts.args = 4;
+    opts.errorDensity = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "--seed")
+            opts.seed = atoi(value);
+        else if (arg == "--globals")
+            opts.globals = atoi(value);
+        else if (arg == "--functions")
+            opts.functions = atoi(value);
+        else if (arg == "--stmts")
+            opts.stmts = atoi(value);
+        else if (arg == "--depth")
+            opts.depth = atoi(value);
+        else if (arg == "--expr-len")
+            opts.exprLen = atoi(value) > 0 ? atoi(value) : 1;
+        else if (arg == "--args")
+            opts.args = atoi(value);
+        else if (arg == "--error-density")
+            opts.errorDensity = atof(value);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    ProgramGenerator gen(opts, std::cout);
+    gen.generate();
+    if (opts.errorDensity > 0)
+        std::cerr << "gensmallc: " << gen.getNumErrors() << " errors\n";
+    return 0;
+}
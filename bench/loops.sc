@@ -0,0 +1,57 @@
+#include "scio.h"
+// Loop benchmark for the -O loop optimizations (LICM and induction
+// variable strength reduction). Prints a checksum so the optimized and
+// unoptimized builds can be compared.
+
+int a[4096];
+int b[4096];
+
+void init(int n) {
+    int i;
+    i = 0;
+    while (i < n) {
+        a[i] = i - (i / 7) * 7;
+        b[i] = 0;
+        i = i + 1;
+    }
+}
+
+// Strided access: the index i * k + c is recomputed every iteration
+int strided(int n, int k, int c) {
+    int i; int s;
+    i = 0; s = 0;
+    while (i < n) {
+        s = s + a[i * k + c] * (k * c + 3);
+        b[i * k + c] = s;
+        i = i + 1;
+    }
+    return s;
+}
+
+// Row-major 2D walk with an invariant row base in the inner loop
+int rows(int n, int m) {
+    int i; int j; int s;
+    i = 0; s = 0;
+    while (i < n) {
+        j = 0;
+        while (j < m) {
+            s = s + a[i * m + j] - b[i * m + j] / 3;
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+    return s;
+}
+
+void main() {
+    int r; int sum;
+    init(4096);
+    r = 0; sum = 0;
+    while (r < 20000) {
+        sum = sum + strided(1000, 4, r - (r / 4) * 4);
+        sum = sum + rows(32, 128);
+        r = r + 1;
+    }
+    writeInt(sum);
+    newLine();
+}
@@ -0,0 +1,102 @@
+/*
+ *  scio.c
+ *  ECE467 Lab 3
+ *
+ *  Runtime for native smallC programs: the I/O library declared by the
+ *  '#include "scio.h"' preamble. Link it with the assembly produced by
+ *  A3Sema -S:
+ *
+ *      gcc prog.s scio.c -o prog
+ *
+ *  smallC functions are emitted with an "sc_" prefix, so the library
+ *  functions are defined under those names. Support routines called by
+ *  generated code use an "scrt_" prefix, which no smallC name can produce.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int sc_readInt(void) {
+    int val = 0;
+    if (scanf("%d", &val) != 1)
+        return 0;
+    return val;
+}
+
+int sc_readBool(void) {
+    char buf[16];
+    if (scanf("%15s", buf) != 1)
+        return 0;
+    return strcmp(buf, "true") == 0 || strcmp(buf, "1") == 0;
+}
+
+void sc_writeInt(int val) {
+    printf("%d", val);
+}
+
+void sc_writeBool(int val) {
+    fputs(val ? "true" : "false", stdout);
+}
+
+void sc_newLine(void) {
+    putchar('\n');
+}
+
+/*
+ *  Vectorized loops have an AVX2 and an SSE2 version and pick one by
+ *  this flag. Setting SCRT_VECTOR=sse2 in the environment forces the
+ *  SSE2 version, to compare the two.
+ */
+int scrt_has_avx2;
+
+__attribute__((constructor))
+static void scrt_detect_cpu(void) {
+    const char *force = getenv("SCRT_VECTOR");
+    __builtin_cpu_init();
+    scrt_has_avx2 = __builtin_cpu_supports("avx2") && !(force && strcmp(force, "sse2") == 0);
+}
+
+/* Called by code compiled with --bounds-check when an index is out of range */
+void scrt_bounds_error(int line) {
+    fflush(stdout);
+    fprintf(stderr, "runtime error: array index out of bounds at line %d\n", line);
+    exit(1);
+}
+
+/*
+ *  Profile counters of code compiled with --profile-generate. Each run
+ *  appends one line per counter, its key followed by its count, so runs
+ *  on different inputs add up when the profile is read back.
+ */
+static const long long *scrt_prof_counters;
+static int scrt_prof_count;
+static const char *scrt_prof_keys;
+static const char *scrt_prof_file;
+
+static void scrt_profile_write(void) {
+    FILE *f = fopen(scrt_prof_file, "a");
+    const char *key = scrt_prof_keys;
+    int i;
+    if (!f) {
+        fprintf(stderr, "warning: cannot write profile %s\n", scrt_prof_file);
+        return;
+    }
+    fputs("# smallC profile\n", f);
+    for (i = 0; i < scrt_prof_count; i++) {
+        const char *end = strchr(key, '\n');
+        fprintf(f, "%.*s %lld\n", (int)(end - key), key, scrt_prof_counters[i]);
+        key = end + 1;
+    }
+    fclose(f);
+}
+
+/* Called before main by a constructor the compiler emits */
+void scrt_profile_register(const long long *counters, int count, const char *keys,
+                           const char *file) {
+    scrt_prof_counters = counters;
+    scrt_prof_count = count;
+    scrt_prof_keys = keys;
+    scrt_prof_file = file;
+    atexit(scrt_profile_write);
+}
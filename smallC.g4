@@ -19,7 +19,7 @@ program
 	returns[smallc::ProgramNode *prg]
 	@init {
     $prg = new smallc::ProgramNode();
-    $prg->setLocation($ctx->start->getLine(), $ctx->start->getCharPositionInLine());
+    $prg->setOffset($ctx->start->getStartIndex());
 }: (preamble {$prg->setIo(true);} |) (
 		decls {
    for(unsigned int i = 0; i < $decls.declarations.size();i++)
@@ -46,14 +46,14 @@ scalarDeclList
     $scalars = std::vector<smallc::ScalarDeclNode*>();
     }:
 	scalarDecl {
-        $scalarDecl.decl->setLocation($ctx->start->getLine(), $ctx->start->getCharPositionInLine());
+        $scalarDecl.decl->setOffset($ctx->start->getStartIndex());
         $scalars.push_back($scalarDecl.decl);
     }
 	| scalarDecl scalarDeclList {
-        $scalarDecl.decl->setLocation($ctx->start->getLine(), $ctx->start->getCharPositionInLine());
+        $scalarDecl.decl->setOffset($ctx->start->getStartIndex());
         $scalars.push_back($scalarDecl.decl);
         for(unsigned int i = 0; i < $scalarDeclList.scalars.size(); i++)
-            $scalarDeclList.scalars[i]->setLocation($ctx->start->getLine(), $ctx->start->getCharPositionInLine());
+            $scalarDeclList.scalars[i]->setOffset($ctx->start->getStartIndex());
             $scalars.push_back($scalarDeclList.scalars[i]);
     };
 
@@ -70,15 +70,15 @@ arrDeclList
     $arrs = std::vector<smallc::arrDeclNode*>();
     }:
 	arrDecl {
-        $arrDecl.decl->setLocation($ctx->start->getLine(), $ctx->start->getCharPositionInLine());
+        $arrDecl.decl->setOffset($ctx->start->getStartIndex());
         $arrs.push_back($arrDecl.decl);
     }
 	| arrDecl {
-        $arrDecl.decl->setLocation($ctx->start->getLine(), $ctx->start->getCharPositionInLine());
+        $arrDecl.decl->setOffset($ctx->start->getStartIndex());
         $arrs.push_back($arrDecl.decl);
     } arrDeclList {
         for(unsigned int i = 0; i < $arrDeclList.arrs.size(); i++)
-            $arrDeclList.arrs[i]->setLocation($ctx->start->getLine(), $ctx->start->getCharPositionInLine());
+            $arrDeclList.arrs[i]->setOffset($ctx->start->getStartIndex());
             $arrs.push_back($arrDeclList.arrs[i]);
     };
 
@@ -86,7 +86,7 @@ arrDecl
 	returns[smallc::DeclNode* decl]
 	@init {
     $decl = new smallc::DeclNode();
-    $decl->setLocation($ctx->start->getLine(), $ctx->start->getCharPositionInLine());
+    $decl->setOffset($ctx->start->getStartIndex());
     }:
 	varType arrName '[' intConst ']' ';' {
         $decl->type = $varType.text;
@@ -109,7 +109,7 @@ scope
 	returns[smallc::ScopeNode* scope_]
 	@init {
     $scope_ = new smallc::ScopeNode();
-    $scope_->setLocation($ctx->start->getLine(), $ctx->start->getCharPositionInLine());
+    $scope_->setOffset($ctx->start->getStartIndex());
 }:
 	'{' (
 		scalarDecl {$scope_->addDeclaration($scalarDecl.decl);}